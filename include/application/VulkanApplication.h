@@ -11,11 +11,29 @@
 #include "window/window.h"
 #include "vkrenderer/VulkanSwapChainStructs.hpp"
 #include "vkrenderer/VulkanQueueFamily.hpp"
+#include "vkrenderer/VulkanDeviceCapabilities.h"
+#include "vkrenderer/VulkanMemoryAllocator.h"
+#include "vkrenderer/VulkanUniformRingBuffer.h"
+#include "vkrenderer/VulkanUploadManager.h"
+#include "vkrenderer/VulkanStagingArena.h"
+#include "vkrenderer/VulkanDeletionQueue.h"
+#include "vkrenderer/VulkanGpuProfiler.h"
+#include "vkrenderer/VulkanPipelineCache.h"
+#include "vkrenderer/VulkanThreadCommandPools.h"
+#include "vkrenderer/VulkanFramePacer.h"
+#include "vkrenderer/VulkanRendererSettings.hpp"
+#include "vkrenderer/VulkanUBO.hpp"
 #include "graphics/Vertex.hpp"
+#include "graphics/MeshCache.h"
+#include "graphics/VertexLayout.hpp"
+#include "utilities/StartupTrace.hpp"
+#include "utilities/FrameStats.hpp"
+#include "utilities/ThreadPool.h"
 
 #include <vulkan/vulkan.hpp>
 
 #include <chrono>
+#include <functional>
 
 class VULKAN_EXPORTS VulkanApplication
 {
@@ -23,6 +41,24 @@ public:
     using VertexData = std::vector<vertex>;
     using IndexData = std::vector<std::uint32_t>;
 
+    struct CommandBufferReuseStats
+    {
+        std::uint64_t m_recordCount{ 0 };
+        std::uint64_t m_reuseCount{ 0 };
+        std::uint64_t m_invalidationCount{ 0 };
+    };
+
+    // a warm load maps the mesh cache, a cold one parses the OBJ and writes the cache for next time
+    struct MeshLoadStats
+    {
+        double m_loadMs{ 0.0 };
+        // part of m_loadMs, the source is hashed on every load to validate the cache
+        double m_hashMs{ 0.0 };
+        bool m_bFromCache{ false };
+        // only filled when the OBJ was parsed, a cached mesh was optimized when it was built
+        graphics::MeshOptimizeReport m_optimizeReport;
+    };
+
     VulkanApplication( const std::string& applicationName );
     virtual ~VulkanApplication();
 
@@ -34,9 +70,36 @@ public:
 
     void initialise();
     void initialise( const std::filesystem::path& modelPath, const std::filesystem::path& texturePath );
+
+    const utils::StartupTrace& getStartupTrace() const;
+    const utils::FrameStats& getFrameStats() const;
+    vkrender::VulkanAllocatorStats getMemoryAllocatorStats() const;
+    // bytes copied through staging memory since initialise, direct uploads are not counted
+    std::uint64_t getTotalStagedBytes() const;
+    const vkrender::VulkanGpuProfiler& getGpuProfiler() const;
+    // only counted with RendererSettings::m_bReuseCommandBuffers, reset by runFrames
+    const CommandBufferReuseStats& getCommandBufferReuseStats() const;
+    const MeshLoadStats& getMeshLoadStats() const;
+    // takes effect on the next initialise
+    void setRendererSettings( const vkrender::RendererSettings& rendererSettings );
+    const vkrender::RendererSettings& getRendererSettings() const;
+    // the path actually in use, the requested one falls back when the device lacks support
+    vkrender::RenderingPath getRenderingPath() const;
+    // mode the swapchain was created with after the policy fell back, fifo when headless
+    vk::PresentModeKHR getPresentMode() const;
+    bool isPresentWaitEnabled() const;
+    // takes effect on the next initialise
+    void setUploadPath( const vkrender::UploadPath& uploadPath );
+    // replaces the mesh while frames are in flight, the previous buffers retire through the deletion queue
+    void swapModel( const std::filesystem::path& modelPath );
+    // ends mainLoop after the current frame, headless runs have no window to close
+    void requestQuit();
 protected:
     virtual void run() = 0;
     virtual void updateUniformBuffer( const std::uint32_t& currentFrame );
+    void writeUniformBufferObject( const VulkanUniformBufferObject& ubo );
+    // headless only, called in submission order once a frame's pixels are on the host, tightly packed RGBA8
+    virtual void onFrameReadback( const std::uint8_t* pPixels, const std::uint32_t& width, const std::uint32_t& height, const std::uint64_t& frameValue );
 
     template<typename countType, typename timeUnit>
     std::chrono::duration<countType, timeUnit> durationSinceLastFrameUpdate();
@@ -44,22 +107,40 @@ protected:
     void initWindow();
     void initVulkan();
     void mainLoop();
+    // renders a fixed number of frames for benchmarking, the frame stats are reset first
+    void runFrames( const std::uint32_t& frameCount );
+    // caps the frame rate and bounds queued presents, called before input is sampled
+    void paceFrame();
     void drawFrame();
+    // false when the swapchain was out of date and has been recreated, the frame is skipped
+    bool acquireSwapchainImage( std::uint32_t& imageIndex );
     void shutdown();
 
     void createInstance();
     void createSurface();
     void pickPhysicalDevice();
     void createLogicalDevice();
+    void createMemoryAllocator();
+    void resolveUploadPath();
+    void createDeletionQueue();
+    void createFramePacer();
     void createSwapchain();
     void createSwapChainImageViews();
+    void createOffscreenTargets();
+    void destroyOffscreenTargets();
+    void recordReadbackCopy( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex );
+    void deliverReadback( const std::uint32_t& frameSlot );
+    void drainReadbacks();
     void createRenderPass();
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
+    void createPipelineCache();
     void createGraphicsPipeline();
     void createFrameBuffers();
     void createCommandPool();
+    void createUploadManager();
+    void createStagingArena();
     void createConfigCommandBuffer();
     void createColorResources();
     void createDepthResources();
@@ -67,19 +148,50 @@ protected:
     void createTextureImageView();
     void createTextureSampler();
     void createGraphicsCommandBuffers();
+    void createRecordingThreads();
     void loadModel();
+    // input vertices set up in code rather than loaded are encoded into GpuVertexLayout here
+    void encodeInputVertexData();
+    // the mapped mesh cache when the model was loaded from it, the encoded input vertices otherwise
+    const std::uint8_t* getVertexData() const;
+    std::size_t getVertexCount() const;
+    const graphics::VertexDequantization& getVertexDequantization() const;
+    const std::uint32_t* getIndexData() const;
+    std::size_t getIndexCount() const;
     void createVertexBuffer();
     void createIndexBuffer();
+    void submitPendingUploads();
+    void uploadBufferData(
+        const void* pSrcData,
+        const vk::DeviceSize& sizeInBytes,
+        const vk::BufferUsageFlags& bufferUsage,
+        vk::Buffer& buffer,
+        vkrender::VulkanAllocation& bufferAllocation
+    );
     void createUniformBuffers();
     void createSyncObjects();
+    // blocks until the frame clock reaches frameValue, then refreshes the completed frame value
+    void waitForFrame( const std::uint64_t& frameValue );
+    void createGpuProfiler();
+    void collectGpuProfile( const std::uint32_t& frameSlot );
     void recreateSwapChain();
     void destroySwapChain();
 
+    void retireOnFrameCompletion( std::function<void()> deleter );
     void setupConfigCommandBuffer();
     void flushConfigCommandBuffer();
     void recordCommandBuffer( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex );
-    vk::CommandBuffer beginSingleTimeCommands( const vk::CommandPool& commandPoolToAllocFrom );
-    void endSingleTimeCommands( const vk::CommandPool& commandPoolAllocFrom, vk::CommandBuffer vkCommandBuffer, vk::Queue queueToSubmitOn );
+    // binds everything the scene needs, secondary command buffers inherit no state
+    // render pass or dynamic rendering, whichever path the device was created for
+    void beginSceneRendering( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex, const bool& bSecondaryContents );
+    void endSceneRendering( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex );
+    void recordSceneDraws( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& firstDraw, const std::uint32_t& drawCount );
+    void recordSecondaryCommandBuffers( const std::uint32_t& imageIndex );
+    std::uint32_t getSceneDrawCount() const;
+    // records the buffer for this image and frame slot if it is missing or out of date
+    vk::CommandBuffer acquirePrerecordedCommandBuffer( const std::uint32_t& imageIndex );
+    // call whenever something baked into recorded command buffers changes
+    void invalidateRecordedCommandBuffers( const std::string& reason );
 
     void transitionImageLayout( 
         const vk::Image& image, const vk::Format& format, 
@@ -94,14 +206,16 @@ protected:
         const vk::SharingMode& bufferSharingMode,
         const vk::MemoryPropertyFlags& memProps,
         vk::Buffer& buffer,
-        vk::DeviceMemory& bufferMemory
+        vkrender::VulkanAllocation& bufferAllocation,
+        const vkrender::AllocationStrategy& allocationStrategy = vkrender::AllocationStrategy::eFreeList
     );
     void createImage(
         const std::uint32_t& width, const std::uint32_t& height, const std::uint32_t& mipmapLevels,
         const vk::SampleCountFlagBits& numOfSamples,
         const vk::Format& format, const vk::ImageTiling& tiling,
         const vk::ImageUsageFlags& usageFlags, const vk::MemoryPropertyFlags& memPropFlags,
-        vk::Image& image, vk::DeviceMemory& imageMemory
+        const vk::SharingMode& imageSharingMode,
+        vk::Image& image, vkrender::VulkanAllocation& imageAllocation
     );
     vk::ImageView createImageView( 
         const vk::Image& image, 
@@ -111,7 +225,6 @@ protected:
     );
     void populateShaderBufferFromSourceFile( const std::filesystem::path& filePath, std::vector<char>& shaderSourceBuffer );
 
-    vkrender::QueueFamilyIndices findQueueFamilyIndices( const vk::PhysicalDevice& physicalDevice, vk::SurfaceKHR* pVkSurface );
     void logQueueFamilyIndices( const vkrender::QueueFamilyIndices& queueFamilyIndices );
     
     void populateDebugUtilsMessengerCreateInfo( vk::DebugUtilsMessengerCreateInfoEXT& createInfo );
@@ -149,9 +262,10 @@ protected:
     vk::Format findSupportedImgFormat( const std::initializer_list<vk::Format>& candidates, const vk::ImageTiling& tiling, const vk::FormatFeatureFlags& features );
     vk::Format findDepthFormat();
     bool hasStencilComponent( const vk::Format& format ) const;
-    std::uint32_t findMemoryType( const std::uint32_t& typeFilter, const vk::MemoryPropertyFlags& propertyFlags );
-    void copyBuffer( const vk::Buffer& srcBuffer, const vk::Buffer& dstBuffer, const vk::DeviceSize& sizeInBytes );
-    void copyBufferToImage( const vk::Buffer& srcBuffer, const vk::Image& dstImage, const std::uint32_t& width, const std::uint32_t& height );
+    std::uint32_t findMemoryType( const std::uint32_t& typeFilter, const vk::MemoryPropertyFlags& propertyFlags, const vk::MemoryPropertyFlags& preferredFlags = vk::MemoryPropertyFlags{} );
+    vkrender::VulkanStagingArena::Slice acquireStagingMemory( const vk::DeviceSize& sizeInBytes );
+    void copyBuffer( const vk::Buffer& srcBuffer, const vk::Buffer& dstBuffer, const vk::DeviceSize& sizeInBytes, const vk::DeviceSize& srcOffset = 0 );
+    void copyBufferToImage( const vk::Buffer& srcBuffer, const vk::Image& dstImage, const std::uint32_t& width, const std::uint32_t& height, const std::uint32_t& mipmapLevels, const vk::DeviceSize& bufferOffset = 0 );
     void generateMipmaps( 
         const vk::Image& image, 
         const vk::Format& imgFormat,
@@ -161,14 +275,18 @@ protected:
     void logVulkanInstanceCreationInfo( const vk::InstanceCreateInfo& instanceCreateInfo );
     vk::SampleCountFlagBits getMaxUsableSampleCount();
     
-    static constexpr std::uint8_t MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr std::uint32_t MAX_UNIFORM_BLOCKS_PER_FRAME = 4096;
+    static constexpr vk::DeviceSize STAGING_ARENA_SIZE = 32ull * 1024ull * 1024ull;
+    static constexpr vk::DeviceSize RESIZABLE_BAR_MIN_HEAP_SIZE = 256ull * 1024ull * 1024ull;
 
     std::string m_applicationName;
+    vkrender::RendererSettings m_rendererSettings;
 
     vk::Instance m_vkInstance;
     vk::DebugUtilsMessengerEXT m_vkDebugUtilsMessenger;
     vk::SurfaceKHR m_vkSurface;
     vk::PhysicalDevice m_vkPhysicalDevice;
+    vkrender::DeviceCapabilities m_deviceCapabilities;
     vk::SampleCountFlagBits m_msaaSampleCount;
 
     vk::Device m_vkLogicalDevice;
@@ -177,6 +295,8 @@ protected:
     vk::Queue m_vkTransferQueue;
 
     bool m_bHasExclusiveTransferQueue;
+
+    utils::Uptr<vkrender::VulkanMemoryAllocator> m_upMemoryAllocator;
     
     vk::Format m_vkSwapchainImageFormat;
     vk::Extent2D m_vkSwapchainExtent;
@@ -184,25 +304,42 @@ protected:
     std::vector<vk::Image> m_swapchainImages;
     std::vector<vk::ImageView> m_swapchainImageViews;
     vk::SharingMode m_vkSwapchainImageSharingMode;
+    // headless mode renders into one offscreen image per frame in flight, kept in m_swapchainImages
+    std::vector<vkrender::VulkanAllocation> m_offscreenImageAllocations;
+    std::vector<vk::Buffer> m_vkReadbackBuffers;
+    std::vector<vkrender::VulkanAllocation> m_readbackBufferAllocations;
+    // frame value copied into each readback buffer, 0 once delivered
+    std::vector<std::uint64_t> m_pendingReadbackFrameValues;
+    bool m_bQuitRequested;
 
     vk::Image m_vkColorImage;
-    vk::DeviceMemory m_vkColorImageMemory;
+    vkrender::VulkanAllocation m_colorImageAllocation;
     vk::ImageView m_vkColorImageView;
+    vk::Extent2D m_colorTargetExtent;
+    vk::Format m_colorTargetFormat;
     vk::Image m_vkDepthImage;
-    vk::DeviceMemory m_vkDepthImageMemory;
+    vkrender::VulkanAllocation m_depthImageAllocation;
     vk::ImageView m_vkDepthImageView;
+    vk::Extent2D m_depthTargetExtent;
 
     std::uint32_t m_imageMiplevels;
     vk::Image m_vkTextureImage;
-    vk::DeviceMemory m_vkTextureImageMemory;
+    vkrender::VulkanAllocation m_textureImageAllocation;
     vk::ImageView m_vkTextureImageView;
     vk::Sampler m_vkTextureSampler;
 
     vk::RenderPass m_vkRenderPass;
+    // no render pass or framebuffers are created on this path, attachments are transitioned with explicit barriers
+    bool m_bDynamicRendering;
+    vk::PresentModeKHR m_vkPresentMode;
+    // VK_KHR_present_id and VK_KHR_present_wait are enabled on the device
+    bool m_bPresentWait;
+    utils::Uptr<vkrender::VulkanFramePacer> m_upFramePacer;
     vk::DescriptorSetLayout m_vkDescriptorSetLayout;
     vk::DescriptorPool m_vkDescriptorPool;
-    std::vector<vk::DescriptorSet> m_vkDescriptorSets;
+    vk::DescriptorSet m_vkDescriptorSet;
     
+    utils::Uptr<vkrender::VulkanPipelineCache> m_upPipelineCache;
     vk::PipelineLayout m_vkPipelineLayout;
     vk::Pipeline m_vkGraphicsPipeline;
 
@@ -211,20 +348,54 @@ protected:
     vk::CommandPool m_vkGraphicsCommandPool;
     vk::CommandPool m_vkTransferCommandPool;
     vk::CommandBuffer m_vkConfigCommandBuffer;
+    vk::Fence m_vkConfigFence;
+    bool m_bConfigCommandBufferRecording;
+    bool m_bDeferConfigCommandFlush;
+    // records init-time transfers, barriers and blits into one submission per queue
+    bool m_bBatchInitSubmissions;
     std::vector<vk::CommandBuffer> m_vkGraphicsCommandBuffers;
+    // only created when recording on more than one thread
+    utils::Uptr<utils::ThreadPool> m_upRecordingThreadPool;
+    utils::Uptr<vkrender::VulkanThreadCommandPools> m_upThreadCommandPools;
+    // one per recording task, executed in order by the frame's primary command buffer
+    std::vector<vk::CommandBuffer> m_vkSceneCommandBuffers;
+    // reuse mode only, one per swapchain image and frame slot, image major
+    std::vector<vk::CommandBuffer> m_vkPrerecordedCommandBuffers;
+    // generation each buffer was recorded at, zero when never recorded
+    std::vector<std::uint64_t> m_prerecordedGenerations;
+    // the dynamic uniform offset is baked in too, it only stays put while each slot allocates the same slices
+    std::vector<std::uint32_t> m_prerecordedUniformOffsets;
+    std::uint64_t m_recordingGeneration;
+    CommandBufferReuseStats m_commandBufferReuseStats;
+    utils::Uptr<vkrender::VulkanUploadManager> m_upUploadManager;
+    vkrender::UploadTicket m_pendingUploadTicket;
+    vk::Buffer m_vkStagingBuffer;
+    vkrender::VulkanAllocation m_stagingBufferAllocation;
+    utils::Uptr<vkrender::VulkanStagingArena> m_upStagingArena;
+    std::uint64_t m_totalStagedBytes;
+    vkrender::UploadPath m_uploadPath;
+    // vertex and index data is written straight into host visible device local memory
+    bool m_bDirectUpload;
     vk::Buffer m_vkVertexBuffer;
-    vk::DeviceMemory m_vkVertexBufferMemory;
+    vkrender::VulkanAllocation m_vertexBufferAllocation;
     vk::Buffer m_vkIndexBuffer;
-    vk::DeviceMemory m_vkIndexBufferMemory;
+    vkrender::VulkanAllocation m_indexBufferAllocation;
     
-    std::vector<vk::Buffer> m_vkUniformBuffers;
-    std::vector<vk::DeviceMemory> m_vkUniformBuffersMemory;
-    std::vector<void*> m_uniformBuffersMapped;
+    vk::Buffer m_vkUniformBuffer;
+    vkrender::VulkanAllocation m_uniformBufferAllocation;
+    utils::Uptr<vkrender::VulkanUniformRingBuffer> m_upUniformRingBuffer;
+    std::uint32_t m_frameUniformOffset;
 
     std::vector<vk::Semaphore> m_vkImageAvailableSemaphores;
     std::vector<vk::Semaphore> m_vkRenderFinishedSemaphores;
-    std::vector<vk::Fence> m_vkInFlightFences;
+    // timeline semaphore signalled with the frame value of every graphics submission, frame N has
+    // finished on the device once its counter reaches N
+    vk::Semaphore m_vkFrameTimelineSemaphore;
     std::uint8_t m_currentFrame;
+    std::uint64_t m_submittedFrameValue;
+    std::uint64_t m_completedFrameValue;
+    utils::Uptr<vkrender::VulkanGpuProfiler> m_upGpuProfiler;
+    utils::Uptr<vkrender::VulkanDeletionQueue> m_upDeletionQueue;
 
     std::vector<const char*> m_instanceExtensionContainer;
     std::vector<const char*> m_deviceExtensionContainer;
@@ -232,6 +403,15 @@ protected:
 
     VertexData m_inputVertexData;
     IndexData m_inputIndexData;
+    graphics::EncodedVertices m_encodedVertexData;
+    // stays mapped while the model came from the cache, uploads copy straight out of it
+    utils::Uptr<graphics::MeshCache> m_upMeshCache;
+    MeshLoadStats m_meshLoadStats;
+
+    utils::StartupTrace m_startupTrace;
+    utils::FrameStats m_frameStats;
+    std::chrono::time_point< std::chrono::high_resolution_clock > m_inputSampleTime;
+    std::chrono::time_point< std::chrono::high_resolution_clock > m_lastPresentTime;
 
     std::chrono::time_point< std::chrono::high_resolution_clock > m_simulationStart;
     std::chrono::time_point< std::chrono::high_resolution_clock > m_timeSinceLastUpdateFrame;
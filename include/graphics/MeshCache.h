@@ -0,0 +1,82 @@
+#ifndef GRAPHICS_MESH_CACHE_H
+#define GRAPHICS_MESH_CACHE_H
+
+#include "graphics/MeshData.hpp"
+#include "graphics/MeshOptimizer.h"
+#include "graphics/VertexLayout.hpp"
+#include "utilities/MappedFile.h"
+#include "exports.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace graphics
+{
+	// everything the cached mesh was built from, a cache is only used when all of it matches
+	struct MeshCacheKey
+	{
+		// 64 bit FNV-1a of the source file, see MeshCache::hashSourceFile
+		std::uint64_t		m_sourceHash{ 0 };
+		float				m_weldEpsilon{ 0.0f };
+		MeshOptimizeMode	m_optimizeMode{ MeshOptimizeMode::eNone };
+	};
+
+	// Binary image of a MeshData, mapped rather than read so uploads copy straight out of the page cache.
+	// The header records the MeshCacheKey the mesh was built with, a cache built from another key is stale.
+	// Vertices are stored encoded in GpuVertexLayout, a cache written by a build with another layout is rejected.
+	class VULKAN_EXPORTS MeshCache
+	{
+	public:
+		static constexpr std::uint32_t FORMAT_VERSION = 4;
+
+		enum class LoadResult
+		{
+			eLoaded,
+			eMissing,
+			// built from different source contents, or with another weld epsilon or optimize mode
+			eStale,
+			// another format version or vertex layout, a truncated file or indices past the vertices
+			eRejected
+		};
+
+		MeshCache() = default;
+		MeshCache( const MeshCache& ) = delete;
+		MeshCache( MeshCache&& ) = delete;
+		~MeshCache() = default;
+
+		MeshCache& operator=( const MeshCache& ) = delete;
+		MeshCache& operator=( MeshCache&& ) = delete;
+
+		// the mapping stays open until close, nothing is copied out of it here
+		LoadResult open( const std::filesystem::path& cacheFilePath, const MeshCacheKey& cacheKey );
+		void close();
+
+		// GpuVertexLayout::STRIDE bytes per vertex
+		const std::uint8_t* getVertexData() const;
+		std::size_t getVertexCount() const;
+		const VertexDequantization& getVertexDequantization() const;
+		const std::uint32_t* getIndices() const;
+		std::size_t getIndexCount() const;
+		const glm::vec3& getBoundsMin() const;
+		const glm::vec3& getBoundsMax() const;
+
+		// written to a temporary file and renamed over the cache, a reader never maps half a file
+		// indices and bounds come from meshData, the vertices from its GpuVertexLayout encoding
+		static bool write( const std::filesystem::path& cacheFilePath, const MeshData& meshData, const EncodedVertices& encodedVertices, const MeshCacheKey& cacheKey );
+		// 64 bit FNV-1a over the whole file, false when it cannot be read
+		static bool hashSourceFile( const std::filesystem::path& sourceFilePath, std::uint64_t& sourceHash );
+		static std::filesystem::path getCacheFilePath( const std::filesystem::path& cacheDirectory, const std::filesystem::path& sourceFilePath );
+	private:
+		utils::MappedFile m_mappedFile;
+		const std::uint8_t* m_pVertexData{ nullptr };
+		std::size_t m_vertexCount{ 0 };
+		VertexDequantization m_vertexDequantization;
+		const std::uint32_t* m_pIndices{ nullptr };
+		std::size_t m_indexCount{ 0 };
+		glm::vec3 m_boundsMin{ 0.0f };
+		glm::vec3 m_boundsMax{ 0.0f };
+	};
+
+} // namespace graphics
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef GRAPHICS_MESH_DATA_HPP
+#define GRAPHICS_MESH_DATA_HPP
+
+#include "graphics/Vertex.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace graphics
+{
+	// Deduplicated vertices and the triangle list indexing them, as uploaded to the vertex and index buffers.
+	struct MeshData
+	{
+		std::vector<vertex>			m_vertices;
+		std::vector<std::uint32_t>	m_indices;
+		glm::vec3					m_boundsMin{ 0.0f };
+		glm::vec3					m_boundsMax{ 0.0f };
+
+		void computeBounds()
+		{
+			if( m_vertices.empty() )
+			{
+				m_boundsMin = m_boundsMax = glm::vec3{ 0.0f };
+				return;
+			}
+
+			m_boundsMin = m_boundsMax = m_vertices.front().pos;
+			for( const auto& vertexData : m_vertices )
+			{
+				m_boundsMin = glm::min( m_boundsMin, vertexData.pos );
+				m_boundsMax = glm::max( m_boundsMax, vertexData.pos );
+			}
+		}
+	};
+
+} // namespace graphics
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef GRAPHICS_MESH_OPTIMIZER_H
+#define GRAPHICS_MESH_OPTIMIZER_H
+
+#include "graphics/MeshData.hpp"
+#include "exports.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace graphics
+{
+	enum class MeshOptimizeMode : std::uint32_t
+	{
+		eNone,
+		// triangles in vertex cache order, vertices in the order the triangles first use them
+		eVertexCache,
+		// as eVertexCache, with clusters of triangles sorted against overdraw in between
+		eVertexCacheAndOverdraw
+	};
+
+	// Simulated on a FIFO cache. ACMR is misses per triangle, 0.5 to 3 for a closed mesh,
+	// ATVR is misses per referenced vertex, where 1 means every vertex is transformed once.
+	struct VertexCacheStats
+	{
+		float m_acmr{ 0.0f };
+		float m_atvr{ 0.0f };
+	};
+
+	struct MeshOptimizeReport
+	{
+		VertexCacheStats m_before;
+		VertexCacheStats m_after;
+		double m_optimizeMs{ 0.0 };
+	};
+
+	constexpr std::uint32_t VERTEX_CACHE_ANALYZE_SIZE = 16;
+
+	VULKAN_EXPORTS VertexCacheStats analyzeVertexCache( const std::vector<std::uint32_t>& indices, const std::size_t& vertexCount, const std::uint32_t& cacheSize = VERTEX_CACHE_ANALYZE_SIZE );
+
+	// Forsyth's linear speed reordering, greedily emits the best scored triangle around a simulated LRU cache.
+	// Vertices score higher the more recently they were used and the fewer triangles they have left.
+	VULKAN_EXPORTS void optimizeVertexCache( std::vector<std::uint32_t>& indices, const std::size_t& vertexCount );
+
+	// Expects vertex cache ordered indices. Cuts them into clusters where the cache restarts, or where a
+	// cluster's miss ratio is already within threshold of its whole run, then draws the clusters facing
+	// away from the mesh centre first so they occlude the inner ones. A threshold of 1.05 gives up 5% ACMR.
+	VULKAN_EXPORTS void optimizeOverdraw( std::vector<std::uint32_t>& indices, const std::vector<vertex>& vertices, const float& threshold = 1.05f );
+
+	// renumbers the vertices in the order the indices first reference them, unreferenced vertices are dropped
+	VULKAN_EXPORTS void optimizeVertexFetch( MeshData& meshData );
+
+	VULKAN_EXPORTS MeshOptimizeReport optimizeMesh( MeshData& meshData, const MeshOptimizeMode& optimizeMode );
+
+} // namespace graphics
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef GRAPHICS_OBJ_LOADER_H
+#define GRAPHICS_OBJ_LOADER_H
+
+#include "graphics/MeshData.hpp"
+#include "exports.hpp"
+
+#include <filesystem>
+
+namespace utils
+{
+	class ThreadPool;
+}
+
+namespace graphics
+{
+	// Parses every shape of the OBJ into one triangle list, vertices sharing position and texture coordinate
+	// are merged. Texture coordinates are flipped to Vulkan's top left origin. Throws when the file cannot be parsed.
+	// A weld epsilon above 0 also merges vertices that round to the same multiple of it, see VertexWeldTable.
+	VULKAN_EXPORTS void loadObjMesh( const std::filesystem::path& objFilePath, MeshData& meshData, const float& weldEpsilon = 0.0f );
+
+	// Same output as loadObjMesh, spread over the thread slots of threadPool. The mapped file is parsed in line
+	// aligned chunks and vertices are merged in hash shards, the first occurrence of a vertex still sets its index
+	// so the result does not depend on the thread count. Polygons are fanned from their first corner.
+	VULKAN_EXPORTS void loadObjMeshParallel( const std::filesystem::path& objFilePath, MeshData& meshData, utils::ThreadPool& threadPool, const float& weldEpsilon = 0.0f );
+
+} // namespace graphics
+
+#endif
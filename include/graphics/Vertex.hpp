@@ -3,7 +3,9 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtx/hash.hpp>
-#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <cstring>
 
 struct vertex
 {
@@ -14,43 +16,46 @@ struct vertex
     bool operator==(const vertex& other) const {
         return pos == other.pos && color == other.color && texCoord == other.texCoord;
     }
-    
-    static vk::VertexInputBindingDescription getBindingDescription(){
-        vk::VertexInputBindingDescription bindingDescription{};
-
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(vertex);
-        bindingDescription.inputRate = vk::VertexInputRate::eVertex;    
+};
 
-        return bindingDescription;
+namespace graphics {
+    // murmur3's 64 bit finaliser, every input bit reaches every output bit
+    inline std::uint64_t mixHashBits( std::uint64_t value ) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
     }
 
-    static std::array<vk::VertexInputAttributeDescription, 3> getAttributeDescriptions(){
-        std::array<vk::VertexInputAttributeDescription, 3> vertexAttributes;
-
-        vertexAttributes[0].binding = 0;
-        vertexAttributes[0].location = 0;
-        vertexAttributes[0].format = vk::Format::eR32G32B32Sfloat;
-        vertexAttributes[0].offset = offsetof( vertex, pos );
-
-        vertexAttributes[1].binding = 0;
-        vertexAttributes[1].location = 1;
-        vertexAttributes[1].format = vk::Format::eR32G32B32Sfloat;
-        vertexAttributes[1].offset = offsetof( vertex, color );
-
-        vertexAttributes[2].binding = 0;
-        vertexAttributes[2].location = 2;
-        vertexAttributes[2].format = vk::Format::eR32G32Sfloat;
-        vertexAttributes[2].offset = offsetof( vertex, texCoord );
-
-        return vertexAttributes;
-    };
-};
+    // hashes the bit pattern of every component, two per 64 bit word. -0 is folded into +0 as operator== treats them
+    // as equal. Each word goes through the finaliser before the next one is added, grid coordinates that only differ
+    // in a few low mantissa bits still land far apart
+    inline std::uint64_t hashVertex( const vertex& vertexData ) {
+        const float components[8] = {
+            vertexData.pos.x, vertexData.pos.y, vertexData.pos.z,
+            vertexData.color.x, vertexData.color.y, vertexData.color.z,
+            vertexData.texCoord.x, vertexData.texCoord.y
+        };
+
+        std::uint64_t hash = 0x9e3779b97f4a7c15ull;
+        for( int wordIndex = 0; wordIndex < 4; wordIndex++ ) {
+            std::uint32_t bits[2];
+            for( int half = 0; half < 2; half++ ) {
+                float component = components[ 2 * wordIndex + half ] == 0.0f ? 0.0f : components[ 2 * wordIndex + half ];
+                std::memcpy( &bits[half], &component, sizeof(component) );
+            }
+            hash = mixHashBits( hash ^ ( static_cast<std::uint64_t>( bits[0] ) << 32 | bits[1] ) );
+        }
+        return hash;
+    }
+}
 
 namespace std {
     template<> struct hash<vertex> {
         size_t operator()(vertex const& vertexData) const {
-            return ( (hash<glm::vec3>()(vertexData.pos) ^ (hash<glm::vec3>()(vertexData.color) << 1) ) >> 1 ) ^ ( hash<glm::vec2>()(vertexData.texCoord) << 1 );
+            return static_cast<size_t>( graphics::hashVertex( vertexData ) );
         }
     };
 }
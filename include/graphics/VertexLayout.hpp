@@ -0,0 +1,335 @@
+#ifndef GRAPHICS_VERTEX_LAYOUT_HPP
+#define GRAPHICS_VERTEX_LAYOUT_HPP
+
+#include "graphics/Vertex.hpp"
+
+#include <glm/gtc/packing.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace graphics
+{
+	enum class VertexSemantic : std::uint32_t
+	{
+		ePosition,
+		eColor,
+		eTexCoord,
+		// not part of vertex, computed from the triangles when a layout asks for it
+		eNormal
+	};
+
+	enum class VertexFormat : std::uint32_t
+	{
+		eFloat32x3,
+		eFloat32x2,
+		// positions are mapped onto the mesh bounds first, the fourth component pads the attribute to 8 bytes
+		eUnorm16x4,
+		eFloat16x2,
+		// for unit vectors, the fourth component is padding
+		eSnorm8x4
+	};
+
+	constexpr std::uint32_t getVertexFormatSize( const VertexFormat& format )
+	{
+		switch( format )
+		{
+			case VertexFormat::eFloat32x3: return 12;
+			case VertexFormat::eFloat32x2: return 8;
+			case VertexFormat::eUnorm16x4: return 8;
+			case VertexFormat::eFloat16x2: return 4;
+			case VertexFormat::eSnorm8x4: return 4;
+		}
+		return 0;
+	}
+
+	// every one of these is mandatory for vertex buffers, three component 16 and 8 bit formats are not
+	constexpr vk::Format getVkVertexFormat( const VertexFormat& format )
+	{
+		switch( format )
+		{
+			case VertexFormat::eFloat32x3: return vk::Format::eR32G32B32Sfloat;
+			case VertexFormat::eFloat32x2: return vk::Format::eR32G32Sfloat;
+			case VertexFormat::eUnorm16x4: return vk::Format::eR16G16B16A16Unorm;
+			case VertexFormat::eFloat16x2: return vk::Format::eR16G16Sfloat;
+			case VertexFormat::eSnorm8x4: return vk::Format::eR8G8B8A8Snorm;
+		}
+		return vk::Format::eUndefined;
+	}
+
+	template<VertexSemantic Semantic, VertexFormat Format>
+	struct VertexAttribute
+	{
+		static constexpr VertexSemantic SEMANTIC = Semantic;
+		static constexpr VertexFormat FORMAT = Format;
+	};
+
+	// Vertex shader push constant of the quantized layouts, position = offset + normalized * scale.
+	// vec4 members keep the block's std430 layout identical to this one.
+	struct VertexDequantization
+	{
+		glm::vec4 m_positionOffset{ 0.0f };
+		glm::vec4 m_positionScale{ 1.0f };
+	};
+
+	// maps the bounds onto the unit cube, an empty axis keeps a scale of 1 so it still decodes to its one value
+	inline VertexDequantization computeVertexDequantization( const glm::vec3& boundsMin, const glm::vec3& boundsMax )
+	{
+		VertexDequantization dequantization;
+		for( int axis = 0; axis < 3; axis++ )
+		{
+			float extent = boundsMax[axis] - boundsMin[axis];
+			dequantization.m_positionOffset[axis] = boundsMin[axis];
+			dequantization.m_positionScale[axis] = extent > 0.0f ? extent : 1.0f;
+		}
+		return dequantization;
+	}
+
+	// area weighted sum of the normals of the triangles around each vertex, vertices of only degenerate
+	// triangles or none at all get +Z so the shader never normalizes a zero vector
+	inline std::vector<glm::vec3> computeVertexNormals( const std::vector<vertex>& vertices, const std::vector<std::uint32_t>& indices )
+	{
+		std::vector<glm::vec3> normals( vertices.size(), glm::vec3{ 0.0f } );
+		for( std::size_t cornerIndex = 0; cornerIndex + 2 < indices.size(); cornerIndex += 3 )
+		{
+			const glm::vec3& p0 = vertices[ indices[cornerIndex] ].pos;
+			glm::vec3 faceNormal = glm::cross( vertices[ indices[cornerIndex + 1] ].pos - p0, vertices[ indices[cornerIndex + 2] ].pos - p0 );
+			for( int corner = 0; corner < 3; corner++ )
+				normals[ indices[cornerIndex + corner] ] += faceNormal;
+		}
+
+		for( auto& normal : normals )
+		{
+			float normalLength = glm::length( normal );
+			normal = normalLength > 0.0f ? normal / normalLength : glm::vec3{ 0.0f, 0.0f, 1.0f };
+		}
+		return normals;
+	}
+
+	inline void encodeVertexAttribute(
+		const VertexSemantic& semantic, const VertexFormat& format,
+		const vertex& vertexData, const glm::vec3& normal, const VertexDequantization& dequantization,
+		std::uint8_t* pEncoded
+	)
+	{
+		glm::vec4 value{ 0.0f };
+		switch( semantic )
+		{
+			case VertexSemantic::ePosition: value = glm::vec4{ vertexData.pos, 0.0f }; break;
+			case VertexSemantic::eColor: value = glm::vec4{ vertexData.color, 0.0f }; break;
+			case VertexSemantic::eTexCoord: value = glm::vec4{ vertexData.texCoord, 0.0f, 0.0f }; break;
+			case VertexSemantic::eNormal: value = glm::vec4{ normal, 0.0f }; break;
+		}
+
+		switch( format )
+		{
+			case VertexFormat::eFloat32x3:
+			case VertexFormat::eFloat32x2:
+			{
+				const float components[3] = { value.x, value.y, value.z };
+				std::memcpy( pEncoded, components, getVertexFormatSize( format ) );
+				break;
+			}
+			case VertexFormat::eUnorm16x4:
+			{
+				// only positions are dequantized by the shader, anything else has to be in [0, 1] already
+				if( semantic == VertexSemantic::ePosition )
+					value = ( value - dequantization.m_positionOffset ) / dequantization.m_positionScale;
+				const std::uint16_t packed[4] = {
+					glm::packUnorm1x16( value.x ), glm::packUnorm1x16( value.y ), glm::packUnorm1x16( value.z ), glm::packUnorm1x16( value.w )
+				};
+				std::memcpy( pEncoded, packed, sizeof(packed) );
+				break;
+			}
+			case VertexFormat::eFloat16x2:
+			{
+				const std::uint16_t packed[2] = { glm::packHalf1x16( value.x ), glm::packHalf1x16( value.y ) };
+				std::memcpy( pEncoded, packed, sizeof(packed) );
+				break;
+			}
+			case VertexFormat::eSnorm8x4:
+			{
+				const std::uint8_t packed[4] = {
+					glm::packSnorm1x8( value.x ), glm::packSnorm1x8( value.y ), glm::packSnorm1x8( value.z ), glm::packSnorm1x8( value.w )
+				};
+				std::memcpy( pEncoded, packed, sizeof(packed) );
+				break;
+			}
+		}
+	}
+
+	template<std::size_t AttributeCount>
+	constexpr std::array<std::uint32_t, AttributeCount> computeVertexOffsets( const std::array<VertexFormat, AttributeCount>& formats )
+	{
+		std::array<std::uint32_t, AttributeCount> offsets{};
+		std::uint32_t offset = 0;
+		for( std::size_t attributeIndex = 0; attributeIndex < AttributeCount; attributeIndex++ )
+		{
+			offsets[attributeIndex] = offset;
+			offset += getVertexFormatSize( formats[attributeIndex] );
+		}
+		return offsets;
+	}
+
+	// 32 bit FNV-1a over every semantic and format, two layouts with the same attributes share a signature
+	template<std::size_t AttributeCount>
+	constexpr std::uint32_t computeVertexLayoutSignature( const std::array<VertexSemantic, AttributeCount>& semantics, const std::array<VertexFormat, AttributeCount>& formats )
+	{
+		std::uint32_t signature = 0x811c9dc5u;
+		for( std::size_t attributeIndex = 0; attributeIndex < AttributeCount; attributeIndex++ )
+		{
+			signature = ( signature ^ static_cast<std::uint32_t>( semantics[attributeIndex] ) ) * 0x01000193u;
+			signature = ( signature ^ static_cast<std::uint32_t>( formats[attributeIndex] ) ) * 0x01000193u;
+		}
+		return signature;
+	}
+
+	template<std::size_t AttributeCount>
+	constexpr bool hasVertexSemantic( const std::array<VertexSemantic, AttributeCount>& semantics, const VertexSemantic& semantic )
+	{
+		for( std::size_t attributeIndex = 0; attributeIndex < AttributeCount; attributeIndex++ )
+		{
+			if( semantics[attributeIndex] == semantic )
+				return true;
+		}
+		return false;
+	}
+
+	template<std::size_t AttributeCount>
+	constexpr bool hasVertexAttribute( const std::array<VertexSemantic, AttributeCount>& semantics, const std::array<VertexFormat, AttributeCount>& formats, const VertexSemantic& semantic, const VertexFormat& format )
+	{
+		for( std::size_t attributeIndex = 0; attributeIndex < AttributeCount; attributeIndex++ )
+		{
+			if( semantics[attributeIndex] == semantic && formats[attributeIndex] == format )
+				return true;
+		}
+		return false;
+	}
+
+	// Vertex buffer layout described by its attributes, packed back to back in this order and read from
+	// consecutive shader locations starting at 0. Everything the pipeline and the encoder need is derived here.
+	template<typename... Attributes>
+	struct VertexLayout
+	{
+		static constexpr std::uint32_t ATTRIBUTE_COUNT = sizeof...(Attributes);
+		static constexpr std::array<VertexSemantic, ATTRIBUTE_COUNT> SEMANTICS{ { Attributes::SEMANTIC... } };
+		static constexpr std::array<VertexFormat, ATTRIBUTE_COUNT> FORMATS{ { Attributes::FORMAT... } };
+		static constexpr std::array<std::uint32_t, ATTRIBUTE_COUNT> OFFSETS = computeVertexOffsets( FORMATS );
+		static constexpr std::uint32_t STRIDE = ( getVertexFormatSize( Attributes::FORMAT ) + ... );
+		static constexpr std::uint32_t SIGNATURE = computeVertexLayoutSignature( SEMANTICS, FORMATS );
+		static constexpr bool HAS_NORMAL = hasVertexSemantic( SEMANTICS, VertexSemantic::eNormal );
+		// the shader needs the VertexDequantization push constant to decode positions
+		static constexpr bool QUANTIZED_POSITION = hasVertexAttribute( SEMANTICS, FORMATS, VertexSemantic::ePosition, VertexFormat::eUnorm16x4 );
+
+		static vk::VertexInputBindingDescription getBindingDescription()
+		{
+			vk::VertexInputBindingDescription bindingDescription{};
+			bindingDescription.binding = 0;
+			bindingDescription.stride = STRIDE;
+			bindingDescription.inputRate = vk::VertexInputRate::eVertex;
+			return bindingDescription;
+		}
+
+		static std::array<vk::VertexInputAttributeDescription, ATTRIBUTE_COUNT> getAttributeDescriptions()
+		{
+			std::array<vk::VertexInputAttributeDescription, ATTRIBUTE_COUNT> attributeDescriptions;
+			for( std::uint32_t attributeIndex = 0; attributeIndex < ATTRIBUTE_COUNT; attributeIndex++ )
+			{
+				attributeDescriptions[attributeIndex].binding = 0;
+				attributeDescriptions[attributeIndex].location = attributeIndex;
+				attributeDescriptions[attributeIndex].format = getVkVertexFormat( FORMATS[attributeIndex] );
+				attributeDescriptions[attributeIndex].offset = OFFSETS[attributeIndex];
+			}
+			return attributeDescriptions;
+		}
+
+		// writes STRIDE bytes, normal is only read by layouts with HAS_NORMAL
+		static void encode( const vertex& vertexData, const glm::vec3& normal, const VertexDequantization& dequantization, std::uint8_t* pEncoded )
+		{
+			for( std::uint32_t attributeIndex = 0; attributeIndex < ATTRIBUTE_COUNT; attributeIndex++ )
+				encodeVertexAttribute( SEMANTICS[attributeIndex], FORMATS[attributeIndex], vertexData, normal, dequantization, pEncoded + OFFSETS[attributeIndex] );
+		}
+	};
+
+	// full precision, what vertex holds, 32 bytes
+	using StandardVertexLayout = VertexLayout<
+		VertexAttribute<VertexSemantic::ePosition, VertexFormat::eFloat32x3>,
+		VertexAttribute<VertexSemantic::eColor, VertexFormat::eFloat32x3>,
+		VertexAttribute<VertexSemantic::eTexCoord, VertexFormat::eFloat32x2>
+	>;
+	// positions on a 16 bit grid over the mesh bounds and half float texture coordinates, the loader's
+	// constant white color is dropped, 12 bytes
+	using CompactVertexLayout = VertexLayout<
+		VertexAttribute<VertexSemantic::ePosition, VertexFormat::eUnorm16x4>,
+		VertexAttribute<VertexSemantic::eTexCoord, VertexFormat::eFloat16x2>
+	>;
+	// compact with an 8 bit per component normal, 16 bytes
+	using CompactNormalVertexLayout = VertexLayout<
+		VertexAttribute<VertexSemantic::ePosition, VertexFormat::eUnorm16x4>,
+		VertexAttribute<VertexSemantic::eTexCoord, VertexFormat::eFloat16x2>,
+		VertexAttribute<VertexSemantic::eNormal, VertexFormat::eSnorm8x4>
+	>;
+
+	static_assert( StandardVertexLayout::STRIDE == sizeof(vertex) );
+	static_assert( CompactVertexLayout::STRIDE == 12 && CompactNormalVertexLayout::STRIDE == 16 );
+
+	// picked by the VKRENDER_VERTEX_LAYOUT CMake option, the vertex shader of the same name goes with it
+#if defined( VKRENDER_VERTEX_LAYOUT_COMPACT_NORMAL )
+	using GpuVertexLayout = CompactNormalVertexLayout;
+	constexpr const char* GPU_VERTEX_LAYOUT_NAME = "compact_normal";
+	constexpr const char* GPU_VERTEX_SHADER_NAME = "triangle_compact_normal";
+#elif defined( VKRENDER_VERTEX_LAYOUT_COMPACT )
+	using GpuVertexLayout = CompactVertexLayout;
+	constexpr const char* GPU_VERTEX_LAYOUT_NAME = "compact";
+	constexpr const char* GPU_VERTEX_SHADER_NAME = "triangle_compact";
+#else
+	using GpuVertexLayout = StandardVertexLayout;
+	constexpr const char* GPU_VERTEX_LAYOUT_NAME = "standard";
+	constexpr const char* GPU_VERTEX_SHADER_NAME = "triangle";
+#endif
+
+	// vertices as the vertex buffer takes them
+	struct EncodedVertices
+	{
+		std::vector<std::uint8_t> m_data;
+		std::size_t m_vertexCount{ 0 };
+		VertexDequantization m_dequantization;
+	};
+
+	template<typename Layout>
+	void encodeVertices( const std::vector<vertex>& vertices, const std::vector<std::uint32_t>& indices, EncodedVertices& encodedVertices )
+	{
+		glm::vec3 boundsMin{ 0.0f };
+		glm::vec3 boundsMax{ 0.0f };
+		if( !vertices.empty() )
+		{
+			boundsMin = boundsMax = vertices.front().pos;
+			for( const auto& vertexData : vertices )
+			{
+				boundsMin = glm::min( boundsMin, vertexData.pos );
+				boundsMax = glm::max( boundsMax, vertexData.pos );
+			}
+		}
+		encodedVertices.m_dequantization = computeVertexDequantization( boundsMin, boundsMax );
+
+		std::vector<glm::vec3> normals;
+		if constexpr( Layout::HAS_NORMAL )
+			normals = computeVertexNormals( vertices, indices );
+
+		encodedVertices.m_data.resize( static_cast<std::size_t>( Layout::STRIDE ) * vertices.size() );
+		encodedVertices.m_vertexCount = vertices.size();
+		for( std::size_t vertexIndex = 0; vertexIndex < vertices.size(); vertexIndex++ )
+		{
+			Layout::encode(
+				vertices[vertexIndex], normals.empty() ? glm::vec3{ 0.0f } : normals[vertexIndex], encodedVertices.m_dequantization,
+				encodedVertices.m_data.data() + static_cast<std::size_t>( Layout::STRIDE ) * vertexIndex
+			);
+		}
+	}
+
+} // namespace graphics
+
+#endif
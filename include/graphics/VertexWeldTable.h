@@ -0,0 +1,60 @@
+#ifndef GRAPHICS_VERTEX_WELD_TABLE_H
+#define GRAPHICS_VERTEX_WELD_TABLE_H
+
+#include "graphics/Vertex.hpp"
+#include "exports.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace graphics
+{
+	// Open addressing table from vertex to the index of its first occurrence, used to merge the corners of a
+	// mesh into shared vertices. Slots hold the vertex itself and are probed linearly, an insert allocates only
+	// when the table grows. With a weld epsilon, vertices are merged when every component rounds to the same
+	// multiple of the epsilon, two vertices close to either side of a rounding boundary stay apart.
+	class VULKAN_EXPORTS VertexWeldTable
+	{
+	public:
+		explicit VertexWeldTable( const std::size_t& expectedVertexCount, const float& weldEpsilon = 0.0f );
+		VertexWeldTable( const VertexWeldTable& ) = delete;
+		VertexWeldTable( VertexWeldTable&& ) = delete;
+		~VertexWeldTable() = default;
+
+		VertexWeldTable& operator=( const VertexWeldTable& ) = delete;
+		VertexWeldTable& operator=( VertexWeldTable&& ) = delete;
+
+		// the index stored with a matching vertex, otherwise vertexData is stored with vertexIndex and that is returned
+		std::uint32_t findOrInsert( const vertex& vertexData, const std::uint32_t& vertexIndex );
+
+		std::size_t getSize() const;
+		std::size_t getCapacity() const;
+
+		// hashVertex without an epsilon, the hash of the rounded components with one. Matching vertices hash equally
+		static std::uint64_t hashVertex( const vertex& vertexData, const float& weldEpsilon );
+		// a closed mesh has about one vertex per six corners and seams add more, a quarter of the index count
+		// leaves room for most meshes without growing
+		static std::size_t estimateVertexCount( const std::size_t& indexCount );
+	private:
+		static constexpr std::uint32_t EMPTY_SLOT = 0xffffffffu;
+
+		struct Slot
+		{
+			vertex			m_vertex;
+			std::uint32_t	m_vertexIndex{ EMPTY_SLOT };
+			// top half of the hash, most mismatching slots are skipped without comparing the vertex
+			std::uint32_t	m_hashTag{ 0 };
+		};
+
+		bool matches( const vertex& storedVertex, const vertex& vertexData ) const;
+		void grow();
+
+		std::vector<Slot> m_slots;
+		std::size_t m_slotMask;
+		std::size_t m_size;
+		float m_weldEpsilon;
+	};
+
+} // namespace graphics
+
+#endif
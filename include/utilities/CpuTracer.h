@@ -0,0 +1,98 @@
+#ifndef UTILS_CPU_TRACER_H
+#define UTILS_CPU_TRACER_H
+
+#include "exports.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace utils
+{
+	// Records CPU zones and instant events into one fixed size ring buffer per thread, the oldest events are overwritten.
+	// Recording takes no locks. Dumps read every thread's buffer and are only exact while those threads are not recording.
+	class VULKAN_EXPORTS CpuTracer
+	{
+	public:
+		static constexpr std::size_t EVENTS_PER_THREAD = 16384;
+		static constexpr std::size_t MAX_DYNAMIC_NAME_LENGTH = 63;
+
+		enum class EventType : std::uint8_t
+		{
+			eZone,
+			eInstant
+		};
+
+		struct Event
+		{
+			std::uint64_t	m_beginNs;
+			std::uint64_t	m_durationNs;
+			// string literals are referenced, anything else is copied and truncated into m_dynamicName
+			const char*		m_pStaticName;
+			EventType		m_type;
+			std::array<char, MAX_DYNAMIC_NAME_LENGTH + 1> m_dynamicName;
+		};
+
+		static void recordZone( const char* pStaticName, const std::uint64_t& beginNs, const std::uint64_t& endNs );
+		static void recordZone( const std::string_view& dynamicName, const std::uint64_t& beginNs, const std::uint64_t& endNs );
+		static void recordInstant( const std::string_view& dynamicName );
+		static void setThreadName( const std::string& threadName );
+
+		// nanoseconds since the first traced event of the process
+		static std::uint64_t nowNs();
+		static void setEnabled( const bool& bEnabled );
+		static bool isEnabled();
+
+		// Chrome trace event format, loads in chrome://tracing and Perfetto
+		static bool writeChromeTrace( const std::filesystem::path& filePath );
+		static void clear();
+	};
+
+	class TraceScope
+	{
+	public:
+		explicit TraceScope( const char* pStaticName )
+			:m_pStaticName{ pStaticName }
+			,m_beginNs{ CpuTracer::nowNs() }
+		{}
+
+		// the name must outlive the scope
+		explicit TraceScope( const std::string& dynamicName )
+			:m_pStaticName{ nullptr }
+			,m_dynamicName{ dynamicName }
+			,m_beginNs{ CpuTracer::nowNs() }
+		{}
+
+		~TraceScope()
+		{
+			if( m_pStaticName )
+				CpuTracer::recordZone( m_pStaticName, m_beginNs, CpuTracer::nowNs() );
+			else
+				CpuTracer::recordZone( m_dynamicName, m_beginNs, CpuTracer::nowNs() );
+		}
+
+		TraceScope( const TraceScope& ) = delete;
+		TraceScope& operator=( const TraceScope& ) = delete;
+
+	private:
+		const char* m_pStaticName;
+		std::string_view m_dynamicName;
+		std::uint64_t m_beginNs;
+	};
+
+} // namespace utils
+
+// compiled out unless the VKRENDER_ENABLE_TRACING cmake option is on
+#ifdef VKRENDER_TRACING_ENABLED
+	#define TRACE_CONCAT_IMPL( a, b ) a##b
+	#define TRACE_CONCAT( a, b ) TRACE_CONCAT_IMPL( a, b )
+	#define TRACE_SCOPE( name ) utils::TraceScope TRACE_CONCAT( traceScope_, __COUNTER__ ){ name }
+	#define TRACE_INSTANT( name ) utils::CpuTracer::recordInstant( name )
+#else
+	#define TRACE_SCOPE( name ) ((void)0)
+	#define TRACE_INSTANT( name ) ((void)0)
+#endif
+
+#endif
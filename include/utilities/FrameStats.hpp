@@ -0,0 +1,135 @@
+#ifndef UTILS_FRAME_STATS_HPP
+#define UTILS_FRAME_STATS_HPP
+
+#include "utilities/VulkanLogger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace utils
+{
+	// Frame time, input to present latency, command recording and gpu time samples, reported as percentiles.
+	// Gpu samples arrive frames in flight late and are skipped when the queue has no timestamps. Input to display
+	// samples only exist when the frame pacer blocked on present wait.
+	class FrameStats
+	{
+	public:
+		void reset()
+		{
+			m_frameTimesMs.clear();
+			m_inputToPresentMs.clear();
+			m_gpuTimesMs.clear();
+			m_recordTimesMs.clear();
+			m_inputToDisplayMs.clear();
+		}
+
+		void reserve( const std::size_t& frameCount )
+		{
+			m_frameTimesMs.reserve( frameCount );
+			m_inputToPresentMs.reserve( frameCount );
+			m_gpuTimesMs.reserve( frameCount );
+			m_recordTimesMs.reserve( frameCount );
+			m_inputToDisplayMs.reserve( frameCount );
+		}
+
+		void recordFrame( const double& frameTimeMs, const double& inputToPresentMs )
+		{
+			m_frameTimesMs.push_back( frameTimeMs );
+			m_inputToPresentMs.push_back( inputToPresentMs );
+		}
+
+		// pools samples from several runs
+		void append( const FrameStats& other )
+		{
+			m_frameTimesMs.insert( m_frameTimesMs.end(), other.m_frameTimesMs.begin(), other.m_frameTimesMs.end() );
+			m_inputToPresentMs.insert( m_inputToPresentMs.end(), other.m_inputToPresentMs.begin(), other.m_inputToPresentMs.end() );
+			m_gpuTimesMs.insert( m_gpuTimesMs.end(), other.m_gpuTimesMs.begin(), other.m_gpuTimesMs.end() );
+			m_recordTimesMs.insert( m_recordTimesMs.end(), other.m_recordTimesMs.begin(), other.m_recordTimesMs.end() );
+			m_inputToDisplayMs.insert( m_inputToDisplayMs.end(), other.m_inputToDisplayMs.begin(), other.m_inputToDisplayMs.end() );
+		}
+
+		void recordGpuTime( const double& gpuTimeMs )
+		{
+			m_gpuTimesMs.push_back( gpuTimeMs );
+		}
+
+		void recordCommandRecordingTime( const double& recordTimeMs )
+		{
+			m_recordTimesMs.push_back( recordTimeMs );
+		}
+
+		void recordInputToDisplay( const double& inputToDisplayMs )
+		{
+			m_inputToDisplayMs.push_back( inputToDisplayMs );
+		}
+
+		double getFrameTimePercentile( const double& percentile ) const { return computePercentile( m_frameTimesMs, percentile ); }
+		double getInputToPresentPercentile( const double& percentile ) const { return computePercentile( m_inputToPresentMs, percentile ); }
+		double getGpuTimePercentile( const double& percentile ) const { return computePercentile( m_gpuTimesMs, percentile ); }
+		double getRecordTimePercentile( const double& percentile ) const { return computePercentile( m_recordTimesMs, percentile ); }
+		double getInputToDisplayPercentile( const double& percentile ) const { return computePercentile( m_inputToDisplayMs, percentile ); }
+		std::size_t getFrameCount() const { return m_frameTimesMs.size(); }
+		std::size_t getGpuSampleCount() const { return m_gpuTimesMs.size(); }
+		std::size_t getRecordSampleCount() const { return m_recordTimesMs.size(); }
+		std::size_t getInputToDisplaySampleCount() const { return m_inputToDisplayMs.size(); }
+
+		void log( const std::string& label ) const
+		{
+			LOG_INFO( fmt::format( 
+				"{}: {} frames, frame time p50 {:.3f} p95 {:.3f} p99 {:.3f} ms, input to present p50 {:.3f} p95 {:.3f} p99 {:.3f} ms",
+				label, getFrameCount(),
+				getFrameTimePercentile( 50.0 ), getFrameTimePercentile( 95.0 ), getFrameTimePercentile( 99.0 ),
+				getInputToPresentPercentile( 50.0 ), getInputToPresentPercentile( 95.0 ), getInputToPresentPercentile( 99.0 )
+			) );
+			if( !m_recordTimesMs.empty() )
+			{
+				LOG_INFO( fmt::format( 
+					"{}: command recording p50 {:.3f} p95 {:.3f} p99 {:.3f} ms",
+					label, getRecordTimePercentile( 50.0 ), getRecordTimePercentile( 95.0 ), getRecordTimePercentile( 99.0 )
+				) );
+			}
+			if( !m_inputToDisplayMs.empty() )
+			{
+				LOG_INFO( fmt::format( 
+					"{}: {} present wait samples, input to display p50 {:.3f} p95 {:.3f} p99 {:.3f} ms",
+					label, getInputToDisplaySampleCount(),
+					getInputToDisplayPercentile( 50.0 ), getInputToDisplayPercentile( 95.0 ), getInputToDisplayPercentile( 99.0 )
+				) );
+			}
+			if( !m_gpuTimesMs.empty() )
+			{
+				LOG_INFO( fmt::format( 
+					"{}: {} gpu samples, gpu time p50 {:.3f} p95 {:.3f} p99 {:.3f} ms",
+					label, getGpuSampleCount(),
+					getGpuTimePercentile( 50.0 ), getGpuTimePercentile( 95.0 ), getGpuTimePercentile( 99.0 )
+				) );
+			}
+		}
+
+		// nearest rank
+		static double computePercentile( std::vector<double> samples, const double& percentile )
+		{
+			if( samples.empty() )
+				return 0.0;
+
+			std::size_t rank = static_cast<std::size_t>( std::ceil( percentile / 100.0 * samples.size() ) );
+			std::size_t sampleIndex = std::min( samples.size() - 1, rank > 0 ? rank - 1 : 0 );
+
+			std::nth_element( samples.begin(), samples.begin() + sampleIndex, samples.end() );
+			return samples[sampleIndex];
+		}
+
+	private:
+		std::vector<double> m_frameTimesMs;
+		std::vector<double> m_inputToPresentMs;
+		std::vector<double> m_gpuTimesMs;
+		std::vector<double> m_recordTimesMs;
+		std::vector<double> m_inputToDisplayMs;
+	};
+
+} // namespace utils
+
+#endif
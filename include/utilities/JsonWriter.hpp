@@ -0,0 +1,143 @@
+#ifndef UTILS_JSON_WRITER_HPP
+#define UTILS_JSON_WRITER_HPP
+
+#include <spdlog/fmt/fmt.h>
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace utils
+{
+	// Streams an indented JSON document into a string. Keyed writes belong inside objects, unkeyed ones inside arrays.
+	class JsonWriter
+	{
+	public:
+		void beginObject() { writeSeparator(); openScope( '{' ); }
+		void beginObject( const std::string_view& key ) { writeKey( key ); openScope( '{' ); }
+		void endObject() { closeScope( '}' ); }
+
+		void beginArray() { writeSeparator(); openScope( '[' ); }
+		void beginArray( const std::string_view& key ) { writeKey( key ); openScope( '[' ); }
+		void endArray() { closeScope( ']' ); }
+
+		template<typename ValueType>
+		void write( const std::string_view& key, const ValueType& value )
+		{
+			writeKey( key );
+			writeValue( value );
+		}
+
+		template<typename ValueType>
+		void write( const ValueType& value )
+		{
+			writeSeparator();
+			writeValue( value );
+		}
+
+		const std::string& str() const { return m_buffer; }
+
+		bool writeToFile( const std::filesystem::path& filePath ) const
+		{
+			std::ofstream outputFile{ filePath, std::ios::binary | std::ios::trunc };
+			if( !outputFile )
+				return false;
+			outputFile << m_buffer << '\n';
+			return static_cast<bool>( outputFile );
+		}
+
+	private:
+		void openScope( const char& openChar )
+		{
+			m_buffer += openChar;
+			m_scopeHasEntries.push_back( false );
+		}
+
+		void closeScope( const char& closeChar )
+		{
+			bool bHadEntries = m_scopeHasEntries.back();
+			m_scopeHasEntries.pop_back();
+			if( bHadEntries )
+				newLine();
+			m_buffer += closeChar;
+		}
+
+		void writeSeparator()
+		{
+			if( m_scopeHasEntries.empty() )
+				return;
+			if( m_scopeHasEntries.back() )
+				m_buffer += ',';
+			m_scopeHasEntries.back() = true;
+			newLine();
+		}
+
+		void writeKey( const std::string_view& key )
+		{
+			writeSeparator();
+			writeString( key );
+			m_buffer += ": ";
+		}
+
+		void newLine()
+		{
+			m_buffer += '\n';
+			m_buffer.append( m_scopeHasEntries.size() * 2, ' ' );
+		}
+
+		template<typename ValueType>
+		void writeValue( const ValueType& value )
+		{
+			if constexpr( std::is_same_v<ValueType, bool> )
+			{
+				m_buffer += value ? "true" : "false";
+			}
+			else if constexpr( std::is_integral_v<ValueType> )
+			{
+				m_buffer += std::to_string( value );
+			}
+			else if constexpr( std::is_floating_point_v<ValueType> )
+			{
+				// JSON has no representation for nan or infinity
+				m_buffer += std::isfinite( value ) ? fmt::format( "{}", value ) : std::string{ "null" };
+			}
+			else
+			{
+				writeString( std::string_view{ value } );
+			}
+		}
+
+		void writeString( const std::string_view& value )
+		{
+			m_buffer += '"';
+			for( const char& character : value )
+			{
+				switch( character )
+				{
+					case '"': m_buffer += "\\\""; break;
+					case '\\': m_buffer += "\\\\"; break;
+					case '\n': m_buffer += "\\n"; break;
+					case '\r': m_buffer += "\\r"; break;
+					case '\t': m_buffer += "\\t"; break;
+					default:
+						if( static_cast<unsigned char>( character ) < 0x20 )
+							m_buffer += fmt::format( "\\u{:04x}", static_cast<unsigned int>( character ) );
+						else
+							m_buffer += character;
+				}
+			}
+			m_buffer += '"';
+		}
+
+		std::string m_buffer;
+		std::vector<bool> m_scopeHasEntries;
+	};
+
+} // namespace utils
+
+#endif
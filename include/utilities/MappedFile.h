@@ -0,0 +1,45 @@
+#ifndef UTILS_MAPPED_FILE_H
+#define UTILS_MAPPED_FILE_H
+
+#include "exports.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace utils
+{
+	// Read only view of a whole file mapped into the address space. Pages are faulted in on first access,
+	// so reading a few bytes of a large file does not pull the rest of it off disk.
+	class VULKAN_EXPORTS MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile( const MappedFile& ) = delete;
+		MappedFile( MappedFile&& ) = delete;
+		~MappedFile();
+
+		MappedFile& operator=( const MappedFile& ) = delete;
+		MappedFile& operator=( MappedFile&& ) = delete;
+
+		// false when the file cannot be opened or is empty, there is nothing to map in an empty file
+		bool open( const std::filesystem::path& filePath );
+		void close();
+
+		bool isOpen() const;
+		const std::uint8_t* getData() const;
+		std::size_t getSize() const;
+	private:
+#ifdef _WIN32
+		void* m_fileHandle{ nullptr };
+		void* m_mappingHandle{ nullptr };
+#else
+		int m_fileDescriptor{ -1 };
+#endif
+		const std::uint8_t* m_pData{ nullptr };
+		std::size_t m_size{ 0 };
+	};
+
+} // namespace utils
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef UTILS_STARTUP_TRACE_HPP
+#define UTILS_STARTUP_TRACE_HPP
+
+#include "utilities/VulkanLogger.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace utils
+{
+	class StartupTrace
+	{
+	public:
+		using Clock = std::chrono::high_resolution_clock;
+
+		struct Step
+		{
+			std::string	m_name;
+			double		m_durationMs;
+		};
+
+		StartupTrace()
+			:m_bFirstFrameMarked{ false }
+			,m_queueSubmitCount{ 0 }
+			,m_blockingWaitCount{ 0 }
+			,m_initDurationMs{ 0.0 }
+			,m_timeToFirstFrameMs{ 0.0 }
+		{}
+
+		void begin()
+		{
+			m_start = Clock::now();
+			m_steps.clear();
+			m_bFirstFrameMarked = false;
+			m_queueSubmitCount = 0;
+			m_blockingWaitCount = 0;
+		}
+
+		template<typename StepFunc>
+		void traceStep( const std::string& stepName, StepFunc&& stepFunc )
+		{
+			TRACE_SCOPE( stepName );
+			auto stepStart = Clock::now();
+			stepFunc();
+			m_steps.push_back( Step{ stepName, elapsedMs( stepStart ) } );
+		}
+
+		// for work timed inside a step, logged in order with the steps
+		void recordStep( const std::string& stepName, const double& durationMs )
+		{
+			m_steps.push_back( Step{ stepName, durationMs } );
+		}
+
+		void countSubmission( const bool& bBlockingWait )
+		{
+			if( m_bFirstFrameMarked )
+				return;
+			m_queueSubmitCount++;
+			if( bBlockingWait ) m_blockingWaitCount++;
+		}
+
+		void markInitialised()
+		{
+			m_initDurationMs = elapsedMs( m_start );
+		}
+
+		void markFirstFrame()
+		{
+			if( m_bFirstFrameMarked )
+				return;
+			m_bFirstFrameMarked = true;
+			m_timeToFirstFrameMs = elapsedMs( m_start );
+			log();
+		}
+
+		void log() const
+		{
+			for( const auto& step : m_steps )
+			{
+				LOG_DEBUG( fmt::format( "Startup: {:<28} {:8.3f} ms", step.m_name, step.m_durationMs ) );
+			}
+			LOG_INFO( fmt::format( 
+				"Startup: init {:.3f} ms, first frame {:.3f} ms, {} queue submissions, {} blocking waits",
+				m_initDurationMs, m_timeToFirstFrameMs, m_queueSubmitCount, m_blockingWaitCount
+			) );
+		}
+
+		const std::vector<Step>& getSteps() const { return m_steps; }
+		double getInitDurationMs() const { return m_initDurationMs; }
+		double getTimeToFirstFrameMs() const { return m_timeToFirstFrameMs; }
+		std::uint32_t getQueueSubmitCount() const { return m_queueSubmitCount; }
+		std::uint32_t getBlockingWaitCount() const { return m_blockingWaitCount; }
+
+	private:
+		static double elapsedMs( const Clock::time_point& since )
+		{
+			return std::chrono::duration<double, std::milli>( Clock::now() - since ).count();
+		}
+
+		Clock::time_point m_start;
+		std::vector<Step> m_steps;
+		bool m_bFirstFrameMarked;
+		std::uint32_t m_queueSubmitCount;
+		std::uint32_t m_blockingWaitCount;
+		double m_initDurationMs;
+		double m_timeToFirstFrameMs;
+	};
+} // namespace utils
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include "exports.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+	// Fixed set of worker threads that run one dispatch at a time. The dispatching thread takes part in the
+	// work, so a pool of N workers spreads a dispatch over N + 1 thread slots, the caller being the last slot.
+	class VULKAN_EXPORTS ThreadPool
+	{
+	public:
+		using Task = std::function<void( const std::uint32_t& taskIndex, const std::uint32_t& threadSlot )>;
+
+		explicit ThreadPool( const std::uint32_t& workerCount );
+		ThreadPool( const ThreadPool& ) = delete;
+		ThreadPool( ThreadPool&& ) = delete;
+		~ThreadPool();
+
+		ThreadPool& operator=( const ThreadPool& ) = delete;
+		ThreadPool& operator=( ThreadPool&& ) = delete;
+
+		// runs task for every index below taskCount and returns once all of them have finished
+		void dispatch( const std::uint32_t& taskCount, const Task& task );
+
+		std::uint32_t getThreadSlotCount() const;
+	private:
+		void workerLoop( const std::uint32_t& threadSlot );
+		void runTasks( const std::uint32_t& threadSlot );
+
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_workDone;
+		// bumped for every dispatch so a worker never runs the same one twice
+		std::uint64_t m_dispatchIndex;
+		std::uint32_t m_busyWorkerCount;
+		bool m_bStopping;
+
+		const Task* m_pTask;
+		std::uint32_t m_taskCount;
+		std::atomic<std::uint32_t> m_nextTaskIndex;
+	};
+
+} // namespace utils
+
+#endif
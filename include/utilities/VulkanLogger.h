@@ -4,6 +4,7 @@
 #include "exports.hpp"
 #include "utilities/memory.hpp"
 #include "utilities/Singleton.hpp"
+#include "utilities/CpuTracer.h"
 
 #include <initializer_list>
 #include <spdlog/spdlog.h>
@@ -61,6 +62,11 @@ namespace utils
     public:
         static void logMessage( const std::string& message, const logger::level& level )
         {
+#ifdef VKRENDER_TRACING_ENABLED
+            // log lines show up as instants on the trace timeline, nothing is compiled in without tracing
+            TRACE_INSTANT( message );
+#endif
+
             auto pLogger = VulkanRendererApiLogger::getSingletonPtr()->getLogger();
 
             switch (level)
@@ -0,0 +1,45 @@
+#ifndef VKRENDER_VULKAN_DELETION_QUEUE_H
+#define VKRENDER_VULKAN_DELETION_QUEUE_H
+
+#include "exports.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace vkrender
+{
+	// Destroys retired objects once the frame they were last used in has completed on the device.
+	// Frame values may be retired out of order, objects are kept sorted by them.
+	class VULKAN_EXPORTS VulkanDeletionQueue
+	{
+	public:
+		VulkanDeletionQueue() = default;
+		VulkanDeletionQueue( const VulkanDeletionQueue& ) = delete;
+		VulkanDeletionQueue( VulkanDeletionQueue&& ) = delete;
+		~VulkanDeletionQueue();
+
+		VulkanDeletionQueue& operator=( const VulkanDeletionQueue& ) = delete;
+		VulkanDeletionQueue& operator=( VulkanDeletionQueue&& ) = delete;
+
+		void retire( const std::uint64_t& lastUsedFrameValue, std::function<void()> deleter );
+		void collect( const std::uint64_t& completedFrameValue );
+		// only once the device is idle
+		void flush();
+
+		std::size_t getPendingCount() const;
+		std::uint64_t getTotalRetiredCount() const;
+	private:
+		struct RetiredObject
+		{
+			std::uint64_t			m_lastUsedFrameValue;
+			std::function<void()>	m_deleter;
+		};
+
+		std::deque<RetiredObject> m_retiredObjects;
+		std::uint64_t m_totalRetiredCount{ 0 };
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef VKRENDER_VULKAN_DEVICE_CAPABILITIES_H
+#define VKRENDER_VULKAN_DEVICE_CAPABILITIES_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "vkrenderer/VulkanQueueFamily.hpp"
+#include "exports.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace vkrender
+{
+	// Everything the renderer needs to know about a physical device, queried once when the device is
+	// picked and read only after that, so any thread may query it. Format properties are snapshotted for
+	// the formats the renderer uses, see SNAPSHOT_FORMATS. Surface capabilities are left out, the current
+	// extent changes with the window.
+	class VULKAN_EXPORTS DeviceCapabilities
+	{
+	public:
+		// depth candidates, the texture and offscreen target format and the preferred swapchain format
+		static constexpr vk::Format SNAPSHOT_FORMATS[] = {
+			vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint,
+			vk::Format::eR8G8B8A8Srgb,
+			vk::Format::eB8G8R8A8Srgb
+		};
+
+		DeviceCapabilities() = default;
+		DeviceCapabilities( const vk::PhysicalDevice& physicalDevice, const vk::SurfaceKHR* pSurface );
+
+		const vk::PhysicalDevice& getPhysicalDevice() const;
+		const vk::PhysicalDeviceProperties& getProperties() const;
+		const vk::PhysicalDeviceFeatures& getFeatures() const;
+		const vk::PhysicalDeviceLimits& getLimits() const;
+		const vk::PhysicalDeviceMemoryProperties& getMemoryProperties() const;
+		const std::vector<vk::QueueFamilyProperties>& getQueueFamilyProperties() const;
+		const QueueFamilyIndices& getQueueFamilyIndices() const;
+		// graphics plus the exclusive transfer family, the families concurrent resources are shared between
+		const std::vector<std::uint32_t>& getSharedQueueFamilies() const;
+
+		// core from 1.3, older devices only render through render passes
+		bool supportsDynamicRendering() const;
+		// VK_KHR_present_id and VK_KHR_present_wait with both features, only queried for presenting devices
+		bool supportsPresentWait() const;
+		// throws for a format outside SNAPSHOT_FORMATS
+		const vk::FormatProperties& getFormatProperties( const vk::Format& format ) const;
+
+		std::uint32_t findMemoryType( const std::uint32_t& typeFilter, const vk::MemoryPropertyFlags& propertyFlags, const vk::MemoryPropertyFlags& preferredFlags = vk::MemoryPropertyFlags{} ) const;
+		vk::SampleCountFlagBits getMaxUsableSampleCount() const;
+	private:
+		vk::PhysicalDevice m_vkPhysicalDevice;
+		vk::PhysicalDeviceProperties m_vkProperties;
+		vk::PhysicalDeviceFeatures m_vkFeatures;
+		vk::PhysicalDeviceMemoryProperties m_vkMemoryProperties;
+		std::vector<vk::QueueFamilyProperties> m_queueFamilyProperties;
+		QueueFamilyIndices m_queueFamilyIndices;
+		std::vector<std::uint32_t> m_sharedQueueFamilies;
+		bool m_bDynamicRendering{ false };
+		bool m_bPresentWait{ false };
+
+		std::unordered_map<vk::Format, vk::FormatProperties> m_formatProperties;
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef VKRENDER_VULKAN_FRAME_PACER_H
+#define VKRENDER_VULKAN_FRAME_PACER_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace vkrender
+{
+	// Holds the next frame back until it is due, either to cap the frame rate or to keep the number of
+	// presents queued ahead of the display bounded. Both waits belong before input is sampled, so the time
+	// spent in them does not show up as latency. Present wait is loaded at runtime and only used when the
+	// device enabled VK_KHR_present_id and VK_KHR_present_wait.
+	class VULKAN_EXPORTS VulkanFramePacer
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		VulkanFramePacer( const vk::Device& logicalDevice, const bool& bPresentWait, const double& frameRateLimit, const std::uint32_t& maxQueuedPresents );
+		VulkanFramePacer( const VulkanFramePacer& ) = delete;
+		VulkanFramePacer( VulkanFramePacer&& ) = delete;
+		~VulkanFramePacer() = default;
+
+		VulkanFramePacer& operator=( const VulkanFramePacer& ) = delete;
+		VulkanFramePacer& operator=( VulkanFramePacer&& ) = delete;
+
+		// present ids are per swapchain, presents still pending on the old one are no longer waited on
+		void setSwapchain( const vk::SwapchainKHR& swapchain );
+		// true when it blocked on a present that had not reached the display yet, inputToDisplayMs is then
+		// measured from that frame's input sample to the moment the wait returned
+		bool waitForQueuedPresents( double& inputToDisplayMs );
+		// sleeps most of the way to the frame's start time and spins the rest, sleep alone overshoots by the scheduler's granularity
+		void waitForFrameRateLimit();
+		// id to chain into the present through vk::PresentIdKHR, 0 when present wait is not in use
+		std::uint64_t beginPresent( const std::chrono::high_resolution_clock::time_point& inputSampleTime );
+
+		bool isPresentWaitEnabled() const;
+	private:
+		struct PendingPresent
+		{
+			std::uint64_t									m_presentId;
+			std::chrono::high_resolution_clock::time_point	m_inputSampleTime;
+		};
+
+		vk::Result waitForPresent( const std::uint64_t& presentId, const std::uint64_t& timeoutNs ) const;
+
+		vk::Device m_vkLogicalDevice;
+		vk::SwapchainKHR m_vkSwapchain;
+		PFN_vkWaitForPresentKHR m_pfnWaitForPresent;
+
+		Clock::duration m_frameInterval;
+		Clock::time_point m_nextFrameTime;
+
+		std::uint32_t m_maxQueuedPresents;
+		std::uint64_t m_lastPresentId;
+		// presented but not yet seen on the display, oldest first
+		std::deque<PendingPresent> m_pendingPresents;
+	};
+
+} // namespace vkrender
+
+#endif
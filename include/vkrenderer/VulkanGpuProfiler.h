@@ -0,0 +1,122 @@
+#ifndef VKRENDER_VULKAN_GPU_PROFILER_H
+#define VKRENDER_VULKAN_GPU_PROFILER_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vkrender
+{
+	// Named timestamp scopes and optional pipeline statistics recorded into one set of query pools per frame slot.
+	// A slot's results are read without waiting once its previous frame has completed, frames in flight after it was recorded.
+	class VULKAN_EXPORTS VulkanGpuProfiler
+	{
+	public:
+		static constexpr std::uint32_t DEFAULT_MAX_SCOPES_PER_FRAME = 32;
+		// ending it is a no-op
+		static constexpr std::uint32_t INVALID_SCOPE = ~0u;
+
+		struct ScopeResult
+		{
+			std::string		m_name;
+			std::uint32_t	m_depth;
+			double			m_durationMs;
+		};
+
+		struct PipelineStatistics
+		{
+			std::uint64_t	m_inputAssemblyVertices{ 0 };
+			std::uint64_t	m_inputAssemblyPrimitives{ 0 };
+			std::uint64_t	m_vertexShaderInvocations{ 0 };
+			std::uint64_t	m_clippingPrimitives{ 0 };
+			std::uint64_t	m_fragmentShaderInvocations{ 0 };
+		};
+
+		struct FrameResult
+		{
+			std::uint64_t				m_frameValue{ 0 };
+			std::vector<ScopeResult>	m_scopes;
+			bool						m_bHasPipelineStatistics{ false };
+			PipelineStatistics			m_pipelineStatistics;
+		};
+
+		VulkanGpuProfiler(
+			const vk::Device& logicalDevice,
+			const std::uint32_t& frameSlotCount,
+			const double& timestampPeriodNs,
+			const std::uint32_t& timestampValidBits,
+			const bool& bPipelineStatistics,
+			const std::uint32_t& maxScopesPerFrame = DEFAULT_MAX_SCOPES_PER_FRAME
+		);
+		VulkanGpuProfiler( const VulkanGpuProfiler& ) = delete;
+		VulkanGpuProfiler( VulkanGpuProfiler&& ) = delete;
+		~VulkanGpuProfiler();
+
+		VulkanGpuProfiler& operator=( const VulkanGpuProfiler& ) = delete;
+		VulkanGpuProfiler& operator=( VulkanGpuProfiler&& ) = delete;
+
+		// the slot must have been collected, its queries are reset at the start of the command buffer
+		void beginFrame( const vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& frameSlot, const std::uint64_t& frameValue );
+		// for a command buffer recorded earlier and submitted again, it must record the same scopes as the slot's last recording
+		void resubmitFrame( const std::uint32_t& frameSlot, const std::uint64_t& frameValue );
+		// returns the scope to end, scopes past the per frame budget are dropped
+		std::uint32_t beginScope( const vk::CommandBuffer& vkCommandBuffer, const std::string& scopeName, const vk::PipelineStageFlagBits& stage = vk::PipelineStageFlagBits::eTopOfPipe );
+		void endScope( const vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& scopeIndex, const vk::PipelineStageFlagBits& stage = vk::PipelineStageFlagBits::eBottomOfPipe );
+		// must begin and end inside the same subpass when used inside a render pass
+		void beginPipelineStatistics( const vk::CommandBuffer& vkCommandBuffer );
+		void endPipelineStatistics( const vk::CommandBuffer& vkCommandBuffer );
+
+		// true when a new frame result was collected, an unfinished frame stays pending for a later call
+		bool collect( const std::uint32_t& frameSlot );
+		void resetSamples();
+		void destroy();
+
+		bool hasPipelineStatistics() const;
+		const FrameResult& getLatestResult() const;
+		// durations of every collected scope by name, in collection order
+		const std::map<std::string, std::vector<double>>& getScopeSamples() const;
+		// summed over getPipelineStatisticsFrameCount frames
+		const PipelineStatistics& getPipelineStatisticsTotals() const;
+		std::uint64_t getPipelineStatisticsFrameCount() const;
+	private:
+		struct RecordedScope
+		{
+			std::string		m_name;
+			std::uint32_t	m_depth;
+			bool			m_bEnded;
+		};
+
+		struct FrameSlot
+		{
+			vk::QueryPool				m_vkTimestampQueryPool;
+			vk::QueryPool				m_vkPipelineStatisticsQueryPool;
+			std::vector<RecordedScope>	m_scopes;
+			std::uint64_t				m_frameValue{ 0 };
+			bool						m_bPipelineStatisticsRecorded{ false };
+			bool						m_bPending{ false };
+		};
+
+		vk::Device m_vkLogicalDevice;
+		double m_timestampPeriodNs;
+		std::uint64_t m_timestampValidMask;
+		bool m_bPipelineStatistics;
+		std::uint32_t m_maxScopesPerFrame;
+
+		std::vector<FrameSlot> m_frameSlots;
+		std::uint32_t m_recordingSlot;
+		std::uint32_t m_openScopeDepth;
+
+		FrameResult m_latestResult;
+		std::map<std::string, std::vector<double>> m_scopeSamplesMs;
+		PipelineStatistics m_pipelineStatisticsTotals;
+		std::uint64_t m_pipelineStatisticsFrameCount;
+	};
+
+} // namespace vkrender
+
+#endif
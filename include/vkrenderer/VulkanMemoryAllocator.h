@@ -0,0 +1,113 @@
+#ifndef VKRENDER_VULKAN_MEMORY_ALLOCATOR_H
+#define VKRENDER_VULKAN_MEMORY_ALLOCATOR_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "utilities/memory.hpp"
+#include "exports.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace vkrender
+{
+	enum class AllocationStrategy
+	{
+		eFreeList,
+		eLinear
+	};
+
+	// buffers and linear images vs optimal images, needed for bufferImageGranularity
+	enum class AllocationResourceType
+	{
+		eLinear,
+		eNonLinear
+	};
+
+	struct VulkanMemoryBlock;
+
+	struct VulkanAllocation
+	{
+		vk::DeviceMemory	m_memory;
+		vk::DeviceSize		m_offset{ 0 };
+		vk::DeviceSize		m_size{ 0 };
+		void*				m_pMappedData{ nullptr };
+		std::uint32_t		m_memoryTypeIndex{ 0 };
+		VulkanMemoryBlock*	m_pBlock{ nullptr };
+
+		bool isValid() const { return m_pBlock != nullptr; }
+	};
+
+	struct VulkanAllocatorStats
+	{
+		std::uint32_t	m_liveBlockCount{ 0 };
+		std::uint32_t	m_dedicatedBlockCount{ 0 };
+		std::uint32_t	m_liveAllocationCount{ 0 };
+		std::uint64_t	m_totalDeviceMemoryAllocations{ 0 };
+		std::uint64_t	m_totalSubAllocations{ 0 };
+		vk::DeviceSize	m_blockBytes{ 0 };
+		vk::DeviceSize	m_usedBytes{ 0 };
+		vk::DeviceSize	m_wastedBytes{ 0 };
+		// 0 when all free space is one contiguous range, approaches 1 as it scatters
+		float			m_fragmentation{ 0.0f };
+	};
+
+	class VULKAN_EXPORTS VulkanMemoryAllocator
+	{
+	public:
+		static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024ull * 1024ull;
+
+		VulkanMemoryAllocator(
+			const vk::Device& logicalDevice,
+			const vk::PhysicalDeviceMemoryProperties& memoryProperties,
+			const vk::DeviceSize& bufferImageGranularity,
+			const vk::DeviceSize& preferredBlockSize = DEFAULT_BLOCK_SIZE
+		);
+		VulkanMemoryAllocator( const VulkanMemoryAllocator& ) = delete;
+		VulkanMemoryAllocator( VulkanMemoryAllocator&& ) = delete;
+		~VulkanMemoryAllocator();
+
+		VulkanMemoryAllocator& operator=( const VulkanMemoryAllocator& ) = delete;
+		VulkanMemoryAllocator& operator=( VulkanMemoryAllocator&& ) = delete;
+
+		VulkanAllocation allocate(
+			const vk::MemoryRequirements& memRequirements,
+			const std::uint32_t& memoryTypeIndex,
+			const AllocationResourceType& resourceType,
+			const AllocationStrategy& strategy = AllocationStrategy::eFreeList
+		);
+		void free( VulkanAllocation& allocation );
+		void destroy();
+
+		VulkanAllocatorStats getStats() const;
+		void logStats() const;
+
+	private:
+		using MemoryBlockPool = std::vector<utils::Uptr<VulkanMemoryBlock>>;
+
+		VulkanMemoryBlock* createBlock( const std::uint32_t& memoryTypeIndex, const vk::DeviceSize& blockSize, const AllocationStrategy& strategy, const bool& bDedicated );
+		void destroyBlock( VulkanMemoryBlock* pBlock );
+		void releaseBlockIfUnused( VulkanMemoryBlock* pBlock );
+		vk::DeviceSize blockSizeForMemoryType( const std::uint32_t& memoryTypeIndex ) const;
+
+		bool allocateFromFreeList( VulkanMemoryBlock* pBlock, const vk::MemoryRequirements& memRequirements, const AllocationResourceType& resourceType, VulkanAllocation& allocation );
+		bool allocateFromLinear( VulkanMemoryBlock* pBlock, const vk::MemoryRequirements& memRequirements, const AllocationResourceType& resourceType, VulkanAllocation& allocation );
+
+		vk::Device m_vkLogicalDevice;
+		vk::PhysicalDeviceMemoryProperties m_vkMemoryProperties;
+		vk::DeviceSize m_bufferImageGranularity;
+		vk::DeviceSize m_preferredBlockSize;
+
+		std::vector<MemoryBlockPool> m_memoryTypePools;
+
+		std::uint64_t m_totalDeviceMemoryAllocations;
+		std::uint64_t m_totalSubAllocations;
+
+		mutable std::mutex m_mutex;
+	};
+
+} // namespace vkrender
+
+#endif
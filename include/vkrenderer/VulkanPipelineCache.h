@@ -0,0 +1,57 @@
+#ifndef VKRENDER_VULKAN_PIPELINE_CACHE_H
+#define VKRENDER_VULKAN_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace vkrender
+{
+	// A vk::PipelineCache seeded from a file written by an earlier run. Data written by another driver,
+	// device or driver version is rejected by its header and the cache starts out empty. An empty path keeps it in memory.
+	class VULKAN_EXPORTS VulkanPipelineCache
+	{
+	public:
+		enum class LoadResult
+		{
+			eLoaded,
+			eMissing,
+			eRejected
+		};
+
+		VulkanPipelineCache( const vk::Device& logicalDevice, const vk::PhysicalDeviceProperties& physicalDeviceProperties, const std::filesystem::path& filePath );
+		VulkanPipelineCache( const VulkanPipelineCache& ) = delete;
+		VulkanPipelineCache( VulkanPipelineCache&& ) = delete;
+		~VulkanPipelineCache();
+
+		VulkanPipelineCache& operator=( const VulkanPipelineCache& ) = delete;
+		VulkanPipelineCache& operator=( VulkanPipelineCache&& ) = delete;
+
+		// merges in whatever another run saved since this one loaded, then replaces the file through a rename
+		bool save();
+		void destroy();
+
+		const vk::PipelineCache& getPipelineCache() const;
+		LoadResult getLoadResult() const;
+		std::size_t getLoadedSizeInBytes() const;
+
+		static bool isCompatible( const std::vector<std::uint8_t>& cacheData, const vk::PhysicalDeviceProperties& physicalDeviceProperties );
+	private:
+		static bool readFile( const std::filesystem::path& filePath, std::vector<std::uint8_t>& fileData );
+
+		vk::Device m_vkLogicalDevice;
+		vk::PhysicalDeviceProperties m_vkPhysicalDeviceProperties;
+		std::filesystem::path m_filePath;
+		vk::PipelineCache m_vkPipelineCache;
+
+		LoadResult m_loadResult;
+		std::size_t m_loadedSizeInBytes;
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef VKRENDER_VULKAN_RENDERER_SETTINGS_HPP
+#define VKRENDER_VULKAN_RENDERER_SETTINGS_HPP
+
+#include <cstdint>
+#include <filesystem>
+
+namespace vkrender
+{
+	enum class RenderingPath
+	{
+		eRenderPass,
+		// begins rendering on the attachments directly, no render pass or framebuffers to create or recreate
+		eDynamicRendering
+	};
+
+	// the requested mode falls back to fifo, the only one every surface has to support
+	enum class PresentModePolicy
+	{
+		eImmediate,
+		eMailbox,
+		eFifo,
+		eFifoRelaxed
+	};
+
+	// Applied on initialise. Fewer frames in flight trades throughput for input latency.
+	struct RendererSettings
+	{
+		static constexpr std::uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+		std::uint32_t	m_framesInFlight{ 2 };
+		// 0 asks for minImageCount + 1, otherwise clamped to what the surface supports
+		std::uint32_t	m_swapchainImageCount{ 0 };
+		// renders into offscreen images read back to the host, no window or surface is created
+		bool			m_bHeadless{ false };
+		std::uint32_t	m_headlessWidth{ 800 };
+		std::uint32_t	m_headlessHeight{ 600 };
+		// vertex and fragment invocation counters around the draw, ignored without pipelineStatisticsQuery
+		bool			m_bGpuPipelineStatistics{ false };
+		// threads recording the scene into secondary command buffers, 1 records inline and 0 uses every hardware thread
+		std::uint32_t	m_recordingThreadCount{ 1 };
+		// falls back to the render pass path on devices without dynamic rendering
+		RenderingPath	m_renderingPath{ RenderingPath::eRenderPass };
+		// submits command buffers recorded once per swapchain image and frame slot, re-recorded only when invalidated
+		bool			m_bReuseCommandBuffers{ false };
+		// the mesh's index range is split into this many draws, standing in for a scene of many objects
+		std::uint32_t	m_drawsPerFrame{ 1 };
+		// loaded on initialise and saved on shutdown, empty keeps the pipeline cache in memory only
+		std::filesystem::path	m_pipelineCacheFilePath{ "pipeline_cache.bin" };
+		// binary meshes are written here on first load and mapped afterwards, empty parses the OBJ every time
+		std::filesystem::path	m_meshCacheDirectory{ "mesh_cache" };
+		// threads parsing the OBJ when the mesh cache misses, 0 uses every hardware thread
+		std::uint32_t	m_meshLoadThreadCount{ 0 };
+		// above 0, vertices whose components round to the same multiple of it are merged on load
+		float			m_meshWeldEpsilon{ 0.0f };
+		// reorders triangles for the post transform cache and vertices for fetch locality after the vertices are merged
+		bool			m_bOptimizeMesh{ true };
+		// with m_bOptimizeMesh, also sorts clusters of triangles so the outward facing ones are drawn first
+		bool			m_bOptimizeMeshOverdraw{ false };
+		PresentModePolicy	m_presentModePolicy{ PresentModePolicy::eMailbox };
+		// acquires the swapchain image after the uniforms are updated instead of at the start of the frame
+		bool			m_bLateAcquire{ false };
+		// frames per second, 0 leaves the frame rate uncapped
+		double			m_frameRateLimit{ 0.0 };
+		// with present wait, blocks before sampling input while this many presents are still queued, 0 never blocks
+		std::uint32_t	m_maxQueuedPresents{ 0 };
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef VKRENDER_VULKAN_STAGING_ARENA_H
+#define VKRENDER_VULKAN_STAGING_ARENA_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <cstdint>
+#include <deque>
+
+namespace vkrender
+{
+	// Ring allocator over one persistently mapped staging buffer. Regions are tagged with the upload
+	// timeline value that consumes them when the batch is submitted and handed back once it is reached.
+	class VULKAN_EXPORTS VulkanStagingArena
+	{
+	public:
+		struct Slice
+		{
+			vk::Buffer		m_vkBuffer;
+			vk::DeviceSize	m_offset;
+			void*			m_pMappedData;
+		};
+
+		VulkanStagingArena(
+			const vk::Buffer& stagingBuffer,
+			void* pMappedData,
+			const vk::DeviceSize& capacity,
+			const vk::DeviceSize& offsetAlignment
+		);
+		~VulkanStagingArena() = default;
+
+		bool tryAllocate( const vk::DeviceSize& sizeInBytes, Slice& slice );
+		// tags every region allocated since the last submission with the timeline value of that submission
+		void retire( const std::uint64_t& timelineValue );
+		void reclaim( const std::uint64_t& completedTimelineValue );
+
+		bool hasUnsubmittedRegions() const;
+		// 0 when nothing submitted is still pending
+		std::uint64_t getOldestPendingTimelineValue() const;
+		vk::DeviceSize getCapacity() const;
+		vk::DeviceSize getUsedBytes() const;
+	private:
+		struct Region
+		{
+			vk::DeviceSize	m_end;
+			vk::DeviceSize	m_sizeInBytes;
+			std::uint64_t	m_timelineValue;
+		};
+
+		vk::Buffer m_vkStagingBuffer;
+		std::uint8_t* m_pMappedData;
+		vk::DeviceSize m_capacity;
+		vk::DeviceSize m_offsetAlignment;
+
+		vk::DeviceSize m_head;
+		vk::DeviceSize m_tail;
+		vk::DeviceSize m_usedBytes;
+
+		std::deque<Region> m_regions;
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef VKRENDER_VULKAN_THREAD_COMMAND_POOLS_H
+#define VKRENDER_VULKAN_THREAD_COMMAND_POOLS_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace vkrender
+{
+	// One transient command pool per frame slot and recording thread, so threads never share a pool.
+	// A slot's pools are reset as a whole once its previous frame has completed, the secondary buffers allocated
+	// from them are reused in the same order the next time round.
+	class VULKAN_EXPORTS VulkanThreadCommandPools
+	{
+	public:
+		VulkanThreadCommandPools(
+			const vk::Device& logicalDevice,
+			const std::uint32_t& queueFamilyIndex,
+			const std::uint32_t& frameSlotCount,
+			const std::uint32_t& threadSlotCount
+		);
+		VulkanThreadCommandPools( const VulkanThreadCommandPools& ) = delete;
+		VulkanThreadCommandPools( VulkanThreadCommandPools&& ) = delete;
+		~VulkanThreadCommandPools();
+
+		VulkanThreadCommandPools& operator=( const VulkanThreadCommandPools& ) = delete;
+		VulkanThreadCommandPools& operator=( VulkanThreadCommandPools&& ) = delete;
+
+		// only once the frame slot's previous submission has completed
+		void reset( const std::uint32_t& frameSlot );
+		// only from the thread owning threadSlot
+		vk::CommandBuffer acquireSecondary( const std::uint32_t& frameSlot, const std::uint32_t& threadSlot );
+		void destroy();
+
+		std::uint32_t getThreadSlotCount() const;
+	private:
+		struct SlotPool
+		{
+			vk::CommandPool					m_vkCommandPool;
+			std::vector<vk::CommandBuffer>	m_secondaryCommandBuffers;
+			std::uint32_t					m_usedCount{ 0 };
+		};
+
+		SlotPool& getPool( const std::uint32_t& frameSlot, const std::uint32_t& threadSlot );
+
+		vk::Device m_vkLogicalDevice;
+		std::uint32_t m_threadSlotCount;
+		// frame slot major
+		std::vector<SlotPool> m_pools;
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef VKRENDER_VULKAN_UNIFORM_RING_BUFFER_H
+#define VKRENDER_VULKAN_UNIFORM_RING_BUFFER_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <cstdint>
+
+namespace vkrender
+{
+	// Offsets into a single persistently mapped uniform buffer split into one region per frame in flight.
+	// Each frame bump allocates aligned slices from its own region, the region is reused once the frame
+	// that last wrote it has retired.
+	class VULKAN_EXPORTS VulkanUniformRingBuffer
+	{
+	public:
+		struct Slice
+		{
+			vk::DeviceSize	m_offset;
+			void*			m_pMappedData;
+		};
+
+		VulkanUniformRingBuffer(
+			void* pMappedData,
+			const vk::DeviceSize& frameRegionSize,
+			const std::uint32_t& frameCount,
+			const vk::DeviceSize& minOffsetAlignment
+		);
+		~VulkanUniformRingBuffer() = default;
+
+		void beginFrame( const std::uint32_t& frameIndex );
+		Slice allocate( const vk::DeviceSize& sizeInBytes );
+
+		vk::DeviceSize getFrameUsedBytes() const;
+
+		static vk::DeviceSize alignedSliceSize( const vk::DeviceSize& sizeInBytes, const vk::DeviceSize& minOffsetAlignment );
+	private:
+		std::uint8_t* m_pMappedData;
+		vk::DeviceSize m_frameRegionSize;
+		std::uint32_t m_frameCount;
+		vk::DeviceSize m_minOffsetAlignment;
+
+		vk::DeviceSize m_frameRegionBegin;
+		vk::DeviceSize m_frameHead;
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef VKRENDER_VULKAN_UPLOAD_MANAGER_H
+#define VKRENDER_VULKAN_UPLOAD_MANAGER_H
+
+#include <vulkan/vulkan.hpp>
+
+#include "exports.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace vkrender
+{
+	// eAuto writes buffers directly on unified memory and resizable bar devices, stages otherwise
+	enum class UploadPath
+	{
+		eAuto,
+		eStaged,
+		eDirect
+	};
+
+	// timeline value the upload semaphore reaches once the batch has been executed
+	struct UploadTicket
+	{
+		std::uint64_t m_timelineValue{ 0 };
+	};
+
+	class VULKAN_EXPORTS VulkanUploadManager
+	{
+	public:
+		VulkanUploadManager( const vk::Device& logicalDevice, const vk::Queue& transferQueue, const vk::CommandPool& transferCommandPool );
+		VulkanUploadManager( const VulkanUploadManager& ) = delete;
+		VulkanUploadManager( VulkanUploadManager&& ) = delete;
+		~VulkanUploadManager();
+
+		VulkanUploadManager& operator=( const VulkanUploadManager& ) = delete;
+		VulkanUploadManager& operator=( VulkanUploadManager&& ) = delete;
+
+		void enqueueBufferCopy( const vk::Buffer& srcBuffer, const vk::Buffer& dstBuffer, const vk::BufferCopy& copyRegion );
+		// transitions the whole image from undefined to transfer dst before copying into mip level 0
+		void enqueueBufferToImageCopy( const vk::Buffer& srcBuffer, const vk::Image& dstImage, const vk::BufferImageCopy& copyRegion, const std::uint32_t& mipmapLevels );
+		// runs once the batch currently being recorded has completed on the device
+		void releaseOnCompletion( std::function<void()> releaseCallback );
+
+		UploadTicket flush();
+		bool isComplete( const UploadTicket& ticket ) const;
+		void wait( const UploadTicket& ticket ) const;
+		void collect();
+		void destroy();
+
+		vk::Semaphore getTimelineSemaphore() const;
+		std::uint64_t getCompletedTimelineValue() const;
+		std::uint64_t getSubmittedBatchCount() const;
+	private:
+		struct UploadBatch
+		{
+			vk::CommandBuffer							m_vkCommandBuffer;
+			std::uint64_t								m_timelineValue;
+			std::vector<std::function<void()>>			m_releaseCallbacks;
+		};
+
+		vk::CommandBuffer& getRecordingCommandBuffer();
+
+		vk::Device m_vkLogicalDevice;
+		vk::Queue m_vkTransferQueue;
+		vk::CommandPool m_vkTransferCommandPool;
+		vk::Semaphore m_vkTimelineSemaphore;
+
+		UploadBatch m_recordingBatch;
+		bool m_bRecording;
+
+		std::deque<UploadBatch> m_inFlightBatches;
+		std::vector<vk::CommandBuffer> m_freeCommandBuffers;
+
+		std::uint64_t m_nextTimelineValue;
+		std::uint64_t m_submittedBatchCount;
+	};
+
+} // namespace vkrender
+
+#endif
@@ -0,0 +1,28 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// maps the 16 bit normalized position back onto the mesh bounds
+layout(push_constant) uniform VertexDequantization {
+    vec4 positionOffset;
+    vec4 positionScale;
+} dequantization;
+
+layout (location = 0) in vec4 inQuantizedPosition;
+layout (location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+
+void main()
+{
+    vec3 position = dequantization.positionOffset.xyz + inQuantizedPosition.xyz * dequantization.positionScale.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = inTexCoord;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// maps the 16 bit normalized position back onto the mesh bounds
+layout(push_constant) uniform VertexDequantization {
+    vec4 positionOffset;
+    vec4 positionScale;
+} dequantization;
+
+layout (location = 0) in vec4 inQuantizedPosition;
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) in vec4 inNormal;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+
+void main()
+{
+    vec3 position = dequantization.positionOffset.xyz + inQuantizedPosition.xyz * dequantization.positionScale.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    // the encoder writes unit normals, the guard only keeps a zero one in an older cache from turning into NaNs
+    vec3 normal = dot(inNormal.xyz, inNormal.xyz) > 0.0 ? normalize(inNormal.xyz) : vec3(0.0, 0.0, 1.0);
+    // the shared fragment shader has no normal input, the model space normal travels as the color
+    fragColor = normal * 0.5 + 0.5;
+    fragTexCoord = inTexCoord;
+}
\ No newline at end of file
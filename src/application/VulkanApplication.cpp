@@ -4,6 +4,7 @@
 #include "vkrenderer/VulkanSwapChainFactory.h"
 #include "vkrenderer/VulkanUBO.hpp"
 #include "graphics/Vertex.hpp"
+#include "graphics/ObjLoader.h"
 #include "utilities/VulkanLogger.h"
 
 #include <vulkan/vulkan.hpp>
@@ -19,11 +20,6 @@
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
 
-#ifndef TINYOBJLOADER_IMPLEMENTATION
-	#define TINYOBJLOADER_IMPLEMENTATION
-#endif
-#include <tiny_obj_loader.h>
-
 #ifndef STB_IMAGE_IMPLEMENTATION
 	#define STB_IMAGE_IMPLEMENTATION
 #endif
@@ -33,7 +29,21 @@ VulkanApplication::VulkanApplication( const std::string& applicationName )
     :m_applicationName{ applicationName }
 	,m_window{ 800, 600 }
 	,m_currentFrame{0}
+	,m_submittedFrameValue{0}
+	,m_completedFrameValue{0}
+	,m_frameUniformOffset{0}
+	,m_recordingGeneration{1}
+	,m_bConfigCommandBufferRecording{ false }
+	,m_bDeferConfigCommandFlush{ false }
+	,m_bBatchInitSubmissions{ true }
 	,m_bHasExclusiveTransferQueue{ false }
+	,m_uploadPath{ vkrender::UploadPath::eAuto }
+	,m_bDirectUpload{ false }
+	,m_totalStagedBytes{ 0 }
+	,m_bQuitRequested{ false }
+	,m_bDynamicRendering{ false }
+	,m_vkPresentMode{ vk::PresentModeKHR::eFifo }
+	,m_bPresentWait{ false }
 {
 	if (utils::VulkanRendererApiLogger::getSingletonPtr() == nullptr)
 	{
@@ -53,8 +63,12 @@ VulkanApplication::~VulkanApplication()
 
 void VulkanApplication::initialise()
 {
-	initWindow();
+	TRACE_SCOPE( "initialise" );
+	m_startupTrace.begin();
+	if( !m_rendererSettings.m_bHeadless )
+		initWindow();
 	initVulkan();
+	m_startupTrace.markInitialised();
 }
 
 void VulkanApplication::initialise( const std::filesystem::path& modelPath, const std::filesystem::path& texturePath )
@@ -65,6 +79,108 @@ void VulkanApplication::initialise( const std::filesystem::path& modelPath, cons
 	initialise();
 }
 
+const utils::StartupTrace& VulkanApplication::getStartupTrace() const
+{
+	return m_startupTrace;
+}
+
+const utils::FrameStats& VulkanApplication::getFrameStats() const
+{
+	return m_frameStats;
+}
+
+vkrender::VulkanAllocatorStats VulkanApplication::getMemoryAllocatorStats() const
+{
+	return m_upMemoryAllocator ? m_upMemoryAllocator->getStats() : vkrender::VulkanAllocatorStats{};
+}
+
+std::uint64_t VulkanApplication::getTotalStagedBytes() const
+{
+	return m_totalStagedBytes;
+}
+
+const vkrender::VulkanGpuProfiler& VulkanApplication::getGpuProfiler() const
+{
+	return *m_upGpuProfiler;
+}
+
+const VulkanApplication::CommandBufferReuseStats& VulkanApplication::getCommandBufferReuseStats() const
+{
+	return m_commandBufferReuseStats;
+}
+
+const VulkanApplication::MeshLoadStats& VulkanApplication::getMeshLoadStats() const
+{
+	return m_meshLoadStats;
+}
+
+void VulkanApplication::setRendererSettings( const vkrender::RendererSettings& rendererSettings )
+{
+	m_rendererSettings = rendererSettings;
+	m_rendererSettings.m_framesInFlight = std::clamp<std::uint32_t>( rendererSettings.m_framesInFlight, 1, vkrender::RendererSettings::MAX_FRAMES_IN_FLIGHT );
+}
+
+const vkrender::RendererSettings& VulkanApplication::getRendererSettings() const
+{
+	return m_rendererSettings;
+}
+
+vkrender::RenderingPath VulkanApplication::getRenderingPath() const
+{
+	return m_bDynamicRendering ? vkrender::RenderingPath::eDynamicRendering : vkrender::RenderingPath::eRenderPass;
+}
+
+vk::PresentModeKHR VulkanApplication::getPresentMode() const
+{
+	return m_vkPresentMode;
+}
+
+bool VulkanApplication::isPresentWaitEnabled() const
+{
+	return m_upFramePacer && m_upFramePacer->isPresentWaitEnabled();
+}
+
+void VulkanApplication::setUploadPath( const vkrender::UploadPath& uploadPath )
+{
+	m_uploadPath = uploadPath;
+}
+
+void VulkanApplication::swapModel( const std::filesystem::path& modelPath )
+{
+	if( !std::filesystem::exists(modelPath) )
+	{
+		std::string errorMsg = fmt::format("Model {} does not exist", modelPath.string());
+		LOG_ERROR(errorMsg);
+		throw std::runtime_error(errorMsg);
+	}
+
+	m_modelFilePath = modelPath;
+	m_inputVertexData.clear();
+	m_inputIndexData.clear();
+	m_encodedVertexData = graphics::EncodedVertices{};
+	loadModel();
+
+	retireOnFrameCompletion( [this, vertexBuffer = m_vkVertexBuffer, vertexBufferAllocation = m_vertexBufferAllocation, indexBuffer = m_vkIndexBuffer, indexBufferAllocation = m_indexBufferAllocation]() mutable {
+		m_vkLogicalDevice.destroyBuffer( vertexBuffer );
+		m_upMemoryAllocator->free( vertexBufferAllocation );
+		m_vkLogicalDevice.destroyBuffer( indexBuffer );
+		m_upMemoryAllocator->free( indexBufferAllocation );
+	} );
+
+	// the next frame waits on the upload ticket before reading the new buffers
+	createVertexBuffer();
+	createIndexBuffer();
+	submitPendingUploads();
+	invalidateRecordedCommandBuffers( "model swap" );
+
+	LOG_INFO( fmt::format("Swapped model to {}, {} objects awaiting deletion", modelPath.string(), m_upDeletionQueue->getPendingCount()) );
+}
+
+void VulkanApplication::retireOnFrameCompletion( std::function<void()> deleter )
+{
+	m_upDeletionQueue->retire( m_submittedFrameValue, std::move(deleter) );
+}
+
 void VulkanApplication::updateUniformBuffer( const std::uint32_t& currentFrame )
 {
 	auto timeNow = std::chrono::high_resolution_clock::now();
@@ -91,8 +207,14 @@ void VulkanApplication::updateUniformBuffer( const std::uint32_t& currentFrame )
 	);
 	ubo.projection[1][1] *= -1.0f;
 
-	std::memcpy( m_uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo) );
-	
+	writeUniformBufferObject( ubo );
+}
+
+void VulkanApplication::writeUniformBufferObject( const VulkanUniformBufferObject& ubo )
+{
+	vkrender::VulkanUniformRingBuffer::Slice uboSlice = m_upUniformRingBuffer->allocate( sizeof(ubo) );
+	std::memcpy( uboSlice.m_pMappedData, &ubo, sizeof(ubo) );
+	m_frameUniformOffset = static_cast<std::uint32_t>( uboSlice.m_offset );
 }
 
 void VulkanApplication::initWindow()
@@ -100,113 +222,279 @@ void VulkanApplication::initWindow()
 	m_window.init();
 }
 
+#define TRACE_INIT_STEP( initStep ) m_startupTrace.traceStep( #initStep, [this](){ initStep(); } )
+
 void VulkanApplication::initVulkan()
 {
-	createInstance();
-	setupDebugMessenger();
-	createSurface();
-	pickPhysicalDevice();
-	createLogicalDevice();
-	createSwapchain();
-	createSwapChainImageViews();
-	createRenderPass();
-	createDescriptorSetLayout();
-	createGraphicsPipeline();
-	createCommandPool();
-	createConfigCommandBuffer();
-	createColorResources();
-	createDepthResources();
-	createFrameBuffers();
-	createTextureImage();
-	createTextureImageView();
-	createTextureSampler();
+	TRACE_INIT_STEP( createInstance );
+	TRACE_INIT_STEP( setupDebugMessenger );
+	if( !m_rendererSettings.m_bHeadless )
+		TRACE_INIT_STEP( createSurface );
+	TRACE_INIT_STEP( pickPhysicalDevice );
+	TRACE_INIT_STEP( createLogicalDevice );
+	TRACE_INIT_STEP( createMemoryAllocator );
+	TRACE_INIT_STEP( resolveUploadPath );
+	TRACE_INIT_STEP( createDeletionQueue );
+	TRACE_INIT_STEP( createFramePacer );
+	if( m_rendererSettings.m_bHeadless )
+	{
+		TRACE_INIT_STEP( createOffscreenTargets );
+	}
+	else
+	{
+		TRACE_INIT_STEP( createSwapchain );
+		TRACE_INIT_STEP( createSwapChainImageViews );
+	}
+	if( !m_bDynamicRendering )
+		TRACE_INIT_STEP( createRenderPass );
+	TRACE_INIT_STEP( createDescriptorSetLayout );
+	TRACE_INIT_STEP( createPipelineCache );
+	TRACE_INIT_STEP( createGraphicsPipeline );
+	TRACE_INIT_STEP( createCommandPool );
+	TRACE_INIT_STEP( createUploadManager );
+	TRACE_INIT_STEP( createStagingArena );
+	TRACE_INIT_STEP( createConfigCommandBuffer );
+
+	// mipmap blits are recorded into the config command buffer and submitted once below
+	m_bDeferConfigCommandFlush = m_bBatchInitSubmissions;
+
+	TRACE_INIT_STEP( createColorResources );
+	TRACE_INIT_STEP( createDepthResources );
+	if( !m_bDynamicRendering )
+		TRACE_INIT_STEP( createFrameBuffers );
+	TRACE_INIT_STEP( createTextureImage );
+	TRACE_INIT_STEP( createTextureImageView );
+	TRACE_INIT_STEP( createTextureSampler );
 	if( std::filesystem::exists(m_modelFilePath) )
-		loadModel();
-	createVertexBuffer();
-	createIndexBuffer();
-	createUniformBuffers();
-	createDescriptorPool();
-	createDescriptorSets();
-	createGraphicsCommandBuffers();
-	createSyncObjects();
+		TRACE_INIT_STEP( loadModel );
+
+	auto meshUploadStart = utils::StartupTrace::Clock::now();
+	TRACE_INIT_STEP( createVertexBuffer );
+	TRACE_INIT_STEP( createIndexBuffer );
+	TRACE_INIT_STEP( submitPendingUploads );
+	// the config flush below waits on the same ticket, waiting here only moves the stall to time the upload path
+	m_upUploadManager->wait( m_pendingUploadTicket );
+	LOG_INFO( fmt::format(
+		"Mesh data of {} bytes resident in {:.3f} ms using the {} upload path",
+		graphics::GpuVertexLayout::STRIDE * getVertexCount() + sizeof(IndexData::value_type) * getIndexCount(),
+		std::chrono::duration<double, std::milli>( utils::StartupTrace::Clock::now() - meshUploadStart ).count(),
+		m_bDirectUpload ? "direct" : "staged"
+	) );
+
+	m_bDeferConfigCommandFlush = false;
+	TRACE_INIT_STEP( flushConfigCommandBuffer );
+
+	TRACE_INIT_STEP( createUniformBuffers );
+	TRACE_INIT_STEP( createDescriptorPool );
+	TRACE_INIT_STEP( createDescriptorSets );
+	TRACE_INIT_STEP( createGraphicsCommandBuffers );
+	TRACE_INIT_STEP( createRecordingThreads );
+	TRACE_INIT_STEP( createSyncObjects );
+	TRACE_INIT_STEP( createGpuProfiler );
 }
 
+#undef TRACE_INIT_STEP
+
 void VulkanApplication::mainLoop()
 {
 	m_simulationStart = std::chrono::high_resolution_clock::now();
 
-	while( !m_window.quit() )
+	while( !m_window.quit() && !m_bQuitRequested )
 	{
-		m_window.processEvents();
+		paceFrame();
+		if( !m_rendererSettings.m_bHeadless )
+		{
+			TRACE_SCOPE( "process_events" );
+			m_window.processEvents();
+		}
+		m_inputSampleTime = std::chrono::high_resolution_clock::now();
 		drawFrame();
 	}
 	m_vkLogicalDevice.waitIdle();
+	drainReadbacks();
+	for( auto frameSlot = 0u; frameSlot < m_rendererSettings.m_framesInFlight; frameSlot++ )
+		collectGpuProfile( frameSlot );
+}
+
+void VulkanApplication::runFrames( const std::uint32_t& frameCount )
+{
+	m_simulationStart = std::chrono::high_resolution_clock::now();
+	m_frameStats.reset();
+	m_frameStats.reserve( frameCount );
+	m_upGpuProfiler->resetSamples();
+	m_commandBufferReuseStats = CommandBufferReuseStats{};
+	m_lastPresentTime = {};
+
+	for( std::uint32_t frame = 0u; frame < frameCount && !m_window.quit() && !m_bQuitRequested; frame++ )
+	{
+		paceFrame();
+		if( !m_rendererSettings.m_bHeadless )
+			m_window.processEvents();
+		m_inputSampleTime = std::chrono::high_resolution_clock::now();
+		drawFrame();
+	}
+	m_vkLogicalDevice.waitIdle();
+	drainReadbacks();
+	for( auto frameSlot = 0u; frameSlot < m_rendererSettings.m_framesInFlight; frameSlot++ )
+		collectGpuProfile( frameSlot );
+}
+
+void VulkanApplication::paceFrame()
+{
+	TRACE_SCOPE( "pace" );
+
+	double inputToDisplayMs;
+	if( m_upFramePacer->waitForQueuedPresents( inputToDisplayMs ) )
+		m_frameStats.recordInputToDisplay( inputToDisplayMs );
+	m_upFramePacer->waitForFrameRateLimit();
 }
 
 void VulkanApplication::drawFrame()
 {
-	auto opFenceWait = m_vkLogicalDevice.waitForFences( 1, &m_vkInFlightFences[m_currentFrame], VK_TRUE, std::numeric_limits<std::uint64_t>::max() ); 
+	TRACE_SCOPE( "drawFrame" );
+	{
+		TRACE_SCOPE( "frame_wait" );
+		// every submission advances the slot, so this slot last went out frames in flight submissions ago
+		if( m_submittedFrameValue >= m_rendererSettings.m_framesInFlight )
+			waitForFrame( m_submittedFrameValue + 1 - m_rendererSettings.m_framesInFlight );
+	}
+	m_upDeletionQueue->collect( m_completedFrameValue );
+	m_upUploadManager->collect();
+	collectGpuProfile( m_currentFrame );
 
 	std::uint32_t imageIndex;
-	vk::ResultValue<std::uint32_t> opImageAcquistion = this->swapchainNextImageWrapper(
-		m_vkLogicalDevice,
-		m_vkSwapchain, 
-		std::numeric_limits<std::uint64_t>::max(),
-		m_vkImageAvailableSemaphores[m_currentFrame],
-		nullptr
-	);
-
-	if( opImageAcquistion.result == vk::Result::eErrorOutOfDateKHR )
+	if( m_rendererSettings.m_bHeadless )
 	{
-		recreateSwapChain();
-		return;
+		// the frame wait above covers the copy of the frame this slot rendered last time round
+		deliverReadback( m_currentFrame );
+		imageIndex = m_currentFrame;
 	}
-	else if( opImageAcquistion.result != vk::Result::eSuccess && opImageAcquistion.result != vk::Result::eSuboptimalKHR )
+	else if( !m_rendererSettings.m_bLateAcquire && !acquireSwapchainImage( imageIndex ) )
 	{
-		std::string errorMsg = "FAILED TO ACQUIRE SWAPCHAIN IMAGE TO START RENDERING";
-		LOG_ERROR(errorMsg);
-		throw std::runtime_error( errorMsg );
+		return;
 	}
 
 	m_timeSinceLastUpdateFrame = std::chrono::high_resolution_clock::now();
-	updateUniformBuffer(m_currentFrame);
-	
-	// only reset the fence if we are submitting for work
-	auto opFenceReset = m_vkLogicalDevice.resetFences( 1, &m_vkInFlightFences[m_currentFrame] );
+	{
+		TRACE_SCOPE( "update_uniforms" );
+		m_upUniformRingBuffer->beginFrame( m_currentFrame );
+		updateUniformBuffer(m_currentFrame);
+	}
 
-	imageIndex = opImageAcquistion.value;
+	// recording needs the image index, everything up to it runs without holding a swapchain image.
+	// a skipped frame rewrites the same uniform region next time round
+	if( !m_rendererSettings.m_bHeadless && m_rendererSettings.m_bLateAcquire && !acquireSwapchainImage( imageIndex ) )
+		return;
 
-	m_vkGraphicsCommandBuffers[m_currentFrame].reset( {} );
-	recordCommandBuffer( m_vkGraphicsCommandBuffers[m_currentFrame], imageIndex );
+
+	vk::CommandBuffer vkFrameCommandBuffer = m_vkGraphicsCommandBuffers[m_currentFrame];
+	{
+		TRACE_SCOPE( "record" );
+		auto recordStart = std::chrono::high_resolution_clock::now();
+		if( m_rendererSettings.m_bReuseCommandBuffers )
+		{
+			vkFrameCommandBuffer = acquirePrerecordedCommandBuffer( imageIndex );
+		}
+		else
+		{
+			vkFrameCommandBuffer.reset( {} );
+			recordCommandBuffer( vkFrameCommandBuffer, imageIndex );
+		}
+		m_frameStats.recordCommandRecordingTime( std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - recordStart ).count() );
+	}
 
 	vk::SubmitInfo vkCmdSubmitInfo{};
-	vk::Semaphore waitSemaphores[] = { m_vkImageAvailableSemaphores[m_currentFrame] };
-	vk::PipelineStageFlags waitStages[] = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
-	vkCmdSubmitInfo.waitSemaphoreCount = 1;
-	vkCmdSubmitInfo.pWaitSemaphores = waitSemaphores;
-	vkCmdSubmitInfo.pWaitDstStageMask = waitStages;
+	vk::Semaphore waitSemaphores[] = { m_vkImageAvailableSemaphores[m_currentFrame], m_upUploadManager->getTimelineSemaphore() };
+	vk::PipelineStageFlags waitStages[] = { 
+		vk::PipelineStageFlagBits::eColorAttachmentOutput, 
+		vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eFragmentShader 
+	};
+	// binary semaphore values are ignored, the upload wait is only added while uploads are still in flight
+	std::uint64_t waitValues[] = { 0, m_pendingUploadTicket.m_timelineValue };
+	bool bWaitForUploads = !m_upUploadManager->isComplete( m_pendingUploadTicket );
+	// headless frames have no acquire to wait on and nothing presents them, skip the binary semaphores
+	std::uint32_t firstWait = m_rendererSettings.m_bHeadless ? 1 : 0;
+	std::uint32_t waitCount = ( bWaitForUploads ? 2 : 1 ) - firstWait;
+	vk::Semaphore signalSemaphores[] = { m_vkFrameTimelineSemaphore, m_vkRenderFinishedSemaphores[m_currentFrame] };
+	std::uint64_t signalValues[] = { m_submittedFrameValue + 1, 0 };
+	std::uint32_t signalCount = m_rendererSettings.m_bHeadless ? 1 : 2;
+	vk::TimelineSemaphoreSubmitInfo vkTimelineSubmitInfo{};
+	vkTimelineSubmitInfo.waitSemaphoreValueCount = waitCount;
+	vkTimelineSubmitInfo.pWaitSemaphoreValues = waitValues + firstWait;
+	vkTimelineSubmitInfo.signalSemaphoreValueCount = signalCount;
+	vkTimelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+	vkCmdSubmitInfo.pNext = &vkTimelineSubmitInfo;
+	vkCmdSubmitInfo.waitSemaphoreCount = waitCount;
+	vkCmdSubmitInfo.pWaitSemaphores = waitSemaphores + firstWait;
+	vkCmdSubmitInfo.pWaitDstStageMask = waitStages + firstWait;
 	vkCmdSubmitInfo.commandBufferCount = 1;
-	vkCmdSubmitInfo.pCommandBuffers = &m_vkGraphicsCommandBuffers[m_currentFrame];
-	vk::Semaphore signalSemaphores[] = { m_vkRenderFinishedSemaphores[m_currentFrame] };
-	vkCmdSubmitInfo.signalSemaphoreCount = 1;
+	vkCmdSubmitInfo.pCommandBuffers = &vkFrameCommandBuffer;
+	vkCmdSubmitInfo.signalSemaphoreCount = signalCount;
 	vkCmdSubmitInfo.pSignalSemaphores = signalSemaphores;
 
 	vk::ArrayProxy<const vk::SubmitInfo> submitInfos{ vkCmdSubmitInfo };
-	m_vkGraphicsQueue.submit( submitInfos, m_vkInFlightFences[m_currentFrame] );
+	{
+		TRACE_SCOPE( "submit" );
+		m_vkGraphicsQueue.submit( submitInfos );
+	}
+	++m_submittedFrameValue;
+	m_startupTrace.countSubmission( false );
+
+	if( m_rendererSettings.m_bHeadless )
+	{
+		m_pendingReadbackFrameValues[m_currentFrame] = m_submittedFrameValue;
+		m_startupTrace.markFirstFrame();
+
+		// without a present the frame time is measured between submissions
+		auto submitTime = std::chrono::high_resolution_clock::now();
+		if( m_lastPresentTime.time_since_epoch().count() != 0 )
+		{
+			m_frameStats.recordFrame(
+				std::chrono::duration<double, std::milli>( submitTime - m_lastPresentTime ).count(),
+				std::chrono::duration<double, std::milli>( submitTime - m_inputSampleTime ).count()
+			);
+		}
+		m_lastPresentTime = submitTime;
+
+		m_currentFrame = ( m_currentFrame + 1 ) % m_rendererSettings.m_framesInFlight;
+		return;
+	}
 
 	vk::PresentInfoKHR vkPresentInfo{};
 	vkPresentInfo.waitSemaphoreCount = 1;
-	vkPresentInfo.pWaitSemaphores = signalSemaphores;
+	vkPresentInfo.pWaitSemaphores = &m_vkRenderFinishedSemaphores[m_currentFrame];
 	vk::SwapchainKHR swapchains[] = { m_vkSwapchain };
 	vkPresentInfo.swapchainCount = 1;
 	vkPresentInfo.pSwapchains = swapchains;
 	vkPresentInfo.pImageIndices = &imageIndex;
 	vkPresentInfo.pResults = nullptr;
 
-	vk::Result opPresentResult = queuePresentWrapper( 
-		m_vkPresentationQueue,
-		vkPresentInfo
-	);
+	std::uint64_t presentId = m_upFramePacer->beginPresent( m_inputSampleTime );
+	vk::PresentIdKHR vkPresentId{};
+	vkPresentId.swapchainCount = 1;
+	vkPresentId.pPresentIds = &presentId;
+	vkPresentInfo.pNext = presentId != 0 ? &vkPresentId : nullptr;
+
+	vk::Result opPresentResult;
+	{
+		TRACE_SCOPE( "present" );
+		opPresentResult = queuePresentWrapper( 
+			m_vkPresentationQueue,
+			vkPresentInfo
+		);
+	}
+	m_startupTrace.markFirstFrame();
+
+	// input is sampled before the frame wait, so the latency includes the time spent blocked on earlier frames
+	auto presentTime = std::chrono::high_resolution_clock::now();
+	if( m_lastPresentTime.time_since_epoch().count() != 0 )
+	{
+		m_frameStats.recordFrame(
+			std::chrono::duration<double, std::milli>( presentTime - m_lastPresentTime ).count(),
+			std::chrono::duration<double, std::milli>( presentTime - m_inputSampleTime ).count()
+		);
+	}
+	m_lastPresentTime = presentTime;
 	
 	if( opPresentResult == vk::Result::eErrorOutOfDateKHR || opPresentResult == vk::Result::eSuboptimalKHR || m_window.isFrameBufferResized() )
 	{
@@ -219,19 +507,43 @@ void VulkanApplication::drawFrame()
 		throw std::runtime_error( errorMsg );
 	}
 
-	m_currentFrame = ( m_currentFrame + 1 ) % MAX_FRAMES_IN_FLIGHT;
+	m_currentFrame = ( m_currentFrame + 1 ) % m_rendererSettings.m_framesInFlight;
 }
 
 void VulkanApplication::shutdown()
 {
 	using namespace vkrender;
 
-	for( auto i = 0u; i < MAX_FRAMES_IN_FLIGHT; i++ )
+	// every frame has retired by now, mainLoop idles the device before returning
+	m_upDeletionQueue->flush();
+
+	if( m_rendererSettings.m_bReuseCommandBuffers )
+	{
+		LOG_INFO( fmt::format(
+			"Command buffers recorded {} times and reused {} times, {} invalidations",
+			m_commandBufferReuseStats.m_recordCount, m_commandBufferReuseStats.m_reuseCount, m_commandBufferReuseStats.m_invalidationCount
+		) );
+	}
+
+	for( auto i = 0u; i < m_rendererSettings.m_framesInFlight; i++ )
 	{
-		m_vkLogicalDevice.destroyFence( m_vkInFlightFences[i] );
 		m_vkLogicalDevice.destroySemaphore( m_vkRenderFinishedSemaphores[i] );
 		m_vkLogicalDevice.destroySemaphore( m_vkImageAvailableSemaphores[i] );
 	}
+	m_vkLogicalDevice.destroySemaphore( m_vkFrameTimelineSemaphore );
+
+	m_upGpuProfiler.reset();
+	m_upFramePacer.reset();
+
+	m_upThreadCommandPools.reset();
+	m_upRecordingThreadPool.reset();
+
+	m_upUploadManager.reset();
+	m_vkLogicalDevice.destroyFence( m_vkConfigFence );
+
+	m_upStagingArena.reset();
+	m_vkLogicalDevice.destroyBuffer( m_vkStagingBuffer );
+	m_upMemoryAllocator->free( m_stagingBufferAllocation );
 
 	if( m_bHasExclusiveTransferQueue )
 		m_vkLogicalDevice.destroyCommandPool( m_vkTransferCommandPool );
@@ -242,19 +554,17 @@ void VulkanApplication::shutdown()
 	m_vkLogicalDevice.destroySampler( m_vkTextureSampler );
 	m_vkLogicalDevice.destroyImageView( m_vkTextureImageView );
 	m_vkLogicalDevice.destroyImage( m_vkTextureImage );
-	m_vkLogicalDevice.freeMemory( m_vkTextureImageMemory );
+	m_upMemoryAllocator->free( m_textureImageAllocation );
 
 	m_vkLogicalDevice.destroyBuffer( m_vkIndexBuffer );
-	m_vkLogicalDevice.freeMemory( m_vkIndexBufferMemory );
+	m_upMemoryAllocator->free( m_indexBufferAllocation );
 
 	m_vkLogicalDevice.destroyBuffer( m_vkVertexBuffer );
-	m_vkLogicalDevice.freeMemory( m_vkVertexBufferMemory );
+	m_upMemoryAllocator->free( m_vertexBufferAllocation );
 
-	for( std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-	{
-		m_vkLogicalDevice.destroyBuffer( m_vkUniformBuffers[i] );
-		m_vkLogicalDevice.freeMemory( m_vkUniformBuffersMemory[i] );
-	}
+	m_upUniformRingBuffer.reset();
+	m_vkLogicalDevice.destroyBuffer( m_vkUniformBuffer );
+	m_upMemoryAllocator->free( m_uniformBufferAllocation );
 
 	m_vkLogicalDevice.destroyDescriptorPool( m_vkDescriptorPool );
 	m_vkLogicalDevice.destroyDescriptorSetLayout( m_vkDescriptorSetLayout );
@@ -263,6 +573,15 @@ void VulkanApplication::shutdown()
 	m_vkLogicalDevice.destroyPipelineLayout( m_vkPipelineLayout );
 	m_vkLogicalDevice.destroyRenderPass( m_vkRenderPass );
 
+	m_upPipelineCache->save();
+	m_upPipelineCache.reset();
+	m_upMeshCache.reset();
+
+	m_upDeletionQueue.reset();
+
+	m_upMemoryAllocator->logStats();
+	m_upMemoryAllocator.reset();
+
 	m_vkLogicalDevice.destroy();
 	m_vkInstance.destroySurfaceKHR( m_vkSurface );
 
@@ -310,75 +629,193 @@ void VulkanApplication::createSurface()
 
 void VulkanApplication::loadModel()
 {
-	tinyobj::attrib_t attributes;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string errorMsg;
+	auto loadStart = std::chrono::high_resolution_clock::now();
+	m_meshLoadStats = MeshLoadStats{};
+	m_upMeshCache.reset();
+
+	graphics::MeshCacheKey cacheKey;
+	cacheKey.m_weldEpsilon = m_rendererSettings.m_meshWeldEpsilon;
+	if( m_rendererSettings.m_bOptimizeMesh )
+		cacheKey.m_optimizeMode = m_rendererSettings.m_bOptimizeMeshOverdraw ? graphics::MeshOptimizeMode::eVertexCacheAndOverdraw : graphics::MeshOptimizeMode::eVertexCache;
+
+	std::filesystem::path cacheFilePath;
+	bool bMeshCache = !m_rendererSettings.m_meshCacheDirectory.empty() && graphics::MeshCache::hashSourceFile( m_modelFilePath, cacheKey.m_sourceHash );
+	m_meshLoadStats.m_hashMs = std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - loadStart ).count();
 
-	if( !tinyobj::LoadObj(
-			&attributes,
-			&shapes,
-			&materials,
-			&errorMsg,
-			m_modelFilePath.string().c_str()
-		)
-	)
+	if( bMeshCache )
 	{
-		LOG_ERROR(errorMsg);
-		throw std::runtime_error(errorMsg);
-	}
+		cacheFilePath = graphics::MeshCache::getCacheFilePath( m_rendererSettings.m_meshCacheDirectory, m_modelFilePath );
+		m_upMeshCache = std::make_unique<graphics::MeshCache>();
 
-	std::unordered_map<vertex, std::uint32_t> unique_vertices;
+		switch( m_upMeshCache->open( cacheFilePath, cacheKey ) )
+		{
+			case graphics::MeshCache::LoadResult::eLoaded:
+				m_meshLoadStats.m_bFromCache = true;
+				break;
+			case graphics::MeshCache::LoadResult::eStale:
+				LOG_INFO( fmt::format("Mesh cache {} was built from other contents of {} or other load settings, rebuilding", cacheFilePath.string(), m_modelFilePath.string()) );
+				break;
+			case graphics::MeshCache::LoadResult::eRejected:
+				LOG_INFO( fmt::format("Mesh cache {} has another format version or vertex layout, or is corrupt, rebuilding", cacheFilePath.string()) );
+				break;
+			case graphics::MeshCache::LoadResult::eMissing:
+				break;
+		}
+	}
 
-	for( const auto& shape : shapes )
+	if( !m_meshLoadStats.m_bFromCache )
 	{
-		for( const auto& index : shape.mesh.indices )
+		m_upMeshCache.reset();
+
+		std::uint32_t threadCount = m_rendererSettings.m_meshLoadThreadCount;
+		if( threadCount == 0 )
+			threadCount = std::max( 1u, std::thread::hardware_concurrency() );
+
+		// only needed while parsing, the loading thread is the last slot
+		utils::ThreadPool meshLoadThreadPool{ threadCount - 1 };
+		graphics::MeshData meshData;
+		graphics::loadObjMeshParallel( m_modelFilePath, meshData, meshLoadThreadPool, cacheKey.m_weldEpsilon );
+
+		if( cacheKey.m_optimizeMode != graphics::MeshOptimizeMode::eNone )
 		{
-			vertex vertexData{};
-			
-			vertexData.pos = { 
-				attributes.vertices[ 3 * index.vertex_index + 0 ],
-				attributes.vertices[ 3 * index.vertex_index + 1 ],
-				attributes.vertices[ 3 * index.vertex_index + 2 ]
-			};
-			
-			vertexData.texCoord = { 
-				attributes.texcoords[ 2 * index.texcoord_index + 0 ],
-				1.0f - attributes.texcoords[ 2 * index.texcoord_index + 1 ]
-			};
-
-			vertexData.color = { 1.0, 1.0, 1.0 };
-			
-			if( unique_vertices.count(vertexData) == 0 )
-			{
-				unique_vertices[vertexData] = static_cast<std::uint32_t>( m_inputVertexData.size() );
-				m_inputVertexData.push_back( vertexData );
-			}
-			m_inputIndexData.push_back( unique_vertices[vertexData] );
+			m_meshLoadStats.m_optimizeReport = graphics::optimizeMesh( meshData, cacheKey.m_optimizeMode );
+			LOG_INFO( fmt::format(
+				"Optimized mesh in {:.3f} ms, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+				m_meshLoadStats.m_optimizeReport.m_optimizeMs,
+				m_meshLoadStats.m_optimizeReport.m_before.m_acmr, m_meshLoadStats.m_optimizeReport.m_after.m_acmr,
+				m_meshLoadStats.m_optimizeReport.m_before.m_atvr, m_meshLoadStats.m_optimizeReport.m_after.m_atvr
+			) );
 		}
+
+		graphics::encodeVertices<graphics::GpuVertexLayout>( meshData.m_vertices, meshData.m_indices, m_encodedVertexData );
+		if( bMeshCache && graphics::MeshCache::write( cacheFilePath, meshData, m_encodedVertexData, cacheKey ) )
+			LOG_INFO( fmt::format("Mesh cache written to {}", cacheFilePath.string()) );
+
+		// only the encoded vertices are uploaded, the loaded ones are not kept
+		m_inputVertexData.clear();
+		m_inputIndexData = std::move( meshData.m_indices );
 	}
+
+	m_meshLoadStats.m_loadMs = std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - loadStart ).count();
+	m_startupTrace.recordStep( m_meshLoadStats.m_bFromCache ? "meshLoad (cache warm)" : "meshLoad (cache cold)", m_meshLoadStats.m_loadMs );
+	LOG_INFO( fmt::format(
+		"Loaded {} vertices and {} indices from {} in {:.3f} ms, source hash {:.3f} ms, {} vertex layout of {} bytes",
+		getVertexCount(), getIndexCount(), m_meshLoadStats.m_bFromCache ? "the mesh cache" : "the OBJ", m_meshLoadStats.m_loadMs, m_meshLoadStats.m_hashMs,
+		graphics::GPU_VERTEX_LAYOUT_NAME, graphics::GpuVertexLayout::STRIDE
+	) );
+}
+
+void VulkanApplication::encodeInputVertexData()
+{
+	// loadModel encodes what it loads itself
+	if( m_upMeshCache || !m_encodedVertexData.m_data.empty() )
+		return;
+
+	graphics::encodeVertices<graphics::GpuVertexLayout>( m_inputVertexData, m_inputIndexData, m_encodedVertexData );
+}
+
+const std::uint8_t* VulkanApplication::getVertexData() const
+{
+	return m_upMeshCache ? m_upMeshCache->getVertexData() : m_encodedVertexData.m_data.data();
+}
+
+std::size_t VulkanApplication::getVertexCount() const
+{
+	return m_upMeshCache ? m_upMeshCache->getVertexCount() : m_encodedVertexData.m_vertexCount;
+}
+
+const graphics::VertexDequantization& VulkanApplication::getVertexDequantization() const
+{
+	return m_upMeshCache ? m_upMeshCache->getVertexDequantization() : m_encodedVertexData.m_dequantization;
+}
+
+const std::uint32_t* VulkanApplication::getIndexData() const
+{
+	return m_upMeshCache ? m_upMeshCache->getIndices() : m_inputIndexData.data();
+}
+
+std::size_t VulkanApplication::getIndexCount() const
+{
+	return m_upMeshCache ? m_upMeshCache->getIndexCount() : m_inputIndexData.size();
 }
 
 void VulkanApplication::createSyncObjects()
 {
-	m_vkImageAvailableSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-	m_vkRenderFinishedSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-	m_vkInFlightFences.resize( MAX_FRAMES_IN_FLIGHT );
+	m_vkImageAvailableSemaphores.resize( m_rendererSettings.m_framesInFlight );
+	m_vkRenderFinishedSemaphores.resize( m_rendererSettings.m_framesInFlight );
 
+	// acquire and present only take binary semaphores, everything else waits on the frame clock
 	vk::SemaphoreCreateInfo vkSemaphoreInfo{};
 
-	vk::FenceCreateInfo vkFenceInfo{};
-	vkFenceInfo.flags = vk::FenceCreateFlagBits::eSignaled;
-
-	for( auto i = 0u; i < MAX_FRAMES_IN_FLIGHT; i++ )
+	for( auto i = 0u; i < m_rendererSettings.m_framesInFlight; i++ )
 	{
 		m_vkImageAvailableSemaphores[i] = m_vkLogicalDevice.createSemaphore( vkSemaphoreInfo );
 		m_vkRenderFinishedSemaphores[i] = m_vkLogicalDevice.createSemaphore( vkSemaphoreInfo );
+	}
+
+	vk::SemaphoreTypeCreateInfo vkSemaphoreTypeInfo{};
+	vkSemaphoreTypeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+	vkSemaphoreTypeInfo.initialValue = m_submittedFrameValue;
+
+	vk::SemaphoreCreateInfo vkTimelineSemaphoreInfo{};
+	vkTimelineSemaphoreInfo.pNext = &vkSemaphoreTypeInfo;
 
-		m_vkInFlightFences[i] = m_vkLogicalDevice.createFence( vkFenceInfo );
+	m_vkFrameTimelineSemaphore = m_vkLogicalDevice.createSemaphore( vkTimelineSemaphoreInfo );
+
+	LOG_INFO( fmt::format("Sync Objects For Rendering and Presentation created for {} frames in flight", m_rendererSettings.m_framesInFlight) );
+}
+
+void VulkanApplication::waitForFrame( const std::uint64_t& frameValue )
+{
+	if( frameValue > m_completedFrameValue )
+	{
+		vk::SemaphoreWaitInfo vkWaitInfo{};
+		vkWaitInfo.semaphoreCount = 1;
+		vkWaitInfo.pSemaphores = &m_vkFrameTimelineSemaphore;
+		vkWaitInfo.pValues = &frameValue;
+
+		vk::Result opResult = m_vkLogicalDevice.waitSemaphores( vkWaitInfo, std::numeric_limits<std::uint64_t>::max() );
+		if( opResult != vk::Result::eSuccess )
+		{
+			std::string errorMsg = "FAILED TO WAIT FOR FRAME COMPLETION";
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
 	}
 
-	LOG_INFO("Sync Objects For Rendering and Presentation created");
+	// later frames may have finished as well, collecting against them frees their resources sooner
+	m_completedFrameValue = std::max( m_completedFrameValue, m_vkLogicalDevice.getSemaphoreCounterValue( m_vkFrameTimelineSemaphore ) );
+}
+
+void VulkanApplication::createGpuProfiler()
+{
+	std::uint32_t graphicsFamily = m_deviceCapabilities.getQueueFamilyIndices().m_graphicsFamily.value();
+	std::uint32_t timestampValidBits = m_deviceCapabilities.getQueueFamilyProperties()[graphicsFamily].timestampValidBits;
+	bool bPipelineStatistics = m_rendererSettings.m_bGpuPipelineStatistics && m_deviceCapabilities.getFeatures().pipelineStatisticsQuery;
+
+	m_upGpuProfiler = std::make_unique<vkrender::VulkanGpuProfiler>(
+		m_vkLogicalDevice,
+		m_rendererSettings.m_framesInFlight,
+		m_deviceCapabilities.getLimits().timestampPeriod,
+		timestampValidBits,
+		bPipelineStatistics
+	);
+
+	if( timestampValidBits == 0 )
+		LOG_INFO("Graphics queue does not support timestamps, gpu scopes are not recorded");
+	LOG_INFO( fmt::format("GPU Profiler created, pipeline statistics {}", bPipelineStatistics ? "enabled" : "disabled") );
+}
+
+void VulkanApplication::collectGpuProfile( const std::uint32_t& frameSlot )
+{
+	if( !m_upGpuProfiler->collect( frameSlot ) )
+		return;
+
+	for( const auto& scope : m_upGpuProfiler->getLatestResult().m_scopes )
+	{
+		if( scope.m_name == "frame" )
+			m_frameStats.recordGpuTime( scope.m_durationMs );
+	}
 }
 
 void VulkanApplication::recordCommandBuffer( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex )
@@ -389,21 +826,181 @@ void VulkanApplication::recordCommandBuffer( vk::CommandBuffer& vkCommandBuffer,
 
 	vkCommandBuffer.begin( vkCmdBufBeginInfo );
 
-	vk::RenderPassBeginInfo vkRenderPassBeginInfo{};
-	vkRenderPassBeginInfo.renderPass = m_vkRenderPass;
-	vkRenderPassBeginInfo.framebuffer = m_swapchainFrameBuffers[ imageIndex ];
-	vkRenderPassBeginInfo.renderArea.offset = vk::Offset2D{ 0, 0 };
-	vkRenderPassBeginInfo.renderArea.extent = m_vkSwapchainExtent;
-	std::array<vk::ClearValue, 2> clearValues{};
+	// recorded ahead of submission, so the frame value is the one this command buffer will be submitted with
+	m_upGpuProfiler->beginFrame( vkCommandBuffer, m_currentFrame, m_submittedFrameValue + 1 );
+	std::uint32_t frameScope = m_upGpuProfiler->beginScope( vkCommandBuffer, "frame" );
+
+	std::uint32_t renderPassScope = m_upGpuProfiler->beginScope( vkCommandBuffer, "render_pass" );
+	if( m_upRecordingThreadPool )
+	{
+		// a subpass recorded from secondaries takes nothing but executeCommands, the draw scope and statistics are left out
+		recordSecondaryCommandBuffers( imageIndex );
+		beginSceneRendering( vkCommandBuffer, imageIndex, true );
+		vkCommandBuffer.executeCommands( m_vkSceneCommandBuffers );
+	}
+	else
+	{
+		beginSceneRendering( vkCommandBuffer, imageIndex, false );
+		std::uint32_t drawScope = m_upGpuProfiler->beginScope( vkCommandBuffer, "draw" );
+		m_upGpuProfiler->beginPipelineStatistics( vkCommandBuffer );
+		recordSceneDraws( vkCommandBuffer, 0, getSceneDrawCount() );
+		m_upGpuProfiler->endPipelineStatistics( vkCommandBuffer );
+		m_upGpuProfiler->endScope( vkCommandBuffer, drawScope );
+	}
+
+	// the msaa resolve and attachment stores run at the end of the subpass, after the draw has drained
+	std::uint32_t resolveScope = vkrender::VulkanGpuProfiler::INVALID_SCOPE;
+	if( !m_upRecordingThreadPool )
+		resolveScope = m_upGpuProfiler->beginScope( vkCommandBuffer, "resolve", vk::PipelineStageFlagBits::eBottomOfPipe );
+	endSceneRendering( vkCommandBuffer, imageIndex );
+	m_upGpuProfiler->endScope( vkCommandBuffer, resolveScope );
+	m_upGpuProfiler->endScope( vkCommandBuffer, renderPassScope );
+
+	if( m_rendererSettings.m_bHeadless )
+	{
+		std::uint32_t readbackScope = m_upGpuProfiler->beginScope( vkCommandBuffer, "readback" );
+		recordReadbackCopy( vkCommandBuffer, imageIndex );
+		m_upGpuProfiler->endScope( vkCommandBuffer, readbackScope );
+	}
+
+	m_upGpuProfiler->endScope( vkCommandBuffer, frameScope );
+	vkCommandBuffer.end();
+}
+
+void VulkanApplication::beginSceneRendering( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex, const bool& bSecondaryContents )
+{
 	vk::ClearColorValue clearColorValue;
 	clearColorValue.setFloat32( {0.0f, 0.0f, 0.0f, 1.0f} );
-	clearValues[0].setColor( clearColorValue );
 	vk::ClearDepthStencilValue clearDepthStencilValue{ 1.0f, 0 };
-	clearValues[1].setDepthStencil(clearDepthStencilValue);
-	vkRenderPassBeginInfo.clearValueCount = static_cast<std::uint32_t>( clearValues.size() );
-	vkRenderPassBeginInfo.pClearValues = clearValues.data();
 
-	vkCommandBuffer.beginRenderPass( vkRenderPassBeginInfo, vk::SubpassContents::eInline );
+	if( !m_bDynamicRendering )
+	{
+		vk::RenderPassBeginInfo vkRenderPassBeginInfo{};
+		vkRenderPassBeginInfo.renderPass = m_vkRenderPass;
+		vkRenderPassBeginInfo.framebuffer = m_swapchainFrameBuffers[ imageIndex ];
+		vkRenderPassBeginInfo.renderArea.offset = vk::Offset2D{ 0, 0 };
+		vkRenderPassBeginInfo.renderArea.extent = m_vkSwapchainExtent;
+		std::array<vk::ClearValue, 2> clearValues{};
+		clearValues[0].setColor( clearColorValue );
+		clearValues[1].setDepthStencil(clearDepthStencilValue);
+		vkRenderPassBeginInfo.clearValueCount = static_cast<std::uint32_t>( clearValues.size() );
+		vkRenderPassBeginInfo.pClearValues = clearValues.data();
+
+		vkCommandBuffer.beginRenderPass( vkRenderPassBeginInfo, bSecondaryContents ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline );
+		return;
+	}
+
+	// the render pass' initial layouts and external dependency, as barriers. The multisampled targets are shared
+	// by every frame in flight, the previous frame's attachment writes must finish before they are cleared again
+	vk::Format depthFormat = findDepthFormat();
+	std::array<vk::ImageMemoryBarrier, 3> imgBarriers{};
+	for( auto& imgBarrier : imgBarriers )
+	{
+		imgBarrier.oldLayout = vk::ImageLayout::eUndefined;
+		imgBarrier.newLayout = vk::ImageLayout::eColorAttachmentOptimal;
+		imgBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+		imgBarrier.subresourceRange.baseMipLevel = 0;
+		imgBarrier.subresourceRange.levelCount = 1;
+		imgBarrier.subresourceRange.baseArrayLayer = 0;
+		imgBarrier.subresourceRange.layerCount = 1;
+		imgBarrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+		imgBarrier.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+	}
+	// ordered after the acquire semaphore wait, which waits at color attachment output
+	imgBarriers[0].image = m_swapchainImages[imageIndex];
+	imgBarriers[0].srcAccessMask = vk::AccessFlagBits::eNone;
+	imgBarriers[1].image = m_vkColorImage;
+	imgBarriers[2].image = m_vkDepthImage;
+	imgBarriers[2].newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+	imgBarriers[2].subresourceRange.aspectMask = hasStencilComponent( depthFormat ) ? 
+		vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil : 
+		vk::ImageAspectFlagBits::eDepth;
+	imgBarriers[2].srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+	imgBarriers[2].dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+
+	bool bMultisampled = m_msaaSampleCount != vk::SampleCountFlagBits::e1;
+	vk::PipelineStageFlags attachmentStages = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+	vkCommandBuffer.pipelineBarrier(
+		attachmentStages, attachmentStages, {},
+		0, nullptr,
+		0, nullptr,
+		static_cast<std::uint32_t>( imgBarriers.size() ), imgBarriers.data()
+	);
+
+	// single sampled frames render straight into the swapchain image, multisampled ones resolve into it
+	vk::RenderingAttachmentInfo vkColorAttachmentInfo{};
+	vkColorAttachmentInfo.imageView = bMultisampled ? m_vkColorImageView : m_swapchainImageViews[imageIndex];
+	vkColorAttachmentInfo.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+	vkColorAttachmentInfo.resolveMode = bMultisampled ? vk::ResolveModeFlagBits::eAverage : vk::ResolveModeFlagBits::eNone;
+	vkColorAttachmentInfo.resolveImageView = bMultisampled ? m_swapchainImageViews[imageIndex] : vk::ImageView{};
+	vkColorAttachmentInfo.resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+	vkColorAttachmentInfo.loadOp = vk::AttachmentLoadOp::eClear;
+	vkColorAttachmentInfo.storeOp = bMultisampled ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore;
+	vkColorAttachmentInfo.clearValue.setColor( clearColorValue );
+
+	vk::RenderingAttachmentInfo vkDepthAttachmentInfo{};
+	vkDepthAttachmentInfo.imageView = m_vkDepthImageView;
+	vkDepthAttachmentInfo.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+	vkDepthAttachmentInfo.loadOp = vk::AttachmentLoadOp::eClear;
+	vkDepthAttachmentInfo.storeOp = vk::AttachmentStoreOp::eDontCare;
+	vkDepthAttachmentInfo.clearValue.setDepthStencil( clearDepthStencilValue );
+
+	vk::RenderingInfo vkRenderingInfo{};
+	vkRenderingInfo.flags = bSecondaryContents ? vk::RenderingFlagBits::eContentsSecondaryCommandBuffers : vk::RenderingFlags{};
+	vkRenderingInfo.renderArea.offset = vk::Offset2D{ 0, 0 };
+	vkRenderingInfo.renderArea.extent = m_vkSwapchainExtent;
+	vkRenderingInfo.layerCount = 1;
+	vkRenderingInfo.colorAttachmentCount = 1;
+	vkRenderingInfo.pColorAttachments = &vkColorAttachmentInfo;
+	vkRenderingInfo.pDepthAttachment = &vkDepthAttachmentInfo;
+
+	vkCommandBuffer.beginRendering( vkRenderingInfo );
+}
+
+void VulkanApplication::endSceneRendering( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex )
+{
+	if( !m_bDynamicRendering )
+	{
+		vkCommandBuffer.endRenderPass();
+		return;
+	}
+
+	vkCommandBuffer.endRendering();
+
+	// the render pass' final layout, headless frames are copied out instead of presented
+	vk::ImageMemoryBarrier imgBarrier{};
+	imgBarrier.oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
+	imgBarrier.newLayout = m_rendererSettings.m_bHeadless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+	imgBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imgBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imgBarrier.image = m_swapchainImages[imageIndex];
+	imgBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+	imgBarrier.subresourceRange.baseMipLevel = 0;
+	imgBarrier.subresourceRange.levelCount = 1;
+	imgBarrier.subresourceRange.baseArrayLayer = 0;
+	imgBarrier.subresourceRange.layerCount = 1;
+	imgBarrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+	imgBarrier.dstAccessMask = m_rendererSettings.m_bHeadless ? vk::AccessFlagBits::eTransferRead : vk::AccessFlagBits::eNone;
+
+	// presentation waits on the render finished semaphore, which covers everything before it
+	vkCommandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eColorAttachmentOutput,
+		m_rendererSettings.m_bHeadless ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eBottomOfPipe,
+		{},
+		0, nullptr,
+		0, nullptr,
+		1, &imgBarrier
+	);
+}
+
+void VulkanApplication::recordSceneDraws( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& firstDraw, const std::uint32_t& drawCount )
+{
+	// uploadBufferData leaves the buffers null for an empty mesh
+	if( !m_vkVertexBuffer || !m_vkIndexBuffer )
+		return;
+
 	vkCommandBuffer.bindPipeline( vk::PipelineBindPoint::eGraphics, m_vkGraphicsPipeline );
 	
 	vk::Viewport vkViewport{};
@@ -432,17 +1029,130 @@ void VulkanApplication::recordCommandBuffer( vk::CommandBuffer& vkCommandBuffer,
 	vkCommandBuffer.bindIndexBuffer( m_vkIndexBuffer, 0, vk::IndexType::eUint32 );
 	vkCommandBuffer.bindDescriptorSets( 
 		vk::PipelineBindPoint::eGraphics, m_vkPipelineLayout, 
-		0, 1, &m_vkDescriptorSets[m_currentFrame],
-		0, nullptr
-	);
-	vkCommandBuffer.drawIndexed(
-		static_cast<std::uint32_t>( m_inputIndexData.size() ),
-		1,
-		0,
-		0,
-		0
+		0, 1, &m_vkDescriptorSet,
+		1, &m_frameUniformOffset
 	);
+	if constexpr( graphics::GpuVertexLayout::QUANTIZED_POSITION )
+	{
+		// recorded by value, a model swap rerecords the command buffers with the new mesh's bounds
+		vkCommandBuffer.pushConstants(
+			m_vkPipelineLayout, vk::ShaderStageFlagBits::eVertex,
+			0, sizeof(graphics::VertexDequantization), &getVertexDequantization()
+		);
+	}
 
-	vkCommandBuffer.endRenderPass();
-	vkCommandBuffer.end();
+	// draws split the triangles evenly, so any partition of the draws covers the mesh exactly once
+	std::uint64_t triangleCount = getIndexCount() / 3;
+	std::uint32_t sceneDrawCount = getSceneDrawCount();
+	for( std::uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++ )
+	{
+		std::uint64_t firstTriangle = triangleCount * draw / sceneDrawCount;
+		std::uint64_t endTriangle = triangleCount * ( draw + 1 ) / sceneDrawCount;
+
+		vkCommandBuffer.drawIndexed(
+			static_cast<std::uint32_t>( 3 * ( endTriangle - firstTriangle ) ),
+			1,
+			static_cast<std::uint32_t>( 3 * firstTriangle ),
+			0,
+			0
+		);
+	}
+}
+
+void VulkanApplication::recordSecondaryCommandBuffers( const std::uint32_t& imageIndex )
+{
+	// the slot's previous frame has been waited on, every secondary recorded into its pools last time round has retired
+	m_upThreadCommandPools->reset( m_currentFrame );
+
+	std::uint32_t drawCount = getSceneDrawCount();
+	std::uint32_t taskCount = std::min( drawCount, m_upRecordingThreadPool->getThreadSlotCount() );
+	m_vkSceneCommandBuffers.resize( taskCount );
+
+	vk::CommandBufferInheritanceInfo vkInheritanceInfo{};
+	vk::CommandBufferInheritanceRenderingInfo vkInheritanceRenderingInfo{};
+	vk::Format depthFormat = findDepthFormat();
+	if( m_bDynamicRendering )
+	{
+		vkInheritanceRenderingInfo.colorAttachmentCount = 1;
+		vkInheritanceRenderingInfo.pColorAttachmentFormats = &m_vkSwapchainImageFormat;
+		vkInheritanceRenderingInfo.depthAttachmentFormat = depthFormat;
+		vkInheritanceRenderingInfo.rasterizationSamples = m_msaaSampleCount;
+		vkInheritanceInfo.pNext = &vkInheritanceRenderingInfo;
+	}
+	else
+	{
+		vkInheritanceInfo.renderPass = m_vkRenderPass;
+		vkInheritanceInfo.subpass = 0;
+		vkInheritanceInfo.framebuffer = m_swapchainFrameBuffers[ imageIndex ];
+	}
+
+	vk::CommandBufferBeginInfo vkSecondaryBeginInfo{};
+	vkSecondaryBeginInfo.flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+	vkSecondaryBeginInfo.pInheritanceInfo = &vkInheritanceInfo;
+
+	m_upRecordingThreadPool->dispatch( taskCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& threadSlot ){
+		TRACE_SCOPE( "record_secondary" );
+		std::uint32_t firstDraw = drawCount * taskIndex / taskCount;
+		std::uint32_t endDraw = drawCount * ( taskIndex + 1 ) / taskCount;
+
+		vk::CommandBuffer vkSecondaryCommandBuffer = m_upThreadCommandPools->acquireSecondary( m_currentFrame, threadSlot );
+		vkSecondaryCommandBuffer.begin( vkSecondaryBeginInfo );
+		recordSceneDraws( vkSecondaryCommandBuffer, firstDraw, endDraw - firstDraw );
+		vkSecondaryCommandBuffer.end();
+
+		m_vkSceneCommandBuffers[taskIndex] = vkSecondaryCommandBuffer;
+	} );
+}
+
+vk::CommandBuffer VulkanApplication::acquirePrerecordedCommandBuffer( const std::uint32_t& imageIndex )
+{
+	std::size_t framesInFlight = m_vkGraphicsCommandBuffers.size();
+	std::size_t requiredCount = ( static_cast<std::size_t>( imageIndex ) + 1 ) * framesInFlight;
+	// grown on demand, a recreated swapchain may come back with more images
+	if( m_vkPrerecordedCommandBuffers.size() < requiredCount )
+	{
+		vk::CommandBufferAllocateInfo vkCmdBufAllocateInfo{};
+		vkCmdBufAllocateInfo.commandPool = m_vkGraphicsCommandPool;
+		vkCmdBufAllocateInfo.level = vk::CommandBufferLevel::ePrimary;
+		vkCmdBufAllocateInfo.commandBufferCount = static_cast<std::uint32_t>( requiredCount - m_vkPrerecordedCommandBuffers.size() );
+
+		std::vector<vk::CommandBuffer> vkNewCommandBuffers = m_vkLogicalDevice.allocateCommandBuffers( vkCmdBufAllocateInfo );
+		m_vkPrerecordedCommandBuffers.insert( m_vkPrerecordedCommandBuffers.end(), vkNewCommandBuffers.begin(), vkNewCommandBuffers.end() );
+		m_prerecordedGenerations.resize( requiredCount, 0 );
+		m_prerecordedUniformOffsets.resize( requiredCount, 0 );
+	}
+
+	// only ever submitted from this frame slot, the frame wait means the buffer is no longer pending
+	std::size_t bufferIndex = imageIndex * framesInFlight + m_currentFrame;
+	vk::CommandBuffer& vkCommandBuffer = m_vkPrerecordedCommandBuffers[bufferIndex];
+
+	if( m_prerecordedGenerations[bufferIndex] == m_recordingGeneration && m_prerecordedUniformOffsets[bufferIndex] == m_frameUniformOffset )
+	{
+		m_upGpuProfiler->resubmitFrame( m_currentFrame, m_submittedFrameValue + 1 );
+		m_commandBufferReuseStats.m_reuseCount++;
+		return vkCommandBuffer;
+	}
+
+	vkCommandBuffer.reset( {} );
+	recordCommandBuffer( vkCommandBuffer, imageIndex );
+	m_prerecordedGenerations[bufferIndex] = m_recordingGeneration;
+	m_prerecordedUniformOffsets[bufferIndex] = m_frameUniformOffset;
+	m_commandBufferReuseStats.m_recordCount++;
+	return vkCommandBuffer;
+}
+
+void VulkanApplication::invalidateRecordedCommandBuffers( const std::string& reason )
+{
+	if( !m_rendererSettings.m_bReuseCommandBuffers )
+		return;
+
+	m_recordingGeneration++;
+	m_commandBufferReuseStats.m_invalidationCount++;
+	LOG_DEBUG( fmt::format("Recorded command buffers invalidated by {}", reason) );
+}
+
+std::uint32_t VulkanApplication::getSceneDrawCount() const
+{
+	std::uint32_t triangleCount = static_cast<std::uint32_t>( getIndexCount() / 3 );
+	return std::clamp( m_rendererSettings.m_drawsPerFrame, 1u, std::max( 1u, triangleCount ) );
 }
\ No newline at end of file
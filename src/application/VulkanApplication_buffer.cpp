@@ -7,7 +7,7 @@ void VulkanApplication::createCommandPool()
 {
 	using namespace vkrender;
 
-	QueueFamilyIndices queueFamilyIndices = findQueueFamilyIndices( m_vkPhysicalDevice, &m_vkSurface );
+	const QueueFamilyIndices& queueFamilyIndices = m_deviceCapabilities.getQueueFamilyIndices();
 
 	vk::CommandPoolCreateInfo vkGraphicsCommandPoolInfo{};
 	vkGraphicsCommandPoolInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
@@ -35,6 +35,98 @@ void VulkanApplication::createCommandPool()
 	}
 }
 
+void VulkanApplication::createUploadManager()
+{
+	m_upUploadManager = std::make_unique<vkrender::VulkanUploadManager>(
+		m_vkLogicalDevice,
+		m_vkTransferQueue,
+		m_vkTransferCommandPool
+	);
+
+	LOG_INFO("Upload Manager created");
+}
+
+void VulkanApplication::createStagingArena()
+{
+	// buffer to image copies need at least texel aligned offsets
+	vk::DeviceSize offsetAlignment = std::max<vk::DeviceSize>( m_deviceCapabilities.getLimits().optimalBufferCopyOffsetAlignment, 16 );
+
+	vk::SharingMode bufferSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+
+	createBuffer(
+		STAGING_ARENA_SIZE,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		bufferSharingMode,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+		m_vkStagingBuffer,
+		m_stagingBufferAllocation
+	);
+
+	m_upStagingArena = std::make_unique<vkrender::VulkanStagingArena>(
+		m_vkStagingBuffer,
+		m_stagingBufferAllocation.m_pMappedData,
+		STAGING_ARENA_SIZE,
+		offsetAlignment
+	);
+
+	LOG_INFO( fmt::format("Staging Arena created with {} bytes", STAGING_ARENA_SIZE) );
+}
+
+vkrender::VulkanStagingArena::Slice VulkanApplication::acquireStagingMemory( const vk::DeviceSize& sizeInBytes )
+{
+	vkrender::VulkanStagingArena::Slice stagingSlice{};
+	m_totalStagedBytes += sizeInBytes;
+
+	if( sizeInBytes > m_upStagingArena->getCapacity() )
+	{
+		// too large for the arena, fall back to a staging buffer that lives until its upload retires
+		vkrender::VulkanAllocation stagingBufferAllocation;
+		vk::SharingMode bufferSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+		createBuffer(
+			sizeInBytes,
+			vk::BufferUsageFlagBits::eTransferSrc,
+			bufferSharingMode,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+			stagingSlice.m_vkBuffer,
+			stagingBufferAllocation,
+			vkrender::AllocationStrategy::eLinear
+		);
+
+		stagingSlice.m_offset = 0;
+		stagingSlice.m_pMappedData = stagingBufferAllocation.m_pMappedData;
+
+		m_upUploadManager->releaseOnCompletion( [this, stagingBuffer = stagingSlice.m_vkBuffer, stagingBufferAllocation]() mutable {
+			m_vkLogicalDevice.destroyBuffer( stagingBuffer );
+			m_upMemoryAllocator->free( stagingBufferAllocation );
+		} );
+
+		LOG_INFO( fmt::format("Staging request of {} bytes exceeds the arena, using a temporary buffer", sizeInBytes) );
+		return stagingSlice;
+	}
+
+	m_upStagingArena->reclaim( m_upUploadManager->getCompletedTimelineValue() );
+
+	while( !m_upStagingArena->tryAllocate( sizeInBytes, stagingSlice ) )
+	{
+		// the arena is full of work that was never submitted, kick it off before waiting on it
+		if( m_upStagingArena->hasUnsubmittedRegions() )
+			submitPendingUploads();
+
+		// nothing in flight would ever free up space, only a request the arena rejects outright ends up here
+		if( m_upStagingArena->getOldestPendingTimelineValue() == 0 )
+		{
+			std::string errorMsg = fmt::format("Staging arena cannot fit a request of {} bytes with no uploads in flight", sizeInBytes);
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		m_upUploadManager->wait( vkrender::UploadTicket{ m_upStagingArena->getOldestPendingTimelineValue() } );
+		m_upStagingArena->reclaim( m_upUploadManager->getCompletedTimelineValue() );
+	}
+
+	return stagingSlice;
+}
+
 void VulkanApplication::createConfigCommandBuffer()
 {
 	vk::CommandBufferAllocateInfo allocInfo{};
@@ -44,12 +136,15 @@ void VulkanApplication::createConfigCommandBuffer()
 
 	m_vkConfigCommandBuffer = m_vkLogicalDevice.allocateCommandBuffers(allocInfo)[0];
 
+	vk::FenceCreateInfo fenceInfo{};
+	m_vkConfigFence = m_vkLogicalDevice.createFence( fenceInfo );
+
 	LOG_INFO("Config Command Buffer created");
 }
 
 void VulkanApplication::createGraphicsCommandBuffers()
 {
-	m_vkGraphicsCommandBuffers.resize( MAX_FRAMES_IN_FLIGHT );
+	m_vkGraphicsCommandBuffers.resize( m_rendererSettings.m_framesInFlight );
 
 	vk::CommandBufferAllocateInfo vkCmdBufAllocateInfo{};
 	vkCmdBufAllocateInfo.commandPool = m_vkGraphicsCommandPool;
@@ -61,132 +156,209 @@ void VulkanApplication::createGraphicsCommandBuffers()
 	LOG_INFO("Graphics Command Buffer created");
 }
 
-void VulkanApplication::createVertexBuffer()
+void VulkanApplication::createRecordingThreads()
 {
+	std::uint32_t threadCount = m_rendererSettings.m_recordingThreadCount;
+	if( threadCount == 0 )
+		threadCount = std::max( 1u, std::thread::hardware_concurrency() );
 
-	std::size_t bufferSizeInBytes = sizeof(vertex) * m_inputVertexData.size();
+	// secondaries come from pools reset every frame, they cannot outlive it inside a reused primary
+	if( threadCount > 1 && m_rendererSettings.m_bReuseCommandBuffers )
+	{
+		LOG_INFO("Reusing recorded command buffers, recording inline instead of on worker threads");
+		return;
+	}
 
-	vk::Buffer stagingBuffer;
-	vk::DeviceMemory stagingBufferMemory;
-	vk::SharingMode bufferSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
-	createBuffer( 
-		static_cast<vk::DeviceSize>( bufferSizeInBytes ),
-		vk::BufferUsageFlagBits::eTransferSrc,
-		bufferSharingMode,
-		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-		stagingBuffer,
-		stagingBufferMemory
-	);
+	if( threadCount == 1 )
+	{
+		LOG_INFO("Recording command buffers inline on the main thread");
+		return;
+	}
 
-	void* mappedMemory = m_vkLogicalDevice.mapMemory(
-		stagingBufferMemory,
-		0, bufferSizeInBytes
+	// the thread recording the frame takes part, one fewer worker is needed
+	m_upRecordingThreadPool = std::make_unique<utils::ThreadPool>( threadCount - 1 );
+	m_upThreadCommandPools = std::make_unique<vkrender::VulkanThreadCommandPools>(
+		m_vkLogicalDevice,
+		m_deviceCapabilities.getQueueFamilyIndices().m_graphicsFamily.value(),
+		m_rendererSettings.m_framesInFlight,
+		m_upRecordingThreadPool->getThreadSlotCount()
 	);
-	std::memcpy( 
-		mappedMemory, 
-		m_inputVertexData.data(),
-		bufferSizeInBytes
-	);
-	m_vkLogicalDevice.unmapMemory( stagingBufferMemory );
 
-	createBuffer(
-		bufferSizeInBytes,
-		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
-		bufferSharingMode,
-		vk::MemoryPropertyFlagBits::eDeviceLocal,
+	LOG_INFO( fmt::format("Recording command buffers on {} threads, {} draws per frame", threadCount, getSceneDrawCount()) );
+}
+
+void VulkanApplication::createVertexBuffer()
+{
+	encodeInputVertexData();
+	uploadBufferData(
+		getVertexData(),
+		static_cast<vk::DeviceSize>( graphics::GpuVertexLayout::STRIDE * getVertexCount() ),
+		vk::BufferUsageFlagBits::eVertexBuffer,
 		m_vkVertexBuffer,
-		m_vkVertexBufferMemory
+		m_vertexBufferAllocation
 	);
-
-	copyBuffer( stagingBuffer, m_vkVertexBuffer, bufferSizeInBytes );
-
-	m_vkLogicalDevice.destroyBuffer( stagingBuffer );
-	m_vkLogicalDevice.freeMemory( stagingBufferMemory );
 }
 
 void VulkanApplication::createIndexBuffer()
 {
-	std::size_t bufferSizeInBytes = sizeof(IndexData::value_type) * m_inputIndexData.size();
+	uploadBufferData(
+		getIndexData(),
+		static_cast<vk::DeviceSize>( sizeof(IndexData::value_type) * getIndexCount() ),
+		vk::BufferUsageFlagBits::eIndexBuffer,
+		m_vkIndexBuffer,
+		m_indexBufferAllocation
+	);
+}
+
+void VulkanApplication::uploadBufferData(
+	const void* pSrcData,
+	const vk::DeviceSize& sizeInBytes,
+	const vk::BufferUsageFlags& bufferUsage,
+	vk::Buffer& buffer,
+	vkrender::VulkanAllocation& bufferAllocation
+)
+{
+	// no model loaded, Vulkan has no zero sized buffers so the scene just has nothing to draw
+	if( sizeInBytes == 0 )
+	{
+		buffer = nullptr;
+		bufferAllocation = vkrender::VulkanAllocation{};
+		return;
+	}
 
-	vk::Buffer stagingBuffer;
-	vk::DeviceMemory stagingBufferMemory;
 	vk::SharingMode bufferSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
 
-	createBuffer(
-		bufferSizeInBytes,
-		vk::BufferUsageFlagBits::eTransferSrc,
-		bufferSharingMode,
-		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-		stagingBuffer,
-		stagingBufferMemory
-	);
+	if( m_bDirectUpload )
+	{
+		createBuffer(
+			sizeInBytes,
+			bufferUsage,
+			bufferSharingMode,
+			vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+			buffer,
+			bufferAllocation
+		);
 
-	void* mappedMemory = m_vkLogicalDevice.mapMemory(
-		stagingBufferMemory,
-		0, 
-		static_cast<vk::DeviceSize>( bufferSizeInBytes )
-	);
-	std::memcpy( mappedMemory, m_inputIndexData.data(), bufferSizeInBytes );
-	m_vkLogicalDevice.unmapMemory( stagingBufferMemory );
+		std::memcpy( bufferAllocation.m_pMappedData, pSrcData, static_cast<std::size_t>( sizeInBytes ) );
+		return;
+	}
+
+	vkrender::VulkanStagingArena::Slice stagingSlice = acquireStagingMemory( sizeInBytes );
+
+	std::memcpy( stagingSlice.m_pMappedData, pSrcData, static_cast<std::size_t>( sizeInBytes ) );
 
 	createBuffer(
-		bufferSizeInBytes,
-		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+		sizeInBytes,
+		vk::BufferUsageFlagBits::eTransferDst | bufferUsage,
 		bufferSharingMode,
 		vk::MemoryPropertyFlagBits::eDeviceLocal,
-		m_vkIndexBuffer,
-		m_vkIndexBufferMemory
+		buffer,
+		bufferAllocation
 	);
 
-	copyBuffer( stagingBuffer, m_vkIndexBuffer, bufferSizeInBytes );
+	copyBuffer( stagingSlice.m_vkBuffer, buffer, sizeInBytes, stagingSlice.m_offset );
+
+	if( !m_bBatchInitSubmissions )
+		submitPendingUploads();
+}
+
+void VulkanApplication::submitPendingUploads()
+{
+	std::uint64_t submittedBatchCount = m_upUploadManager->getSubmittedBatchCount();
+	m_pendingUploadTicket = m_upUploadManager->flush();
+
+	if( m_upUploadManager->getSubmittedBatchCount() == submittedBatchCount )
+		return;
 
-	m_vkLogicalDevice.destroyBuffer( stagingBuffer );
-	m_vkLogicalDevice.freeMemory( stagingBufferMemory );
+	m_upStagingArena->retire( m_pendingUploadTicket.m_timelineValue );
+
+	if( !m_bBatchInitSubmissions )
+		m_upUploadManager->wait( m_pendingUploadTicket );
+	m_startupTrace.countSubmission( !m_bBatchInitSubmissions );
+
+	LOG_INFO( fmt::format("Uploads submitted on the transfer queue, ticket {}", m_pendingUploadTicket.m_timelineValue) );
 }
 
 void VulkanApplication::createUniformBuffers()
 {
-	vk::DeviceSize bufferSize = sizeof(VulkanUniformBufferObject);
+	vk::DeviceSize minOffsetAlignment = m_deviceCapabilities.getLimits().minUniformBufferOffsetAlignment;
 
-	m_vkUniformBuffers.resize( MAX_FRAMES_IN_FLIGHT );
-	m_vkUniformBuffersMemory.resize( MAX_FRAMES_IN_FLIGHT );
-	m_uniformBuffersMapped.resize( MAX_FRAMES_IN_FLIGHT );
+	vk::DeviceSize frameRegionSize = vkrender::VulkanUniformRingBuffer::alignedSliceSize( sizeof(VulkanUniformBufferObject), minOffsetAlignment ) * MAX_UNIFORM_BLOCKS_PER_FRAME;
+	vk::DeviceSize bufferSize = frameRegionSize * m_rendererSettings.m_framesInFlight;
 
 	vk::SharingMode bufferSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
 	
-	for( std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-	{
-		createBuffer(
-			bufferSize, vk::BufferUsageFlagBits::eUniformBuffer,
-			bufferSharingMode,
-			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-			m_vkUniformBuffers[i], m_vkUniformBuffersMemory[i]
-		);
+	createBuffer(
+		bufferSize, vk::BufferUsageFlagBits::eUniformBuffer,
+		bufferSharingMode,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+		m_vkUniformBuffer, m_uniformBufferAllocation
+	);
 
-		m_uniformBuffersMapped[i] = m_vkLogicalDevice.mapMemory( m_vkUniformBuffersMemory[i], 0, bufferSize );
-	}
+	m_upUniformRingBuffer = std::make_unique<vkrender::VulkanUniformRingBuffer>(
+		m_uniformBufferAllocation.m_pMappedData,
+		frameRegionSize,
+		m_rendererSettings.m_framesInFlight,
+		minOffsetAlignment
+	);
+
+	LOG_INFO( fmt::format("Uniform Ring Buffer created with {} bytes per frame", frameRegionSize) );
 }
 
 void VulkanApplication::setupConfigCommandBuffer()
 {
+	// keep appending while a batch is open
+	if( m_bConfigCommandBufferRecording )
+		return;
+
 	m_vkConfigCommandBuffer.reset( {} );
 
 	vk::CommandBufferBeginInfo beginInfo{};
 	beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
 	
 	m_vkConfigCommandBuffer.begin( beginInfo );
+	m_bConfigCommandBufferRecording = true;
 }
 
 void VulkanApplication::flushConfigCommandBuffer()
 {
+	if( m_bDeferConfigCommandFlush || !m_bConfigCommandBufferRecording )
+		return;
+
 	m_vkConfigCommandBuffer.end();
+	m_bConfigCommandBufferRecording = false;
 
 	vk::SubmitInfo submitInfo{};
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &m_vkConfigCommandBuffer;
 
-	vk::Result opResult = m_vkGraphicsQueue.submit( 1, &submitInfo, {} );
-	m_vkGraphicsQueue.waitIdle();
+	// mipmap blits read the texture written on the transfer queue
+	vk::Semaphore uploadSemaphore = m_upUploadManager->getTimelineSemaphore();
+	vk::PipelineStageFlags uploadWaitStage = vk::PipelineStageFlagBits::eTransfer;
+	vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+	if( !m_upUploadManager->isComplete( m_pendingUploadTicket ) )
+	{
+		timelineSubmitInfo.waitSemaphoreValueCount = 1;
+		timelineSubmitInfo.pWaitSemaphoreValues = &m_pendingUploadTicket.m_timelineValue;
+		submitInfo.pNext = &timelineSubmitInfo;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &uploadSemaphore;
+		submitInfo.pWaitDstStageMask = &uploadWaitStage;
+	}
+
+	auto l_checkResult = []( const vk::Result& opResult, const char* pOperation ) {
+		if( opResult != vk::Result::eSuccess )
+		{
+			std::string errorMsg = fmt::format("FAILED TO {} CONFIG COMMAND BUFFER: {}", pOperation, vk::to_string( opResult ));
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+	};
+
+	l_checkResult( m_vkGraphicsQueue.submit( 1, &submitInfo, m_vkConfigFence ), "SUBMIT" );
+	l_checkResult( m_vkLogicalDevice.waitForFences( 1, &m_vkConfigFence, VK_TRUE, std::numeric_limits<std::uint64_t>::max() ), "WAIT FOR" );
+	l_checkResult( m_vkLogicalDevice.resetFences( 1, &m_vkConfigFence ), "RESET FENCE OF" );
+	m_startupTrace.countSubmission( true );
 }
 
 void VulkanApplication::createBuffer(
@@ -195,21 +367,15 @@ void VulkanApplication::createBuffer(
 	const vk::SharingMode& bufferSharingMode,
     const vk::MemoryPropertyFlags& memProps,
     vk::Buffer& buffer,
-    vk::DeviceMemory& bufferMemory
+    vkrender::VulkanAllocation& bufferAllocation,
+	const vkrender::AllocationStrategy& allocationStrategy
 )
 {
-	vkrender::QueueFamilyIndices queueFamilyIndices = findQueueFamilyIndices( 
-		m_vkPhysicalDevice,
-		&m_vkSurface
-	);
-
 	vk::BufferCreateInfo bufferInfo{};
 	bufferInfo.size = bufferSizeInBytes;
 	bufferInfo.usage = bufferUsage;
 	bufferInfo.sharingMode = bufferSharingMode;
-	std::vector<uint32_t> queueFamilyToShare;
-	queueFamilyToShare.emplace_back( queueFamilyIndices.m_graphicsFamily.value() );
-	if( queueFamilyIndices.m_exclusiveTransferFamily.has_value() ) queueFamilyToShare.emplace_back( queueFamilyIndices.m_exclusiveTransferFamily.value() );
+	const std::vector<std::uint32_t>& queueFamilyToShare = m_deviceCapabilities.getSharedQueueFamilies();
 	bufferInfo.pQueueFamilyIndices = queueFamilyToShare.data();
 	bufferInfo.queueFamilyIndexCount = queueFamilyToShare.size();
 
@@ -219,11 +385,18 @@ void VulkanApplication::createBuffer(
 
 	vk::MemoryRequirements memRequirements = m_vkLogicalDevice.getBufferMemoryRequirements( buffer );
 
-	vk::MemoryAllocateInfo allocInfo{};
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType( memRequirements.memoryTypeBits, memProps );
-
-	bufferMemory = m_vkLogicalDevice.allocateMemory( allocInfo );
+	// host visible buffers the GPU reads in place, uniforms and direct uploads, prefer device local memory when
+	// the device maps it (BAR, ReBAR or unified memory). Staging sources only feed copies and stay in system
+	// memory rather than taking up the small BAR heap.
+	bool bPreferDeviceLocal = ( memProps & vk::MemoryPropertyFlagBits::eHostVisible ) && !( bufferUsage & vk::BufferUsageFlagBits::eTransferSrc );
+	vk::MemoryPropertyFlags preferredMemProps = bPreferDeviceLocal ? vk::MemoryPropertyFlags{ vk::MemoryPropertyFlagBits::eDeviceLocal } : vk::MemoryPropertyFlags{};
+
+	bufferAllocation = m_upMemoryAllocator->allocate(
+		memRequirements,
+		findMemoryType( memRequirements.memoryTypeBits, memProps, preferredMemProps ),
+		vkrender::AllocationResourceType::eLinear,
+		allocationStrategy
+	);
 
-	m_vkLogicalDevice.bindBufferMemory( buffer, bufferMemory, 0 );
+	m_vkLogicalDevice.bindBufferMemory( buffer, bufferAllocation.m_memory, bufferAllocation.m_offset );
 }
\ No newline at end of file
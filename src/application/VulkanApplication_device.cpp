@@ -23,40 +23,36 @@ void VulkanApplication::pickPhysicalDevice()
 		bool mbHasGeometryShader;
 	};
 
-	auto l_probePhysicalDeviceHandle = []( const vk::PhysicalDevice& vkPhysicalDevice ) {
-		const vk::PhysicalDeviceProperties& deviceProperties = vkPhysicalDevice.getProperties();
+	auto l_probePhysicalDeviceHandle = []( const vk::PhysicalDeviceProperties& deviceProperties ) {
         LOG_INFO(
             fmt::format("Device ID : {} Device Name : {} Vendor: {}", deviceProperties.deviceID, deviceProperties.deviceName, deviceProperties.vendorID)
         );
 	};
 
-	auto l_populateDeviceProperties = []( 
-		vk::PhysicalDevice& vkPhysicalDevice, 
-		vk::PhysicalDeviceProperties* pPhysicalDeviceProperties, vk::PhysicalDeviceFeatures* pPhysicalDeviceFeatures
-	)
-	{
-		vkPhysicalDevice.getProperties( pPhysicalDeviceProperties );
-		vkPhysicalDevice.getFeatures( pPhysicalDeviceFeatures );
-	};
+	bool bHeadless = m_rendererSettings.m_bHeadless;
 
-	auto l_isDeviceSuitable = [this](
-		const vk::PhysicalDevice& physicalDevice, 
-		vk::SurfaceKHR* surface,
+	auto l_isDeviceSuitable = [this, bHeadless](
+		const DeviceCapabilities& deviceCapabilities, 
+		const vk::SurfaceKHR& surface,
 		const std::vector<const char*>& requiredExtensions,
 		const DeviceCandiate& bestCandidate,
 		std::uint32_t& deviceScore
 	) -> bool{
-		QueueFamilyIndices queueFamilyIndices = findQueueFamilyIndices( physicalDevice, surface );
+		const vk::PhysicalDevice& physicalDevice = deviceCapabilities.getPhysicalDevice();
+		const QueueFamilyIndices& queueFamilyIndices = deviceCapabilities.getQueueFamilyIndices();
 
-		const vk::PhysicalDeviceFeatures& vkPhysicalDeviceFeatures = physicalDevice.getFeatures();
-		const vk::PhysicalDeviceProperties& vkPhysicalDeviceProperties = physicalDevice.getProperties();
+		const vk::PhysicalDeviceFeatures& vkPhysicalDeviceFeatures = deviceCapabilities.getFeatures();
+		const vk::PhysicalDeviceProperties& vkPhysicalDeviceProperties = deviceCapabilities.getProperties();
 
 		bool bIntegratedGpu = vkPhysicalDeviceProperties.deviceType == vk::PhysicalDeviceType::eIntegratedGpu;
 		bool bDiscreteGpu = vkPhysicalDeviceProperties.deviceType == vk::PhysicalDeviceType::eDiscreteGpu;
-        bool bShader =  vkPhysicalDeviceFeatures.geometryShader;
+		// software rasterisers such as lavapipe and SwiftShader report a cpu device
+		bool bCpuDevice = vkPhysicalDeviceProperties.deviceType == vk::PhysicalDeviceType::eCpu;
         bool bSamplerAnisotropy = static_cast<bool>( vkPhysicalDeviceFeatures.samplerAnisotropy );
 
         bool bGraphicsFamily = queueFamilyIndices.m_graphicsFamily.has_value();
+		// timeline semaphores are core and mandatory from 1.2
+		bool bTimelineSemaphore = vkPhysicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2;
         
 		auto l_checkDeviceExtensionSupport = []( const vk::PhysicalDevice& physicalDevice, const std::vector<const char*>& requiredExtensions ){
 			std::vector<vk::ExtensionProperties, std::allocator<vk::ExtensionProperties>> availableExtensions = physicalDevice.enumerateDeviceExtensionProperties();
@@ -85,14 +81,16 @@ void VulkanApplication::pickPhysicalDevice()
 		};
 
         bool bExtensionsSupported =  l_checkDeviceExtensionSupport( physicalDevice, requiredExtensions );
-        bool bSwapChainAdequate = l_checkSwapChainAdequacy( physicalDevice, *surface, bExtensionsSupported );
+        bool bSwapChainAdequate = bHeadless ? bExtensionsSupported : l_checkSwapChainAdequacy( physicalDevice, surface, bExtensionsSupported );
 
+		// the pipeline has no geometry stage, it only breaks ties between devices
+		deviceScore += 1;
 		if(bestCandidate.mDeviceType == vkPhysicalDeviceProperties.deviceType)
 			deviceScore += 10;
 		if( vkPhysicalDeviceFeatures.geometryShader == bestCandidate.mbHasGeometryShader )
 			deviceScore += 10;
 
-        return bShader && ( bIntegratedGpu || bDiscreteGpu ) && bGraphicsFamily && bExtensionsSupported && bSwapChainAdequate & bSamplerAnisotropy;
+        return ( bIntegratedGpu || bDiscreteGpu || ( bHeadless && bCpuDevice ) ) && bGraphicsFamily && bExtensionsSupported && bSwapChainAdequate & bSamplerAnisotropy && bTimelineSemaphore;
 	};
 
 	DeviceCandiate bestCandidate{
@@ -100,43 +98,43 @@ void VulkanApplication::pickPhysicalDevice()
 		true
 	};
 
-	//for( auto& vkTemporaryDevice : devices )
-	std::uint32_t bestCandidateIndex = 0u;
 	std::uint32_t bestDeviceScore = 0u;
-	std::vector<const char*> requiredExtensions{
-		VK_KHR_SWAPCHAIN_EXTENSION_NAME
-	};
+	std::vector<const char*> requiredExtensions;
+	if( !bHeadless )
+		requiredExtensions.push_back( VK_KHR_SWAPCHAIN_EXTENSION_NAME );
 	for( std::uint32_t deviceIndex = 0u; deviceIndex < devices.size(); deviceIndex++ )
 	{
-		vk::PhysicalDevice& vkTemporaryDevice = devices[deviceIndex];
-
-		l_probePhysicalDeviceHandle( vkTemporaryDevice );
-
-		vk::PhysicalDeviceFeatures vkPhysicalDeviceFeatures;
-		vk::PhysicalDeviceProperties vkPhysicalDeviceProperties;
+		DeviceCapabilities deviceCapabilities{ devices[deviceIndex], bHeadless ? nullptr : &m_vkSurface };
 
-		l_populateDeviceProperties( vkTemporaryDevice, &vkPhysicalDeviceProperties, &vkPhysicalDeviceFeatures );
+		l_probePhysicalDeviceHandle( deviceCapabilities.getProperties() );
 		
 		std::uint32_t deviceScore = 0u;
-		if( l_isDeviceSuitable( vkTemporaryDevice, &m_vkSurface, requiredExtensions, bestCandidate, deviceScore ) )
+		if( l_isDeviceSuitable( deviceCapabilities, m_vkSurface, requiredExtensions, bestCandidate, deviceScore ) )
 		{
 			if( deviceScore > bestDeviceScore )
 			{
 				bestDeviceScore = deviceScore;
-				bestCandidateIndex = deviceIndex;
+				m_deviceCapabilities = std::move( deviceCapabilities );
 			}
 		}
 	}
 
 	if( bestDeviceScore > 0u )
 	{
-		m_vkPhysicalDevice = devices[bestCandidateIndex];
+		m_vkPhysicalDevice = m_deviceCapabilities.getPhysicalDevice();
 		m_msaaSampleCount = getMaxUsableSampleCount();
 		m_deviceExtensionContainer = requiredExtensions;
+		// optional, without them the frame pacer cannot see when a present reaches the display
+		m_bPresentWait = !bHeadless && m_deviceCapabilities.supportsPresentWait();
+		if( m_bPresentWait )
+		{
+			m_deviceExtensionContainer.push_back( VK_KHR_PRESENT_ID_EXTENSION_NAME );
+			m_deviceExtensionContainer.push_back( VK_KHR_PRESENT_WAIT_EXTENSION_NAME );
+		}
 		m_deviceExtensionContainer.shrink_to_fit();
 
 		LOG_INFO("Selected Suitable Vulkan GPU!");
-        l_probePhysicalDeviceHandle( m_vkPhysicalDevice );
+        l_probePhysicalDeviceHandle( m_deviceCapabilities.getProperties() );
 		return;
 	}
 
@@ -148,7 +146,7 @@ void VulkanApplication::pickPhysicalDevice()
 void VulkanApplication::createLogicalDevice()
 {
 	using namespace vkrender;
-	QueueFamilyIndices queueFamilyIndices = findQueueFamilyIndices( m_vkPhysicalDevice, &m_vkSurface );
+	const QueueFamilyIndices& queueFamilyIndices = m_deviceCapabilities.getQueueFamilyIndices();
 
 	logQueueFamilyIndices( queueFamilyIndices );
 	
@@ -178,9 +176,36 @@ void VulkanApplication::createLogicalDevice()
 	}
 
 	vk::DeviceCreateInfo vkDeviceCreateInfo{};
-	vk::PhysicalDeviceFeatures physicalDeviceFeatures = m_vkPhysicalDevice.getFeatures(); // TODO check state
+	vk::PhysicalDeviceFeatures physicalDeviceFeatures = m_deviceCapabilities.getFeatures(); // TODO check state
 	populateDeviceCreateInfo( vkDeviceCreateInfo, deviceQueueCreateInfos, &physicalDeviceFeatures );
 
+	vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.timelineSemaphore = VK_TRUE;
+	vkDeviceCreateInfo.pNext = &vulkan12Features;
+
+	m_bDynamicRendering = m_rendererSettings.m_renderingPath == RenderingPath::eDynamicRendering;
+	if( m_bDynamicRendering && !m_deviceCapabilities.supportsDynamicRendering() )
+	{
+		LOG_INFO("Device does not support dynamic rendering, falling back to the render pass path");
+		m_bDynamicRendering = false;
+	}
+
+	vk::PhysicalDeviceVulkan13Features vulkan13Features{};
+	vulkan13Features.dynamicRendering = VK_TRUE;
+	if( m_bDynamicRendering )
+		vulkan12Features.pNext = &vulkan13Features;
+
+	vk::PhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+	presentIdFeatures.presentId = VK_TRUE;
+	vk::PhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+	presentWaitFeatures.presentWait = VK_TRUE;
+	if( m_bPresentWait )
+	{
+		presentIdFeatures.pNext = &presentWaitFeatures;
+		presentWaitFeatures.pNext = vulkan12Features.pNext;
+		vulkan12Features.pNext = &presentIdFeatures;
+	}
+
 	m_vkLogicalDevice = m_vkPhysicalDevice.createDevice( vkDeviceCreateInfo );	
 	LOG_INFO("Logical Device created");
 
@@ -205,46 +230,70 @@ void VulkanApplication::createLogicalDevice()
 	}
 }
 
-vkrender::QueueFamilyIndices VulkanApplication::findQueueFamilyIndices( const vk::PhysicalDevice& physicalDevice, vk::SurfaceKHR* pVkSurface )
+void VulkanApplication::createMemoryAllocator()
 {
-	vkrender::QueueFamilyIndices queueFamilyIndices;
+	m_upMemoryAllocator = std::make_unique<vkrender::VulkanMemoryAllocator>(
+		m_vkLogicalDevice,
+		m_deviceCapabilities.getMemoryProperties(),
+		m_deviceCapabilities.getLimits().bufferImageGranularity
+	);
 
-	std::vector<vk::QueueFamilyProperties> queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
+	LOG_INFO("Device Memory Allocator created");
+}
 
-	int validQueueIndex = 0;
+void VulkanApplication::createDeletionQueue()
+{
+	m_upDeletionQueue = std::make_unique<vkrender::VulkanDeletionQueue>();
 
-	for (const auto& prop : queueFamilyProperties)
-	{
-		if (prop.queueFlags & vk::QueueFlagBits::eGraphics )
-		{
-			queueFamilyIndices.m_graphicsFamily = validQueueIndex;
-		}
+	LOG_INFO("Deletion Queue created");
+}
 
-		if( prop.queueFlags & vk::QueueFlagBits::eCompute )
-		{
-			queueFamilyIndices.m_computeFamily = validQueueIndex;
-		}
+void VulkanApplication::createFramePacer()
+{
+	m_upFramePacer = std::make_unique<vkrender::VulkanFramePacer>(
+		m_vkLogicalDevice,
+		m_bPresentWait,
+		m_rendererSettings.m_frameRateLimit,
+		m_rendererSettings.m_maxQueuedPresents
+	);
+
+	LOG_INFO( fmt::format("Frame Pacer created, frame rate limit {} fps, present wait {}", m_rendererSettings.m_frameRateLimit, m_bPresentWait ? "enabled" : "unavailable") );
+}
 
-		if( 
-			prop.queueFlags & vk::QueueFlagBits::eTransfer && 
-			( !( prop.queueFlags & vk::QueueFlagBits::eGraphics ) && !( prop.queueFlags & vk::QueueFlagBits::eCompute ) )
-		)
-		{
-			queueFamilyIndices.m_exclusiveTransferFamily = validQueueIndex;
-		}
+void VulkanApplication::resolveUploadPath()
+{
+	const vk::PhysicalDeviceProperties& physicalDeviceProps = m_deviceCapabilities.getProperties();
+	const vk::PhysicalDeviceMemoryProperties& memoryProps = m_deviceCapabilities.getMemoryProperties();
 
-		if( pVkSurface )
-		{
-			vk::Bool32 bPresentationSupport = physicalDevice.getSurfaceSupportKHR( validQueueIndex, *pVkSurface );
-			if( bPresentationSupport )
-			{
-				queueFamilyIndices.m_presentFamily = validQueueIndex;					
-			}
-		}
-		validQueueIndex++;
+	vk::MemoryPropertyFlags directFlags = vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	vk::DeviceSize directHeapSize = 0;
+
+	for( auto i = 0u; i < memoryProps.memoryTypeCount; i++ )
+	{
+		if( ( memoryProps.memoryTypes[i].propertyFlags & directFlags ) == directFlags )
+			directHeapSize = std::max( directHeapSize, memoryProps.memoryHeaps[ memoryProps.memoryTypes[i].heapIndex ].size );
+	}
+
+	bool bUnifiedMemory = physicalDeviceProps.deviceType == vk::PhysicalDeviceType::eIntegratedGpu || physicalDeviceProps.deviceType == vk::PhysicalDeviceType::eCpu;
+	// a discrete gpu without resizable bar only exposes a 256 MiB window, keep staging there
+	bool bResizableBar = directHeapSize > RESIZABLE_BAR_MIN_HEAP_SIZE;
+
+	switch( m_uploadPath )
+	{
+	case vkrender::UploadPath::eStaged:
+		m_bDirectUpload = false;
+		break;
+	case vkrender::UploadPath::eDirect:
+		m_bDirectUpload = directHeapSize > 0;
+		if( !m_bDirectUpload )
+			LOG_INFO("Direct uploads requested but no host visible device local memory exists, staging instead");
+		break;
+	default:
+		m_bDirectUpload = directHeapSize > 0 && ( bUnifiedMemory || bResizableBar );
+		break;
 	}
 
-	return queueFamilyIndices;
+	LOG_INFO( fmt::format("Buffer uploads use the {} path, host visible device local heap {} bytes", m_bDirectUpload ? "direct" : "staged", directHeapSize) );
 }
 
 void VulkanApplication::logQueueFamilyIndices( const vkrender::QueueFamilyIndices& queueFamilyIndices )
@@ -40,7 +40,8 @@ void VulkanApplication::createRenderPass()
 	vkColorAttachmentResolve.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
 	vkColorAttachmentResolve.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
 	vkColorAttachmentResolve.initialLayout = vk::ImageLayout::eUndefined;
-	vkColorAttachmentResolve.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+	// headless frames are copied out to a readback buffer instead of presented
+	vkColorAttachmentResolve.finalLayout = m_rendererSettings.m_bHeadless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
 
 	vk::AttachmentReference vkColorAttachmentResolveRef{};
 	vkColorAttachmentResolveRef.attachment = 2;
@@ -79,7 +80,7 @@ void VulkanApplication::createDescriptorSetLayout()
 {
 	vk::DescriptorSetLayoutBinding uboLayoutBinding{};
 	uboLayoutBinding.binding = 0;
-	uboLayoutBinding.descriptorType = vk::DescriptorType::eUniformBuffer;
+	uboLayoutBinding.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
 	uboLayoutBinding.descriptorCount = 1;
 	uboLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eVertex;
 	uboLayoutBinding.pImmutableSamplers = nullptr;
@@ -104,65 +105,67 @@ void VulkanApplication::createDescriptorSetLayout()
 void VulkanApplication::createDescriptorPool()
 {
 	std::array<vk::DescriptorPoolSize, 2> descPoolSizes;
-	descPoolSizes[0].type = vk::DescriptorType::eUniformBuffer;
-	descPoolSizes[0].descriptorCount = static_cast<std::uint32_t>( MAX_FRAMES_IN_FLIGHT );
+	descPoolSizes[0].type = vk::DescriptorType::eUniformBufferDynamic;
+	descPoolSizes[0].descriptorCount = 1;
 	descPoolSizes[1].type = vk::DescriptorType::eCombinedImageSampler;
-	descPoolSizes[1].descriptorCount = static_cast<std::uint32_t>( MAX_FRAMES_IN_FLIGHT );
+	descPoolSizes[1].descriptorCount = 1;
 
 	vk::DescriptorPoolCreateInfo descCreateInfo{};
 	descCreateInfo.poolSizeCount = static_cast<std::uint32_t>( descPoolSizes.size() );
 	descCreateInfo.pPoolSizes = descPoolSizes.data();
-	descCreateInfo.maxSets = static_cast<std::uint32_t>( MAX_FRAMES_IN_FLIGHT );
+	descCreateInfo.maxSets = 1;
 
 	m_vkDescriptorPool = m_vkLogicalDevice.createDescriptorPool( descCreateInfo );
 }
 
 void VulkanApplication::createDescriptorSets()
 {
-	std::vector<vk::DescriptorSetLayout> descLayouts( MAX_FRAMES_IN_FLIGHT, m_vkDescriptorSetLayout );
-
 	vk::DescriptorSetAllocateInfo descSetAllocInfo{};
 	descSetAllocInfo.descriptorPool = m_vkDescriptorPool;
-	descSetAllocInfo.descriptorSetCount = static_cast<std::uint32_t>(MAX_FRAMES_IN_FLIGHT);
-	descSetAllocInfo.pSetLayouts = descLayouts.data();
+	descSetAllocInfo.descriptorSetCount = 1;
+	descSetAllocInfo.pSetLayouts = &m_vkDescriptorSetLayout;
 
-	m_vkDescriptorSets = m_vkLogicalDevice.allocateDescriptorSets( descSetAllocInfo );
+	m_vkDescriptorSet = m_vkLogicalDevice.allocateDescriptorSets( descSetAllocInfo )[0];
 
+	// every frame and draw binds the same set, the slice is selected through the dynamic offset
+	vk::DescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = m_vkUniformBuffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = sizeof(VulkanUniformBufferObject);
 
-	for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		vk::DescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = m_vkUniformBuffers[i];
-		bufferInfo.offset = 0;
-		bufferInfo.range = sizeof(VulkanUniformBufferObject);
-
-		vk::DescriptorImageInfo imageInfo{};
-		imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-		imageInfo.imageView = m_vkTextureImageView;
-		imageInfo.sampler = m_vkTextureSampler;
-
-		std::array<vk::WriteDescriptorSet, 2> descWrites;
-		
-		descWrites[0].dstSet = m_vkDescriptorSets[i];
-		descWrites[0].dstBinding = 0;
-		descWrites[0].dstArrayElement = 0;
-		descWrites[0].descriptorType = vk::DescriptorType::eUniformBuffer;
-		descWrites[0].descriptorCount = 1;
-		descWrites[0].pBufferInfo = &bufferInfo;
-		descWrites[0].pImageInfo = nullptr;
-		descWrites[0].pTexelBufferView = nullptr;
-
-		descWrites[1].dstSet = m_vkDescriptorSets[i];
-		descWrites[1].dstBinding = 1;
-		descWrites[1].dstArrayElement = 0;
-		descWrites[1].descriptorType = vk::DescriptorType::eCombinedImageSampler;
-		descWrites[1].descriptorCount = 1;
-		descWrites[1].pBufferInfo = nullptr;
-		descWrites[1].pImageInfo = &imageInfo;
-		descWrites[1].pTexelBufferView = nullptr;
-
-		m_vkLogicalDevice.updateDescriptorSets( descWrites, {} );
-	}
+	vk::DescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	imageInfo.imageView = m_vkTextureImageView;
+	imageInfo.sampler = m_vkTextureSampler;
+
+	std::array<vk::WriteDescriptorSet, 2> descWrites;
+	
+	descWrites[0].dstSet = m_vkDescriptorSet;
+	descWrites[0].dstBinding = 0;
+	descWrites[0].dstArrayElement = 0;
+	descWrites[0].descriptorType = vk::DescriptorType::eUniformBufferDynamic;
+	descWrites[0].descriptorCount = 1;
+	descWrites[0].pBufferInfo = &bufferInfo;
+	descWrites[0].pImageInfo = nullptr;
+	descWrites[0].pTexelBufferView = nullptr;
+
+	descWrites[1].dstSet = m_vkDescriptorSet;
+	descWrites[1].dstBinding = 1;
+	descWrites[1].dstArrayElement = 0;
+	descWrites[1].descriptorType = vk::DescriptorType::eCombinedImageSampler;
+	descWrites[1].descriptorCount = 1;
+	descWrites[1].pBufferInfo = nullptr;
+	descWrites[1].pImageInfo = &imageInfo;
+	descWrites[1].pTexelBufferView = nullptr;
+
+	m_vkLogicalDevice.updateDescriptorSets( descWrites, {} );
+}
+
+void VulkanApplication::createPipelineCache()
+{
+	m_upPipelineCache = std::make_unique<vkrender::VulkanPipelineCache>(
+		m_vkLogicalDevice, m_deviceCapabilities.getProperties(), m_rendererSettings.m_pipelineCacheFilePath
+	);
 }
 
 void VulkanApplication::createGraphicsPipeline()
@@ -180,7 +183,8 @@ void VulkanApplication::createGraphicsPipeline()
 		shaderStageCreateInfo.pSpecializationInfo = nullptr;
 	};
 
-	std::filesystem::path vertexShaderPath = "triangleVert.spv";
+	// each vertex layout has its own vertex shader, the fragment shader is shared
+	std::filesystem::path vertexShaderPath = fmt::format( "{}Vert.spv", graphics::GPU_VERTEX_SHADER_NAME );
     std::filesystem::path fragmentShaderPath = "triangleFrag.spv";
 
 	std::vector<char> vertexShaderBuffer; 
@@ -211,8 +215,8 @@ void VulkanApplication::createGraphicsPipeline()
 	};
 	
 	vk::PipelineVertexInputStateCreateInfo vkVertexInputInfo{};
-	vk::VertexInputBindingDescription bindingDesc = vertex::getBindingDescription();
-	std::array<vk::VertexInputAttributeDescription, 3> attributeDesc = vertex::getAttributeDescriptions();
+	vk::VertexInputBindingDescription bindingDesc = graphics::GpuVertexLayout::getBindingDescription();
+	auto attributeDesc = graphics::GpuVertexLayout::getAttributeDescriptions();
 	vkVertexInputInfo.vertexBindingDescriptionCount = 1;
 	vkVertexInputInfo.pVertexBindingDescriptions = &bindingDesc;
 	vkVertexInputInfo.vertexAttributeDescriptionCount = attributeDesc.size();
@@ -292,8 +296,10 @@ void VulkanApplication::createGraphicsPipeline()
 	vk::PipelineLayoutCreateInfo vkPipelineLayoutInfo{};
 	vkPipelineLayoutInfo.setLayoutCount = 1;
 	vkPipelineLayoutInfo.pSetLayouts = &m_vkDescriptorSetLayout;
-	vkPipelineLayoutInfo.pushConstantRangeCount = 0;
-	vkPipelineLayoutInfo.pPushConstantRanges = nullptr;
+	// quantized positions are decoded with the mesh's VertexDequantization
+	vk::PushConstantRange vkDequantizationRange{ vk::ShaderStageFlagBits::eVertex, 0, sizeof(graphics::VertexDequantization) };
+	vkPipelineLayoutInfo.pushConstantRangeCount = graphics::GpuVertexLayout::QUANTIZED_POSITION ? 1 : 0;
+	vkPipelineLayoutInfo.pPushConstantRanges = graphics::GpuVertexLayout::QUANTIZED_POSITION ? &vkDequantizationRange : nullptr;
 	
 	m_vkPipelineLayout = m_vkLogicalDevice.createPipelineLayout( vkPipelineLayoutInfo );
 
@@ -316,12 +322,43 @@ void VulkanApplication::createGraphicsPipeline()
 	vkGraphicsPipelineCreateInfo.basePipelineHandle = nullptr;
 	vkGraphicsPipelineCreateInfo.basePipelineIndex = -1;
 
-	
-	vk::ResultValue<vk::Pipeline> operationResult = m_vkLogicalDevice.createGraphicsPipeline( nullptr, vkGraphicsPipelineCreateInfo );
+	// creation feedback is core from 1.3 and reports whether the driver found the pipeline in the cache
+	bool bCreationFeedback = m_deviceCapabilities.getProperties().apiVersion >= VK_API_VERSION_1_3;
+	vk::PipelineCreationFeedback vkPipelineFeedback{};
+	vk::PipelineCreationFeedbackCreateInfo vkPipelineFeedbackInfo{};
+	vkPipelineFeedbackInfo.pPipelineCreationFeedback = &vkPipelineFeedback;
+	if( bCreationFeedback )
+		vkGraphicsPipelineCreateInfo.pNext = &vkPipelineFeedbackInfo;
+
+	// without a render pass the attachment formats are given up front instead
+	vk::PipelineRenderingCreateInfo vkPipelineRenderingInfo{};
+	vkPipelineRenderingInfo.colorAttachmentCount = 1;
+	vkPipelineRenderingInfo.pColorAttachmentFormats = &m_vkSwapchainImageFormat;
+	// stencil testing is off, a combined depth stencil format is only bound as the depth attachment
+	vkPipelineRenderingInfo.depthAttachmentFormat = findDepthFormat();
+	if( m_bDynamicRendering )
+	{
+		vkPipelineRenderingInfo.pNext = vkGraphicsPipelineCreateInfo.pNext;
+		vkGraphicsPipelineCreateInfo.pNext = &vkPipelineRenderingInfo;
+		vkGraphicsPipelineCreateInfo.renderPass = nullptr;
+	}
+
+	auto pipelineCreateStart = utils::StartupTrace::Clock::now();
+	vk::ResultValue<vk::Pipeline> operationResult = m_vkLogicalDevice.createGraphicsPipeline( m_upPipelineCache->getPipelineCache(), vkGraphicsPipelineCreateInfo );
+	double pipelineCreateMs = std::chrono::duration<double, std::milli>( utils::StartupTrace::Clock::now() - pipelineCreateStart ).count();
 	if( operationResult.result == vk::Result::eSuccess )
 	{
 		m_vkGraphicsPipeline = operationResult.value;
-		LOG_INFO("Graphics Pipeline created");
+
+		// without feedback a pipeline built from loaded cache data is assumed to be a hit
+		std::string cacheOutcome;
+		if( bCreationFeedback && ( vkPipelineFeedback.flags & vk::PipelineCreationFeedbackFlagBits::eValid ) )
+			cacheOutcome = ( vkPipelineFeedback.flags & vk::PipelineCreationFeedbackFlagBits::eApplicationPipelineCacheHit ) ? "hit" : "miss";
+		else
+			cacheOutcome = m_upPipelineCache->getLoadResult() == vkrender::VulkanPipelineCache::LoadResult::eLoaded ? "loaded" : "miss";
+
+		m_startupTrace.recordStep( fmt::format( "pipelineCompile (cache {})", cacheOutcome ), pipelineCreateMs );
+		LOG_INFO( fmt::format("Graphics Pipeline created in {:.3f} ms, pipeline cache {}", pipelineCreateMs, cacheOutcome) );
 	}
 	else
 	{
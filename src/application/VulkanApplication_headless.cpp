@@ -0,0 +1,169 @@
+#include "application/VulkanApplication.h"
+#include "utilities/VulkanLogger.h"
+
+void VulkanApplication::requestQuit()
+{
+	m_bQuitRequested = true;
+}
+
+void VulkanApplication::onFrameReadback( const std::uint8_t* pPixels, const std::uint32_t& width, const std::uint32_t& height, const std::uint64_t& frameValue )
+{}
+
+void VulkanApplication::createOffscreenTargets()
+{
+	// copied out byte for byte, so the layout handed to onFrameReadback is fixed to RGBA8
+	m_vkSwapchainImageFormat = findSupportedImgFormat(
+		{ vk::Format::eR8G8B8A8Srgb },
+		vk::ImageTiling::eOptimal,
+		vk::FormatFeatureFlagBits::eColorAttachment | vk::FormatFeatureFlagBits::eTransferSrc
+	);
+	m_vkSwapchainExtent = vk::Extent2D{ m_rendererSettings.m_headlessWidth, m_rendererSettings.m_headlessHeight };
+	m_vkSwapchainImageSharingMode = vk::SharingMode::eExclusive;
+
+	// one target and one readback buffer per frame slot, a slot is only reused once the frame clock has passed its last frame
+	std::uint32_t targetCount = m_rendererSettings.m_framesInFlight;
+	vk::DeviceSize readbackSize = static_cast<vk::DeviceSize>( m_vkSwapchainExtent.width ) * m_vkSwapchainExtent.height * 4;
+
+	m_swapchainImages.resize( targetCount );
+	m_swapchainImageViews.resize( targetCount );
+	m_offscreenImageAllocations.resize( targetCount );
+	m_vkReadbackBuffers.resize( targetCount );
+	m_readbackBufferAllocations.resize( targetCount );
+	m_pendingReadbackFrameValues.assign( targetCount, 0 );
+
+	for( auto i = 0u; i < targetCount; i++ )
+	{
+		createImage(
+			m_vkSwapchainExtent.width, m_vkSwapchainExtent.height, 1,
+			vk::SampleCountFlagBits::e1,
+			m_vkSwapchainImageFormat, vk::ImageTiling::eOptimal,
+			vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			vk::SharingMode::eExclusive,
+			m_swapchainImages[i], m_offscreenImageAllocations[i]
+		);
+		m_swapchainImageViews[i] = createImageView( m_swapchainImages[i], m_vkSwapchainImageFormat, vk::ImageAspectFlagBits::eColor, 1 );
+
+		vk::BufferCreateInfo bufferInfo{};
+		bufferInfo.size = readbackSize;
+		bufferInfo.usage = vk::BufferUsageFlagBits::eTransferDst;
+		bufferInfo.sharingMode = vk::SharingMode::eExclusive;
+
+		m_vkReadbackBuffers[i] = m_vkLogicalDevice.createBuffer( bufferInfo );
+
+		vk::MemoryRequirements memRequirements = m_vkLogicalDevice.getBufferMemoryRequirements( m_vkReadbackBuffers[i] );
+
+		// the host reads every byte back, cached memory keeps those reads off uncached write combined pages
+		m_readbackBufferAllocations[i] = m_upMemoryAllocator->allocate(
+			memRequirements,
+			findMemoryType( memRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, vk::MemoryPropertyFlagBits::eHostCached ),
+			vkrender::AllocationResourceType::eLinear
+		);
+
+		m_vkLogicalDevice.bindBufferMemory( m_vkReadbackBuffers[i], m_readbackBufferAllocations[i].m_memory, m_readbackBufferAllocations[i].m_offset );
+	}
+
+	LOG_INFO( fmt::format("Headless Offscreen Targets created, {} images of {}x{}", targetCount, m_vkSwapchainExtent.width, m_vkSwapchainExtent.height) );
+}
+
+void VulkanApplication::destroyOffscreenTargets()
+{
+	for( auto i = 0u; i < m_swapchainImages.size(); i++ )
+	{
+		m_vkLogicalDevice.destroyImage( m_swapchainImages[i] );
+		m_upMemoryAllocator->free( m_offscreenImageAllocations[i] );
+	}
+	m_swapchainImages.clear();
+	m_offscreenImageAllocations.clear();
+
+	for( auto i = 0u; i < m_vkReadbackBuffers.size(); i++ )
+	{
+		m_vkLogicalDevice.destroyBuffer( m_vkReadbackBuffers[i] );
+		m_upMemoryAllocator->free( m_readbackBufferAllocations[i] );
+	}
+	m_vkReadbackBuffers.clear();
+	m_readbackBufferAllocations.clear();
+	m_pendingReadbackFrameValues.clear();
+}
+
+void VulkanApplication::recordReadbackCopy( vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& imageIndex )
+{
+	// the render pass already left the resolve target in transfer src layout, only the resolve writes need to land
+	vk::ImageMemoryBarrier imgBarrier{};
+	imgBarrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+	imgBarrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+	imgBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imgBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imgBarrier.image = m_swapchainImages[imageIndex];
+	imgBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+	imgBarrier.subresourceRange.baseMipLevel = 0;
+	imgBarrier.subresourceRange.levelCount = 1;
+	imgBarrier.subresourceRange.baseArrayLayer = 0;
+	imgBarrier.subresourceRange.layerCount = 1;
+	imgBarrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+	imgBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+
+	vkCommandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {},
+		0, nullptr,
+		0, nullptr,
+		1, &imgBarrier
+	);
+
+	vk::BufferImageCopy copyRegion{};
+	copyRegion.bufferOffset = 0;
+	copyRegion.bufferRowLength = 0;
+	copyRegion.bufferImageHeight = 0;
+	copyRegion.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+	copyRegion.imageSubresource.mipLevel = 0;
+	copyRegion.imageSubresource.baseArrayLayer = 0;
+	copyRegion.imageSubresource.layerCount = 1;
+	copyRegion.imageOffset = vk::Offset3D{ 0, 0, 0 };
+	copyRegion.imageExtent = vk::Extent3D{ m_vkSwapchainExtent.width, m_vkSwapchainExtent.height, 1 };
+
+	vkCommandBuffer.copyImageToBuffer( m_swapchainImages[imageIndex], vk::ImageLayout::eTransferSrcOptimal, m_vkReadbackBuffers[imageIndex], 1, &copyRegion );
+
+	vk::BufferMemoryBarrier bufBarrier{};
+	bufBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	bufBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+	bufBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufBarrier.buffer = m_vkReadbackBuffers[imageIndex];
+	bufBarrier.offset = 0;
+	bufBarrier.size = VK_WHOLE_SIZE;
+
+	vkCommandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+		0, nullptr,
+		1, &bufBarrier,
+		0, nullptr
+	);
+}
+
+void VulkanApplication::deliverReadback( const std::uint32_t& frameSlot )
+{
+	// callers wait for the slot's previous frame first, the buffer is coherent so no invalidate is needed
+	std::uint64_t frameValue = m_pendingReadbackFrameValues[frameSlot];
+	if( frameValue == 0 )
+		return;
+
+	m_pendingReadbackFrameValues[frameSlot] = 0;
+	onFrameReadback(
+		static_cast<const std::uint8_t*>( m_readbackBufferAllocations[frameSlot].m_pMappedData ),
+		m_vkSwapchainExtent.width, m_vkSwapchainExtent.height,
+		frameValue
+	);
+}
+
+void VulkanApplication::drainReadbacks()
+{
+	if( !m_rendererSettings.m_bHeadless )
+		return;
+
+	// the slot about to be reused holds the oldest frame, walking forward from it keeps submission order
+	std::uint32_t slotCount = static_cast<std::uint32_t>( m_pendingReadbackFrameValues.size() );
+	for( auto i = 0u; i < slotCount; i++ )
+	{
+		deliverReadback( ( m_currentFrame + i ) % slotCount );
+	}
+}
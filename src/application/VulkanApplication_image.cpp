@@ -30,22 +30,10 @@ void VulkanApplication::createTextureImage()
 
 	vk::DeviceSize imageSize = texWidth * texHeight * 4;
 
-	vk::Buffer stagingBuffer;
-	vk::DeviceMemory stagingBufferMemory;
-	vk::SharingMode stagingBufferSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
-	createBuffer( 
-		imageSize, 
-		vk::BufferUsageFlagBits::eTransferSrc,
-		stagingBufferSharingMode,
-		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-		stagingBuffer,
-		stagingBufferMemory
-	);
-
+	vk::SharingMode imageSharingMode = m_bHasExclusiveTransferQueue ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+	vkrender::VulkanStagingArena::Slice stagingSlice = acquireStagingMemory( imageSize );
 
-	void* bufferMappedData = m_vkLogicalDevice.mapMemory( stagingBufferMemory, 0, imageSize );
-	std::memcpy(bufferMappedData, pixels, static_cast<std::size_t>(imageSize) );
-	m_vkLogicalDevice.unmapMemory(stagingBufferMemory);
+	std::memcpy( stagingSlice.m_pMappedData, pixels, static_cast<std::size_t>(imageSize) );
 
 	stbi_image_free(pixels);
 
@@ -55,25 +43,23 @@ void VulkanApplication::createTextureImage()
 		vk::Format::eR8G8B8A8Srgb, vk::ImageTiling::eOptimal,
 		vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
 		vk::MemoryPropertyFlagBits::eDeviceLocal,
-		m_vkTextureImage, m_vkTextureImageMemory
-	);
-
-	transitionImageLayout( 
-		m_vkTextureImage, vk::Format::eR8G8B8A8Srgb, 
-		vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-		m_imageMiplevels
+		imageSharingMode,
+		m_vkTextureImage, m_textureImageAllocation
 	);
 
+	// the layout transition to transfer dst is recorded with the copy on the transfer queue
 	copyBufferToImage( 
-		stagingBuffer, m_vkTextureImage, 
+		stagingSlice.m_vkBuffer, m_vkTextureImage, 
 		static_cast<std::uint32_t>( texWidth ), 
-		static_cast<std::uint32_t>( texHeight )
+		static_cast<std::uint32_t>( texHeight ),
+		m_imageMiplevels,
+		stagingSlice.m_offset
 	);
 
-	generateMipmaps( m_vkTextureImage, vk::Format::eR8G8B8A8Srgb, texWidth, texHeight, m_imageMiplevels);
+	if( !m_bBatchInitSubmissions )
+		submitPendingUploads();
 
-	m_vkLogicalDevice.destroyBuffer( stagingBuffer, nullptr );
-	m_vkLogicalDevice.freeMemory( stagingBufferMemory, nullptr );
+	generateMipmaps( m_vkTextureImage, vk::Format::eR8G8B8A8Srgb, texWidth, texHeight, m_imageMiplevels);
 }
 
 void VulkanApplication::createTextureImageView()
@@ -87,7 +73,6 @@ void VulkanApplication::createTextureImageView()
 
 void VulkanApplication::createTextureSampler()
 {
-	vk::PhysicalDeviceProperties phyDeviceProp = m_vkPhysicalDevice.getProperties(); 
 
 	vk::SamplerCreateInfo samplerCreateInfo{};
 	samplerCreateInfo.magFilter = vk::Filter::eLinear;
@@ -96,7 +81,7 @@ void VulkanApplication::createTextureSampler()
 	samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
 	samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
 	samplerCreateInfo.anisotropyEnable = VK_TRUE;
-	samplerCreateInfo.maxAnisotropy = phyDeviceProp.limits.maxSamplerAnisotropy;
+	samplerCreateInfo.maxAnisotropy = m_deviceCapabilities.getLimits().maxSamplerAnisotropy;
 	samplerCreateInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
 	samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 	samplerCreateInfo.compareEnable = VK_FALSE;
@@ -114,7 +99,8 @@ void VulkanApplication::createImage(
 	const vk::SampleCountFlagBits& numOfSamples,
     const vk::Format& format, const vk::ImageTiling& tiling,
     const vk::ImageUsageFlags& usageFlags, const vk::MemoryPropertyFlags& memPropFlags,
-    vk::Image& image, vk::DeviceMemory& imageMemory
+	const vk::SharingMode& imageSharingMode,
+    vk::Image& image, vkrender::VulkanAllocation& imageAllocation
 )
 {
 	vk::ImageCreateInfo imageCreateInfo{};
@@ -128,21 +114,28 @@ void VulkanApplication::createImage(
 	imageCreateInfo.tiling = tiling;
 	imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
 	imageCreateInfo.usage = usageFlags;
-	imageCreateInfo.sharingMode = vk::SharingMode::eExclusive;
+	imageCreateInfo.sharingMode = imageSharingMode;
 	imageCreateInfo.samples = numOfSamples;
 	imageCreateInfo.flags = {};
 
+	if( imageSharingMode == vk::SharingMode::eConcurrent )
+	{
+		const std::vector<std::uint32_t>& queueFamilyToShare = m_deviceCapabilities.getSharedQueueFamilies();
+		imageCreateInfo.pQueueFamilyIndices = queueFamilyToShare.data();
+		imageCreateInfo.queueFamilyIndexCount = static_cast<std::uint32_t>( queueFamilyToShare.size() );
+	}
+
 	image = m_vkLogicalDevice.createImage( imageCreateInfo );
 
 	vk::MemoryRequirements memRequirements = m_vkLogicalDevice.getImageMemoryRequirements( image );
 	
-	vk::MemoryAllocateInfo allocInfo{};
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType( memRequirements.memoryTypeBits, memPropFlags );
-
-	imageMemory = m_vkLogicalDevice.allocateMemory( allocInfo );
+	imageAllocation = m_upMemoryAllocator->allocate(
+		memRequirements,
+		findMemoryType( memRequirements.memoryTypeBits, memPropFlags ),
+		tiling == vk::ImageTiling::eOptimal ? vkrender::AllocationResourceType::eNonLinear : vkrender::AllocationResourceType::eLinear
+	);
 
-	m_vkLogicalDevice.bindImageMemory( image, imageMemory, 0 );
+	m_vkLogicalDevice.bindImageMemory( image, imageAllocation.m_memory, imageAllocation.m_offset );
 }
 
 vk::ImageView VulkanApplication::createImageView( 
@@ -180,9 +173,7 @@ void VulkanApplication::generateMipmaps(
     const std::uint32_t& mipLevels
 )
 {
-	vk::FormatProperties formatProps = m_vkPhysicalDevice.getFormatProperties(
-		imgFormat
-	);
+	const vk::FormatProperties& formatProps = m_deviceCapabilities.getFormatProperties( imgFormat );
 
 	if( !( formatProps.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear ) )
 	{
@@ -194,7 +185,8 @@ void VulkanApplication::generateMipmaps(
 	std::int32_t mipImgWidth = texWidth;
 	std::int32_t mipImgHeight = texHeight;
 
-	vk::CommandBuffer cmdBuf = beginSingleTimeCommands( m_vkGraphicsCommandPool );
+	setupConfigCommandBuffer();
+	vk::CommandBuffer& cmdBuf = m_vkConfigCommandBuffer;
 
 	vk::ImageMemoryBarrier imgBarrier{};
 	imgBarrier.image = image;
@@ -280,5 +272,5 @@ void VulkanApplication::generateMipmaps(
 		1, &imgBarrier
 	);
 
-	endSingleTimeCommands( m_vkGraphicsCommandPool, cmdBuf, m_vkGraphicsQueue );
+	flushConfigCommandBuffer();
 }
\ No newline at end of file
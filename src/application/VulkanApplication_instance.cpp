@@ -22,7 +22,11 @@ void VulkanApplication::createInstance()
 
 	vk::InstanceCreateInfo instanceCreateInfo{};
 	instanceCreateInfo.pApplicationInfo = &applicationInfo;
-	m_instanceExtensionContainer = Window::populateAvailableExtensions();
+	// headless runs never create a surface, so glfw is not initialised for its surface extensions
+	if( m_rendererSettings.m_bHeadless )
+		m_instanceExtensionContainer.clear();
+	else
+		m_instanceExtensionContainer = Window::populateAvailableExtensions();
 	if( ENABLE_VALIDATION_LAYER )
 	{
 		m_instanceExtensionContainer.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -2,9 +2,9 @@
 #include "utilities/VulkanLogger.h"
 
 vk::SurfaceFormatKHR chooseSwapSurfaceFormat( const vkrender::SwapChainSupportDetails& swapChainSupportDetails );
-vk::PresentModeKHR chooseSwapPresentMode( const vkrender::SwapChainSupportDetails& swapChainSupportDetails );
+vk::PresentModeKHR chooseSwapPresentMode( const vkrender::SwapChainSupportDetails& swapChainSupportDetails, const vkrender::PresentModePolicy& presentModePolicy );
 vk::Extent2D chooseSwapExtent( const vkrender::SwapChainSupportDetails& swapChainSupportDetails, const vkrender::Window& window );
-std::uint32_t chooseImageCount( const vkrender::SwapChainSupportDetails& swapChainSupportDetails );
+std::uint32_t chooseImageCount( const vkrender::SwapChainSupportDetails& swapChainSupportDetails, const std::uint32_t& requestedImageCount );
 
 vk::SurfaceFormatKHR chooseSwapSurfaceFormat( const vkrender::SwapChainSupportDetails& swapChainSupportDetails )
 {
@@ -18,15 +18,33 @@ vk::SurfaceFormatKHR chooseSwapSurfaceFormat( const vkrender::SwapChainSupportDe
     return swapChainSupportDetails.surfaceFormats[0];
 }
 
-vk::PresentModeKHR chooseSwapPresentMode( const vkrender::SwapChainSupportDetails& swapChainSupportDetails )
+vk::PresentModeKHR chooseSwapPresentMode( const vkrender::SwapChainSupportDetails& swapChainSupportDetails, const vkrender::PresentModePolicy& presentModePolicy )
 {
+    vk::PresentModeKHR requestedPresentMode = vk::PresentModeKHR::eFifo;
+    switch( presentModePolicy )
+    {
+    case vkrender::PresentModePolicy::eImmediate:
+        requestedPresentMode = vk::PresentModeKHR::eImmediate;
+        break;
+    case vkrender::PresentModePolicy::eMailbox:
+        requestedPresentMode = vk::PresentModeKHR::eMailbox;
+        break;
+    case vkrender::PresentModePolicy::eFifoRelaxed:
+        requestedPresentMode = vk::PresentModeKHR::eFifoRelaxed;
+        break;
+    default:
+        break;
+    }
+
     for( const auto& availablePresentMode : swapChainSupportDetails.presentModes )
     {
-        if( availablePresentMode == vk::PresentModeKHR::eMailbox )
+        if( availablePresentMode == requestedPresentMode )
         {
             return availablePresentMode;
         }
     }
+
+    LOG_INFO( fmt::format("Present mode {} is not supported by the surface, falling back to fifo", vk::to_string( requestedPresentMode )) );
     return vk::PresentModeKHR::eFifo;
 }
 
@@ -53,10 +71,11 @@ vk::Extent2D chooseSwapExtent( const vkrender::SwapChainSupportDetails& swapChai
     }
 }
  
-std::uint32_t chooseImageCount( const vkrender::SwapChainSupportDetails& swapChainSupportDetails )
+std::uint32_t chooseImageCount( const vkrender::SwapChainSupportDetails& swapChainSupportDetails, const std::uint32_t& requestedImageCount )
 {
-    std::uint32_t imageCount = swapChainSupportDetails.capabilities.minImageCount + 1; // always ask for minImageCount + 1
+    std::uint32_t imageCount = requestedImageCount > 0 ? requestedImageCount : swapChainSupportDetails.capabilities.minImageCount + 1; // default to minImageCount + 1
 
+    imageCount = std::max( imageCount, swapChainSupportDetails.capabilities.minImageCount );
     if( swapChainSupportDetails.capabilities.maxImageCount > 0 && imageCount > swapChainSupportDetails.capabilities.maxImageCount )
     {
         imageCount = swapChainSupportDetails.capabilities.maxImageCount;
@@ -73,11 +92,11 @@ void VulkanApplication::createSwapchain()
 
     const vk::SurfaceCapabilitiesKHR& capabilities = swapChainSupportDetails.capabilities;
     vk::SurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat( swapChainSupportDetails );
-    std::uint32_t imageCount = chooseImageCount( swapChainSupportDetails );
+    std::uint32_t imageCount = chooseImageCount( swapChainSupportDetails, m_rendererSettings.m_swapchainImageCount );
     vk::Extent2D imageExtent = chooseSwapExtent( swapChainSupportDetails, m_window );
-    vk::PresentModeKHR presentMode = chooseSwapPresentMode( swapChainSupportDetails );
+    vk::PresentModeKHR presentMode = chooseSwapPresentMode( swapChainSupportDetails, m_rendererSettings.m_presentModePolicy );
 
-	vkrender::QueueFamilyIndices queueFamilyIndices = findQueueFamilyIndices( m_vkPhysicalDevice, &m_vkSurface );
+	const vkrender::QueueFamilyIndices& queueFamilyIndices = m_deviceCapabilities.getQueueFamilyIndices();
 	std::vector<std::uint32_t> queueFamilyContainer;
     if( queueFamilyIndices.m_graphicsFamily.value() != queueFamilyIndices.m_presentFamily.value() )
     {
@@ -108,14 +127,54 @@ void VulkanApplication::createSwapchain()
     vkSwapChainCreateInfo.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
     vkSwapChainCreateInfo.presentMode = presentMode;
     vkSwapChainCreateInfo.clipped = VK_TRUE;
-    vkSwapChainCreateInfo.oldSwapchain = nullptr;
+    // hands in flight presentation over to the new swapchain instead of tearing it down first
+    vkSwapChainCreateInfo.oldSwapchain = m_vkSwapchain;
 	
+	vk::SwapchainKHR oldSwapchain = m_vkSwapchain;
 	m_vkSwapchain = m_vkLogicalDevice.createSwapchainKHR( vkSwapChainCreateInfo );
+	if( oldSwapchain )
+	{
+		// a completed frame says nothing about the presentation engine being done with the old images. Without
+		// VK_EXT_swapchain_maintenance1 present fences the closest signal is the new swapchain having cycled
+		// framesInFlight frames, each of which had to acquire from it
+		m_upDeletionQueue->retire( m_submittedFrameValue + m_rendererSettings.m_framesInFlight, [this, oldSwapchain]() {
+			m_vkLogicalDevice.destroySwapchainKHR( oldSwapchain );
+		} );
+	}
 	m_swapchainImages = m_vkLogicalDevice.getSwapchainImagesKHR( m_vkSwapchain );
 	m_vkSwapchainImageFormat = surfaceFormat.format;
 	m_vkSwapchainExtent = imageExtent;
+	m_vkPresentMode = presentMode;
+	m_upFramePacer->setSwapchain( m_vkSwapchain );
+
+	LOG_INFO( fmt::format("Swapchain Created with {} images, present mode {}", m_swapchainImages.size(), vk::to_string( presentMode )) );
+}
+
+bool VulkanApplication::acquireSwapchainImage( std::uint32_t& imageIndex )
+{
+	TRACE_SCOPE( "acquire" );
+	vk::ResultValue<std::uint32_t> opImageAcquistion = this->swapchainNextImageWrapper(
+		m_vkLogicalDevice,
+		m_vkSwapchain, 
+		std::numeric_limits<std::uint64_t>::max(),
+		m_vkImageAvailableSemaphores[m_currentFrame],
+		nullptr
+	);
+
+	if( opImageAcquistion.result == vk::Result::eErrorOutOfDateKHR )
+	{
+		recreateSwapChain();
+		return false;
+	}
+	else if( opImageAcquistion.result != vk::Result::eSuccess && opImageAcquistion.result != vk::Result::eSuboptimalKHR )
+	{
+		std::string errorMsg = "FAILED TO ACQUIRE SWAPCHAIN IMAGE TO START RENDERING";
+		LOG_ERROR(errorMsg);
+		throw std::runtime_error( errorMsg );
+	}
 
-	LOG_INFO("Swapchain Created");
+	imageIndex = opImageAcquistion.value;
+	return true;
 }
 
 void VulkanApplication::createSwapChainImageViews()
@@ -133,27 +192,41 @@ void VulkanApplication::createSwapChainImageViews()
 
 void VulkanApplication::recreateSwapChain()
 {
+	// blocks while minimised
 	m_window.getFrameBufferSize();
-	m_vkLogicalDevice.waitIdle();
 
-	destroySwapChain();
+	retireOnFrameCompletion( [this, frameBuffers = std::move(m_swapchainFrameBuffers), imageViews = std::move(m_swapchainImageViews)]() {
+		for( const auto& vkFramebuffer : frameBuffers )
+		{
+			m_vkLogicalDevice.destroyFramebuffer( vkFramebuffer );
+		}
+
+		for( const auto& vkImageView : imageViews )
+		{
+			m_vkLogicalDevice.destroyImageView( vkImageView );
+		}
+	} );
+	m_swapchainFrameBuffers.clear();
+	m_swapchainImageViews.clear();
 	
 	createSwapchain();
 	createSwapChainImageViews();
 	createColorResources();
 	createDepthResources();
-	createFrameBuffers();	
+	if( !m_bDynamicRendering )
+		createFrameBuffers();
+	invalidateRecordedCommandBuffers( "swapchain recreation" );
 }
 
 void VulkanApplication::destroySwapChain()
 {
 	m_vkLogicalDevice.destroyImageView( m_vkColorImageView );
 	m_vkLogicalDevice.destroyImage( m_vkColorImage );
-	m_vkLogicalDevice.freeMemory( m_vkColorImageMemory );
+	m_upMemoryAllocator->free( m_colorImageAllocation );
 
 	m_vkLogicalDevice.destroyImageView( m_vkDepthImageView );
 	m_vkLogicalDevice.destroyImage( m_vkDepthImage );
-	m_vkLogicalDevice.freeMemory( m_vkDepthImageMemory );
+	m_upMemoryAllocator->free( m_depthImageAllocation );
 
 	for( auto& vkFramebuffer : m_swapchainFrameBuffers )
 	{
@@ -167,42 +240,69 @@ void VulkanApplication::destroySwapChain()
 	m_swapchainFrameBuffers.clear();
 	m_swapchainImageViews.clear();
 
-	m_vkLogicalDevice.destroySwapchainKHR( m_vkSwapchain );
+	if( m_rendererSettings.m_bHeadless )
+		destroyOffscreenTargets();
+	else
+		m_vkLogicalDevice.destroySwapchainKHR( m_vkSwapchain );
 }
 
 void VulkanApplication::createColorResources()
 {
 	vk::Format colorFormat = m_vkSwapchainImageFormat;
 
+	if( m_vkColorImage )
+	{
+		// framebuffers may be smaller than their attachments, keep the target while the window shrinks
+		if( colorFormat == m_colorTargetFormat && m_vkSwapchainExtent.width <= m_colorTargetExtent.width && m_vkSwapchainExtent.height <= m_colorTargetExtent.height )
+			return;
+
+		retireOnFrameCompletion( [this, colorImage = m_vkColorImage, colorImageView = m_vkColorImageView, colorImageAllocation = m_colorImageAllocation]() mutable {
+			m_vkLogicalDevice.destroyImageView( colorImageView );
+			m_vkLogicalDevice.destroyImage( colorImage );
+			m_upMemoryAllocator->free( colorImageAllocation );
+		} );
+	}
+
 	createImage(
 		m_vkSwapchainExtent.width, m_vkSwapchainExtent.height, 1,
 		m_msaaSampleCount, 
 		colorFormat, vk::ImageTiling::eOptimal,
 		vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
 		vk::MemoryPropertyFlagBits::eDeviceLocal,
-		m_vkColorImage, m_vkColorImageMemory
+		vk::SharingMode::eExclusive,
+		m_vkColorImage, m_colorImageAllocation
 	);
 
 	m_vkColorImageView = createImageView( m_vkColorImage, colorFormat, vk::ImageAspectFlagBits::eColor, 1 );
+	m_colorTargetExtent = m_vkSwapchainExtent;
+	m_colorTargetFormat = colorFormat;
 }
 
 void VulkanApplication::createDepthResources()
 {
 	vk::Format depthFormat = findDepthFormat();
 
+	if( m_vkDepthImage )
+	{
+		if( m_vkSwapchainExtent.width <= m_depthTargetExtent.width && m_vkSwapchainExtent.height <= m_depthTargetExtent.height )
+			return;
+
+		retireOnFrameCompletion( [this, depthImage = m_vkDepthImage, depthImageView = m_vkDepthImageView, depthImageAllocation = m_depthImageAllocation]() mutable {
+			m_vkLogicalDevice.destroyImageView( depthImageView );
+			m_vkLogicalDevice.destroyImage( depthImage );
+			m_upMemoryAllocator->free( depthImageAllocation );
+		} );
+	}
+
 	createImage(
 		m_vkSwapchainExtent.width, m_vkSwapchainExtent.height, 1, m_msaaSampleCount,
 		depthFormat, vk::ImageTiling::eOptimal, 
 		vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::MemoryPropertyFlagBits::eDeviceLocal,
-		m_vkDepthImage, m_vkDepthImageMemory
+		vk::SharingMode::eExclusive,
+		m_vkDepthImage, m_depthImageAllocation
 	);
 	m_vkDepthImageView = createImageView( m_vkDepthImage, depthFormat, vk::ImageAspectFlagBits::eDepth, 1);
-
-	transitionImageLayout( 
-		m_vkDepthImage, depthFormat, 
-		vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal,
-		1
-	);
+	m_depthTargetExtent = m_vkSwapchainExtent;
 
 	LOG_INFO("Depth Resources Created");
 }
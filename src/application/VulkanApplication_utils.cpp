@@ -4,37 +4,6 @@
 
 #include <fstream>
 
-vk::CommandBuffer VulkanApplication::beginSingleTimeCommands( const vk::CommandPool& commandPoolToAllocFrom )
-{
-	vk::CommandBufferAllocateInfo allocInfo{};
-	allocInfo.level = vk::CommandBufferLevel::ePrimary;
-	allocInfo.commandPool = commandPoolToAllocFrom;
-	allocInfo.commandBufferCount = 1;
-
-	vk::CommandBuffer commandBuffer = m_vkLogicalDevice.allocateCommandBuffers(allocInfo)[0];
-
-	vk::CommandBufferBeginInfo beginInfo{};
-	beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-
-	commandBuffer.begin( beginInfo );
-
-	return commandBuffer;
-}
-
-void VulkanApplication::endSingleTimeCommands( const vk::CommandPool& commandPoolAllocFrom, vk::CommandBuffer vkCommandBuffer, vk::Queue queueToSubmitOn )
-{
-	vkCommandBuffer.end();
-
-	vk::SubmitInfo submitInfo{};
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &vkCommandBuffer;
-
-	vk::Result opResult = queueToSubmitOn.submit( 1, &submitInfo, nullptr );
-	queueToSubmitOn.waitIdle();
-
-	m_vkLogicalDevice.freeCommandBuffers( commandPoolAllocFrom, 1, &vkCommandBuffer );
-}
-
 void VulkanApplication::transitionImageLayout( 
     const vk::Image& image, const vk::Format& format, 
     const vk::ImageLayout& oldLayout, const vk::ImageLayout& newLayout,
@@ -229,7 +198,7 @@ vk::Format VulkanApplication::findSupportedImgFormat( const std::initializer_lis
 {
 	for( const vk::Format& format : candidates )
 	{
-		vk::FormatProperties prop = m_vkPhysicalDevice.getFormatProperties( format );
+		const vk::FormatProperties& prop = m_deviceCapabilities.getFormatProperties( format );
 
 		if( tiling == vk::ImageTiling::eLinear && (prop.linearTilingFeatures & features) == features )
 		{
@@ -259,48 +228,25 @@ bool VulkanApplication::hasStencilComponent( const vk::Format& format ) const
 	return format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint;
 }
 
-std::uint32_t VulkanApplication::findMemoryType( const std::uint32_t& typeFilter, const vk::MemoryPropertyFlags& propertyFlags )
+std::uint32_t VulkanApplication::findMemoryType( const std::uint32_t& typeFilter, const vk::MemoryPropertyFlags& propertyFlags, const vk::MemoryPropertyFlags& preferredFlags )
 {
-	vk::PhysicalDeviceMemoryProperties memoryProps = m_vkPhysicalDevice.getMemoryProperties();
-
-	for( auto i = 0u; i < memoryProps.memoryTypeCount; i++ )
-	{
-		if( 
-			( typeFilter & ( 1u << i ) ) &&
-			( memoryProps.memoryTypes[i].propertyFlags & propertyFlags ) == propertyFlags 
-		)
-		{
-			return i;
-		}
-	}
-
-	// TODO throw exception
+	return m_deviceCapabilities.findMemoryType( typeFilter, propertyFlags, preferredFlags );
 }
 
-void VulkanApplication::copyBuffer( const vk::Buffer& srcBuffer, const vk::Buffer& dstBuffer, const vk::DeviceSize& sizeInBytes )
+void VulkanApplication::copyBuffer( const vk::Buffer& srcBuffer, const vk::Buffer& dstBuffer, const vk::DeviceSize& sizeInBytes, const vk::DeviceSize& srcOffset )
 {
-	vk::CommandBuffer transferCmdBuf = beginSingleTimeCommands( m_vkTransferCommandPool );
-
 	vk::BufferCopy copyRegion{};
-	copyRegion.srcOffset = 0;
+	copyRegion.srcOffset = srcOffset;
 	copyRegion.dstOffset = 0;
 	copyRegion.size = sizeInBytes;
 
-	vk::ArrayProxy<const vk::BufferCopy> copyRegionArray{
-		copyRegion
-	};
-
-	transferCmdBuf.copyBuffer( srcBuffer, dstBuffer, copyRegionArray );
-
-	endSingleTimeCommands( m_vkTransferCommandPool, transferCmdBuf, m_vkTransferQueue );
+	m_upUploadManager->enqueueBufferCopy( srcBuffer, dstBuffer, copyRegion );
 }
 
-void VulkanApplication::copyBufferToImage( const vk::Buffer& srcBuffer, const vk::Image& dstImage, const std::uint32_t& width, const std::uint32_t& height )
+void VulkanApplication::copyBufferToImage( const vk::Buffer& srcBuffer, const vk::Image& dstImage, const std::uint32_t& width, const std::uint32_t& height, const std::uint32_t& mipmapLevels, const vk::DeviceSize& bufferOffset )
 {
-	vk::CommandBuffer cmdBuf = beginSingleTimeCommands( m_vkTransferCommandPool );
-
 	vk::BufferImageCopy copyRegion{};
-	copyRegion.bufferOffset = 0;
+	copyRegion.bufferOffset = bufferOffset;
 	copyRegion.bufferRowLength = 0;
 	copyRegion.bufferImageHeight = 0;
 
@@ -312,23 +258,10 @@ void VulkanApplication::copyBufferToImage( const vk::Buffer& srcBuffer, const vk
 	copyRegion.imageOffset = vk::Offset3D{ 0, 0, 0 };
 	copyRegion.imageExtent = vk::Extent3D{ width, height, 1 };
 
-	cmdBuf.copyBufferToImage( srcBuffer, dstImage, vk::ImageLayout::eTransferDstOptimal, 1, &copyRegion );
-
-	endSingleTimeCommands(m_vkTransferCommandPool, cmdBuf, m_vkTransferQueue );
+	m_upUploadManager->enqueueBufferToImageCopy( srcBuffer, dstImage, copyRegion, mipmapLevels );
 }
 
 vk::SampleCountFlagBits VulkanApplication::getMaxUsableSampleCount()
 {
-	vk::PhysicalDeviceProperties physicalDeviceProps = m_vkPhysicalDevice.getProperties();
-
-	vk::SampleCountFlags counts = physicalDeviceProps.limits.framebufferColorSampleCounts & physicalDeviceProps.limits.framebufferDepthSampleCounts;
-
-	if( counts & vk::SampleCountFlagBits::e64 ) { return vk::SampleCountFlagBits::e64; }
-	if( counts & vk::SampleCountFlagBits::e32 ) { return vk::SampleCountFlagBits::e32; }
-	if( counts & vk::SampleCountFlagBits::e16 ) { return vk::SampleCountFlagBits::e16; }
-	if( counts & vk::SampleCountFlagBits::e8 ) { return vk::SampleCountFlagBits::e8; }
-	if( counts & vk::SampleCountFlagBits::e4 ) { return vk::SampleCountFlagBits::e4; }
-	if( counts & vk::SampleCountFlagBits::e2 ) { return vk::SampleCountFlagBits::e2; }
-
-	return vk::SampleCountFlagBits::e1;
+	return m_deviceCapabilities.getMaxUsableSampleCount();
 }
\ No newline at end of file
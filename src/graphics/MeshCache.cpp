@@ -0,0 +1,243 @@
+#include "graphics/MeshCache.h"
+#include "utilities/VulkanLogger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace graphics
+{
+	namespace
+	{
+		constexpr std::uint32_t MESH_CACHE_MAGIC = 0x434d4b56; // "VKMC"
+		// vertex and index arrays start on this boundary, well past what either type needs
+		constexpr std::uint64_t DATA_ALIGNMENT = 16;
+
+		constexpr std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+		constexpr std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+		struct MeshCacheHeader
+		{
+			std::uint32_t	m_magic;
+			std::uint32_t	m_version;
+			std::uint64_t	m_sourceHash;
+			std::uint32_t	m_vertexStride;
+			std::uint32_t	m_indexStride;
+			std::uint64_t	m_vertexCount;
+			std::uint64_t	m_indexCount;
+			std::uint64_t	m_vertexOffset;
+			std::uint64_t	m_indexOffset;
+			float			m_boundsMin[3];
+			float			m_boundsMax[3];
+			float			m_weldEpsilon;
+			std::uint32_t	m_optimizeMode;
+			std::uint32_t	m_vertexLayoutSignature;
+			float			m_positionOffset[3];
+			float			m_positionScale[3];
+		};
+
+		std::uint64_t alignUp( const std::uint64_t& value, const std::uint64_t& alignment )
+		{
+			return ( value + alignment - 1 ) & ~( alignment - 1 );
+		}
+	}
+
+	MeshCache::LoadResult MeshCache::open( const std::filesystem::path& cacheFilePath, const MeshCacheKey& cacheKey )
+	{
+		close();
+
+		if( !m_mappedFile.open( cacheFilePath ) )
+			return LoadResult::eMissing;
+
+		const std::size_t fileSize = m_mappedFile.getSize();
+		if( fileSize < sizeof(MeshCacheHeader) )
+		{
+			close();
+			return LoadResult::eRejected;
+		}
+
+		// the mapping is page aligned, the copy only keeps the read free of aliasing concerns
+		MeshCacheHeader header;
+		std::memcpy( &header, m_mappedFile.getData(), sizeof(header) );
+
+		bool bCompatible =
+			header.m_magic == MESH_CACHE_MAGIC &&
+			header.m_version == FORMAT_VERSION &&
+			header.m_vertexStride == GpuVertexLayout::STRIDE &&
+			header.m_vertexLayoutSignature == GpuVertexLayout::SIGNATURE &&
+			header.m_indexStride == sizeof(std::uint32_t) &&
+			header.m_vertexOffset % DATA_ALIGNMENT == 0 && header.m_indexOffset % DATA_ALIGNMENT == 0 &&
+			header.m_vertexOffset >= sizeof(MeshCacheHeader) && header.m_vertexOffset <= fileSize &&
+			header.m_indexOffset >= sizeof(MeshCacheHeader) && header.m_indexOffset <= fileSize &&
+			header.m_vertexCount <= ( fileSize - header.m_vertexOffset ) / GpuVertexLayout::STRIDE &&
+			header.m_indexCount <= ( fileSize - header.m_indexOffset ) / sizeof(std::uint32_t);
+		if( !bCompatible )
+		{
+			close();
+			return LoadResult::eRejected;
+		}
+
+		if( header.m_sourceHash != cacheKey.m_sourceHash || header.m_weldEpsilon != cacheKey.m_weldEpsilon ||
+			header.m_optimizeMode != static_cast<std::uint32_t>( cacheKey.m_optimizeMode ) )
+		{
+			close();
+			return LoadResult::eStale;
+		}
+
+		// a corrupt index would have the GPU fetch past the vertex buffer, one pass over the mapping rules that out
+		const std::uint32_t* pIndices = reinterpret_cast<const std::uint32_t*>( m_mappedFile.getData() + header.m_indexOffset );
+		std::uint32_t maxIndex = 0;
+		for( std::uint64_t indexPosition = 0; indexPosition < header.m_indexCount; indexPosition++ )
+			maxIndex = std::max( maxIndex, pIndices[indexPosition] );
+		if( header.m_indexCount > 0 && maxIndex >= header.m_vertexCount )
+		{
+			close();
+			return LoadResult::eRejected;
+		}
+
+		m_pVertexData = m_mappedFile.getData() + header.m_vertexOffset;
+		m_vertexCount = static_cast<std::size_t>( header.m_vertexCount );
+		m_vertexDequantization = VertexDequantization{};
+		for( int axis = 0; axis < 3; axis++ )
+		{
+			m_vertexDequantization.m_positionOffset[axis] = header.m_positionOffset[axis];
+			m_vertexDequantization.m_positionScale[axis] = header.m_positionScale[axis];
+		}
+		m_pIndices = pIndices;
+		m_indexCount = static_cast<std::size_t>( header.m_indexCount );
+		m_boundsMin = glm::vec3{ header.m_boundsMin[0], header.m_boundsMin[1], header.m_boundsMin[2] };
+		m_boundsMax = glm::vec3{ header.m_boundsMax[0], header.m_boundsMax[1], header.m_boundsMax[2] };
+
+		return LoadResult::eLoaded;
+	}
+
+	void MeshCache::close()
+	{
+		m_mappedFile.close();
+		m_pVertexData = nullptr;
+		m_vertexCount = 0;
+		m_pIndices = nullptr;
+		m_indexCount = 0;
+	}
+
+	const std::uint8_t* MeshCache::getVertexData() const
+	{
+		return m_pVertexData;
+	}
+
+	std::size_t MeshCache::getVertexCount() const
+	{
+		return m_vertexCount;
+	}
+
+	const VertexDequantization& MeshCache::getVertexDequantization() const
+	{
+		return m_vertexDequantization;
+	}
+
+	const std::uint32_t* MeshCache::getIndices() const
+	{
+		return m_pIndices;
+	}
+
+	std::size_t MeshCache::getIndexCount() const
+	{
+		return m_indexCount;
+	}
+
+	const glm::vec3& MeshCache::getBoundsMin() const
+	{
+		return m_boundsMin;
+	}
+
+	const glm::vec3& MeshCache::getBoundsMax() const
+	{
+		return m_boundsMax;
+	}
+
+	bool MeshCache::write( const std::filesystem::path& cacheFilePath, const MeshData& meshData, const EncodedVertices& encodedVertices, const MeshCacheKey& cacheKey )
+	{
+		const std::uint64_t vertexBytes = encodedVertices.m_data.size();
+		const std::uint64_t indexBytes = sizeof(std::uint32_t) * meshData.m_indices.size();
+
+		// zeroed as a whole, any padding is written to the file as well
+		MeshCacheHeader header;
+		std::memset( &header, 0, sizeof(header) );
+		header.m_magic = MESH_CACHE_MAGIC;
+		header.m_version = FORMAT_VERSION;
+		header.m_sourceHash = cacheKey.m_sourceHash;
+		header.m_weldEpsilon = cacheKey.m_weldEpsilon;
+		header.m_optimizeMode = static_cast<std::uint32_t>( cacheKey.m_optimizeMode );
+		header.m_vertexStride = GpuVertexLayout::STRIDE;
+		header.m_vertexLayoutSignature = GpuVertexLayout::SIGNATURE;
+		header.m_indexStride = sizeof(std::uint32_t);
+		header.m_vertexCount = encodedVertices.m_vertexCount;
+		header.m_indexCount = meshData.m_indices.size();
+		header.m_vertexOffset = alignUp( sizeof(MeshCacheHeader), DATA_ALIGNMENT );
+		header.m_indexOffset = alignUp( header.m_vertexOffset + vertexBytes, DATA_ALIGNMENT );
+		for( int axis = 0; axis < 3; axis++ )
+		{
+			header.m_boundsMin[axis] = meshData.m_boundsMin[axis];
+			header.m_boundsMax[axis] = meshData.m_boundsMax[axis];
+			header.m_positionOffset[axis] = encodedVertices.m_dequantization.m_positionOffset[axis];
+			header.m_positionScale[axis] = encodedVertices.m_dequantization.m_positionScale[axis];
+		}
+
+		std::error_code fileError;
+		if( cacheFilePath.has_parent_path() )
+			std::filesystem::create_directories( cacheFilePath.parent_path(), fileError );
+
+		std::filesystem::path tempFilePath = cacheFilePath;
+		tempFilePath += ".tmp";
+		{
+			const char padding[DATA_ALIGNMENT] = {};
+			std::ofstream tempFile{ tempFilePath, std::ios::binary | std::ios::trunc };
+			tempFile.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+			tempFile.write( padding, static_cast<std::streamsize>( header.m_vertexOffset - sizeof(header) ) );
+			tempFile.write( reinterpret_cast<const char*>( encodedVertices.m_data.data() ), static_cast<std::streamsize>( vertexBytes ) );
+			tempFile.write( padding, static_cast<std::streamsize>( header.m_indexOffset - header.m_vertexOffset - vertexBytes ) );
+			tempFile.write( reinterpret_cast<const char*>( meshData.m_indices.data() ), static_cast<std::streamsize>( indexBytes ) );
+			if( !tempFile )
+			{
+				LOG_ERROR( fmt::format("Failed to write mesh cache to {}", tempFilePath.string()) );
+				return false;
+			}
+		}
+
+		std::filesystem::rename( tempFilePath, cacheFilePath, fileError );
+		if( fileError )
+		{
+			LOG_ERROR( fmt::format("Failed to replace mesh cache {}: {}", cacheFilePath.string(), fileError.message()) );
+			std::filesystem::remove( tempFilePath, fileError );
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MeshCache::hashSourceFile( const std::filesystem::path& sourceFilePath, std::uint64_t& sourceHash )
+	{
+		utils::MappedFile sourceFile;
+		if( !sourceFile.open( sourceFilePath ) )
+			return false;
+
+		std::uint64_t hash = FNV_OFFSET_BASIS;
+		const std::uint8_t* pData = sourceFile.getData();
+		for( std::size_t byteIndex = 0; byteIndex < sourceFile.getSize(); byteIndex++ )
+		{
+			hash ^= pData[byteIndex];
+			hash *= FNV_PRIME;
+		}
+
+		sourceHash = hash;
+		return true;
+	}
+
+	std::filesystem::path MeshCache::getCacheFilePath( const std::filesystem::path& cacheDirectory, const std::filesystem::path& sourceFilePath )
+	{
+		std::filesystem::path cacheFileName = sourceFilePath.filename();
+		cacheFileName += ".vkmesh";
+		return cacheDirectory / cacheFileName;
+	}
+
+} // namespace graphics
@@ -0,0 +1,385 @@
+#include "graphics/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+namespace graphics
+{
+	namespace
+	{
+		// Forsyth's constants, the scored cache is larger than any hardware one so the order suits all of them
+		constexpr std::uint32_t SCORED_CACHE_SIZE = 32;
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+		constexpr std::uint32_t SCORED_VALENCE_COUNT = 32;
+
+		constexpr std::uint32_t UNUSED_VERTEX = 0xffffffffu;
+
+		struct VertexScoreTables
+		{
+			// indexed by cache position + 1, 0 is outside the cache
+			std::array<float, SCORED_CACHE_SIZE + 1> m_cacheScores;
+			std::array<float, SCORED_VALENCE_COUNT> m_valenceScores;
+
+			VertexScoreTables()
+			{
+				m_cacheScores[0] = 0.0f;
+				for( std::uint32_t cachePosition = 0; cachePosition < SCORED_CACHE_SIZE; cachePosition++ )
+				{
+					// the last triangle's vertices score the same, whichever order they went in
+					m_cacheScores[cachePosition + 1] = cachePosition < 3 ? LAST_TRIANGLE_SCORE :
+						std::pow( 1.0f - static_cast<float>( cachePosition - 3 ) / ( SCORED_CACHE_SIZE - 3 ), CACHE_DECAY_POWER );
+				}
+
+				m_valenceScores[0] = 0.0f;
+				for( std::uint32_t valence = 1; valence < SCORED_VALENCE_COUNT; valence++ )
+					m_valenceScores[valence] = VALENCE_BOOST_SCALE * std::pow( static_cast<float>( valence ), -VALENCE_BOOST_POWER );
+			}
+
+			float getScore( const std::int32_t& cachePosition, const std::uint32_t& remainingValence ) const
+			{
+				// a vertex without triangles left must never attract the next pick
+				if( remainingValence == 0 )
+					return -1.0f;
+
+				float valenceScore = remainingValence < SCORED_VALENCE_COUNT ? m_valenceScores[remainingValence] :
+					VALENCE_BOOST_SCALE * std::pow( static_cast<float>( remainingValence ), -VALENCE_BOOST_POWER );
+				return m_cacheScores[ cachePosition + 1 ] + valenceScore;
+			}
+		};
+
+		// FIFO cache on timestamps, a vertex is cached while fewer than cacheSize misses happened since its own
+		class FifoCacheSimulator
+		{
+		public:
+			FifoCacheSimulator( const std::size_t& vertexCount, const std::uint32_t& cacheSize )
+				: m_timestamps( vertexCount, 0 )
+				, m_cacheSize( cacheSize )
+				, m_time( cacheSize + 1 )
+			{}
+
+			bool access( const std::uint32_t& vertexIndex )
+			{
+				if( m_time - m_timestamps[vertexIndex] <= m_cacheSize )
+					return false;
+				m_timestamps[vertexIndex] = m_time++;
+				return true;
+			}
+
+			std::uint32_t accessTriangle( const std::uint32_t* pTriangle )
+			{
+				return ( access( pTriangle[0] ) ? 1 : 0 ) + ( access( pTriangle[1] ) ? 1 : 0 ) + ( access( pTriangle[2] ) ? 1 : 0 );
+			}
+
+			void flush()
+			{
+				m_time += m_cacheSize + 1;
+			}
+		private:
+			std::vector<std::uint64_t> m_timestamps;
+			std::uint64_t m_cacheSize;
+			std::uint64_t m_time;
+		};
+
+		glm::vec3 getTriangleCross( const std::vector<vertex>& vertices, const std::uint32_t* pTriangle )
+		{
+			const glm::vec3& p0 = vertices[pTriangle[0]].pos;
+			return glm::cross( vertices[pTriangle[1]].pos - p0, vertices[pTriangle[2]].pos - p0 );
+		}
+	}
+
+	VertexCacheStats analyzeVertexCache( const std::vector<std::uint32_t>& indices, const std::size_t& vertexCount, const std::uint32_t& cacheSize )
+	{
+		VertexCacheStats stats;
+		const std::size_t triangleCount = indices.size() / 3;
+		if( triangleCount == 0 )
+			return stats;
+
+		FifoCacheSimulator cache{ vertexCount, cacheSize };
+		std::vector<bool> referenced( vertexCount, false );
+		std::size_t missCount = 0;
+		std::size_t referencedCount = 0;
+		for( const auto& index : indices )
+		{
+			missCount += cache.access( index ) ? 1 : 0;
+			if( !referenced[index] )
+			{
+				referenced[index] = true;
+				referencedCount++;
+			}
+		}
+
+		stats.m_acmr = static_cast<float>( missCount ) / triangleCount;
+		stats.m_atvr = static_cast<float>( missCount ) / referencedCount;
+		return stats;
+	}
+
+	void optimizeVertexCache( std::vector<std::uint32_t>& indices, const std::size_t& vertexCount )
+	{
+		const std::size_t triangleCount = indices.size() / 3;
+		if( triangleCount == 0 )
+			return;
+
+		static const VertexScoreTables scoreTables;
+
+		// triangles of every vertex, the first remainingValence of each range are the ones not emitted yet
+		std::vector<std::uint32_t> remainingValence( vertexCount, 0 );
+		for( const auto& index : indices )
+			remainingValence[index]++;
+
+		std::vector<std::uint32_t> triangleOffsets( vertexCount + 1, 0 );
+		for( std::size_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++ )
+			triangleOffsets[vertexIndex + 1] = triangleOffsets[vertexIndex] + remainingValence[vertexIndex];
+
+		std::vector<std::uint32_t> vertexTriangles( indices.size() );
+		{
+			std::vector<std::uint32_t> fillCounts( vertexCount, 0 );
+			for( std::size_t cornerIndex = 0; cornerIndex < indices.size(); cornerIndex++ )
+			{
+				const std::uint32_t vertexIndex = indices[cornerIndex];
+				vertexTriangles[ triangleOffsets[vertexIndex] + fillCounts[vertexIndex]++ ] = static_cast<std::uint32_t>( cornerIndex / 3 );
+			}
+		}
+
+		std::vector<std::int32_t> cachePositions( vertexCount, -1 );
+		std::vector<float> vertexScores( vertexCount );
+		for( std::size_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++ )
+			vertexScores[vertexIndex] = scoreTables.getScore( -1, remainingValence[vertexIndex] );
+
+		std::vector<float> triangleScores( triangleCount );
+		std::vector<bool> emitted( triangleCount, false );
+		std::size_t bestTriangle = 0;
+		for( std::size_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++ )
+		{
+			const std::uint32_t* pTriangle = &indices[ 3 * triangleIndex ];
+			triangleScores[triangleIndex] = vertexScores[pTriangle[0]] + vertexScores[pTriangle[1]] + vertexScores[pTriangle[2]];
+			if( triangleScores[triangleIndex] > triangleScores[bestTriangle] )
+				bestTriangle = triangleIndex;
+		}
+
+		std::vector<std::uint32_t> optimizedIndices;
+		optimizedIndices.reserve( indices.size() );
+
+		// three more than the scored size, the vertices pushed out by a triangle are rescored before they are dropped
+		std::array<std::uint32_t, SCORED_CACHE_SIZE + 3> cache;
+		std::array<std::uint32_t, SCORED_CACHE_SIZE + 3> nextCache;
+		std::size_t cacheCount = 0;
+		// with nothing cached scores the next pick, the search carries on from the last fallback
+		std::size_t fallbackCursor = 0;
+		bool bHaveBest = true;
+
+		for( std::size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++ )
+		{
+			if( !bHaveBest )
+			{
+				while( emitted[fallbackCursor] )
+					fallbackCursor++;
+				bestTriangle = fallbackCursor;
+			}
+
+			const std::uint32_t triangle[3] = { indices[ 3 * bestTriangle ], indices[ 3 * bestTriangle + 1 ], indices[ 3 * bestTriangle + 2 ] };
+			optimizedIndices.insert( optimizedIndices.end(), triangle, triangle + 3 );
+			emitted[bestTriangle] = true;
+
+			std::size_t nextCacheCount = 0;
+			for( const auto& vertexIndex : triangle )
+			{
+				// take the emitted triangle out of the vertex's remaining range
+				std::uint32_t* pTriangles = &vertexTriangles[ triangleOffsets[vertexIndex] ];
+				std::uint32_t* pLast = pTriangles + remainingValence[vertexIndex] - 1;
+				*std::find( pTriangles, pLast, static_cast<std::uint32_t>( bestTriangle ) ) = *pLast;
+				remainingValence[vertexIndex]--;
+
+				if( std::find( nextCache.begin(), nextCache.begin() + nextCacheCount, vertexIndex ) == nextCache.begin() + nextCacheCount )
+					nextCache[nextCacheCount++] = vertexIndex;
+			}
+			for( std::size_t cacheIndex = 0; cacheIndex < cacheCount; cacheIndex++ )
+			{
+				if( cache[cacheIndex] != triangle[0] && cache[cacheIndex] != triangle[1] && cache[cacheIndex] != triangle[2] )
+					nextCache[nextCacheCount++] = cache[cacheIndex];
+			}
+
+			for( std::size_t cacheIndex = 0; cacheIndex < nextCacheCount; cacheIndex++ )
+			{
+				const std::uint32_t vertexIndex = nextCache[cacheIndex];
+				cachePositions[vertexIndex] = cacheIndex < SCORED_CACHE_SIZE ? static_cast<std::int32_t>( cacheIndex ) : -1;
+
+				float score = scoreTables.getScore( cachePositions[vertexIndex], remainingValence[vertexIndex] );
+				float scoreDelta = score - vertexScores[vertexIndex];
+				vertexScores[vertexIndex] = score;
+
+				for( std::uint32_t triangleSlot = 0; triangleSlot < remainingValence[vertexIndex]; triangleSlot++ )
+					triangleScores[ vertexTriangles[ triangleOffsets[vertexIndex] + triangleSlot ] ] += scoreDelta;
+			}
+
+			cacheCount = std::min<std::size_t>( nextCacheCount, SCORED_CACHE_SIZE );
+			std::swap( cache, nextCache );
+
+			// only triangles touching the cache changed score, the best one is among them or the cache is cold
+			bHaveBest = false;
+			float bestScore = 0.0f;
+			for( std::size_t cacheIndex = 0; cacheIndex < cacheCount; cacheIndex++ )
+			{
+				const std::uint32_t vertexIndex = cache[cacheIndex];
+				for( std::uint32_t triangleSlot = 0; triangleSlot < remainingValence[vertexIndex]; triangleSlot++ )
+				{
+					const std::uint32_t triangleIndex = vertexTriangles[ triangleOffsets[vertexIndex] + triangleSlot ];
+					if( !bHaveBest || triangleScores[triangleIndex] > bestScore )
+					{
+						bestTriangle = triangleIndex;
+						bestScore = triangleScores[triangleIndex];
+						bHaveBest = true;
+					}
+				}
+			}
+		}
+
+		indices.swap( optimizedIndices );
+	}
+
+	void optimizeOverdraw( std::vector<std::uint32_t>& indices, const std::vector<vertex>& vertices, const float& threshold )
+	{
+		const std::size_t triangleCount = indices.size() / 3;
+		if( triangleCount == 0 )
+			return;
+
+		// a triangle missing on all three vertices starts over on a cold cache, the order can be cut there for free
+		std::vector<std::size_t> hardClusterStarts;
+		{
+			FifoCacheSimulator cache{ vertices.size(), VERTEX_CACHE_ANALYZE_SIZE };
+			for( std::size_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++ )
+			{
+				if( cache.accessTriangle( &indices[ 3 * triangleIndex ] ) == 3 )
+					hardClusterStarts.push_back( triangleIndex );
+			}
+		}
+		hardClusterStarts.push_back( triangleCount );
+
+		// finer cuts where the miss ratio since the last cut is already within threshold of the whole cluster's
+		std::vector<std::size_t> clusterStarts;
+		{
+			FifoCacheSimulator cache{ vertices.size(), VERTEX_CACHE_ANALYZE_SIZE };
+			for( std::size_t hardIndex = 0; hardIndex + 1 < hardClusterStarts.size(); hardIndex++ )
+			{
+				const std::size_t clusterBegin = hardClusterStarts[hardIndex];
+				const std::size_t clusterEnd = hardClusterStarts[hardIndex + 1];
+
+				cache.flush();
+				std::size_t clusterMisses = 0;
+				for( std::size_t triangleIndex = clusterBegin; triangleIndex < clusterEnd; triangleIndex++ )
+					clusterMisses += cache.accessTriangle( &indices[ 3 * triangleIndex ] );
+				const float clusterThreshold = threshold * static_cast<float>( clusterMisses ) / static_cast<float>( clusterEnd - clusterBegin );
+
+				cache.flush();
+				clusterStarts.push_back( clusterBegin );
+				std::size_t softBegin = clusterBegin;
+				std::size_t softMisses = 0;
+				for( std::size_t triangleIndex = clusterBegin; triangleIndex < clusterEnd; triangleIndex++ )
+				{
+					softMisses += cache.accessTriangle( &indices[ 3 * triangleIndex ] );
+					if( triangleIndex + 1 < clusterEnd && static_cast<float>( softMisses ) / static_cast<float>( triangleIndex + 1 - softBegin ) <= clusterThreshold )
+					{
+						softBegin = triangleIndex + 1;
+						softMisses = 0;
+						clusterStarts.push_back( softBegin );
+						cache.flush();
+					}
+				}
+			}
+		}
+		clusterStarts.push_back( triangleCount );
+		const std::size_t clusterCount = clusterStarts.size() - 1;
+
+		glm::vec3 meshCentroid{ 0.0f };
+		for( const auto& vertexData : vertices )
+			meshCentroid += vertexData.pos;
+		meshCentroid /= static_cast<float>( std::max<std::size_t>( vertices.size(), 1 ) );
+
+		// how far a cluster sits out along its own facing, those occlude the most and go first
+		std::vector<float> clusterSortKeys( clusterCount );
+		for( std::size_t clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++ )
+		{
+			glm::vec3 areaCentroid{ 0.0f };
+			glm::vec3 normal{ 0.0f };
+			float area = 0.0f;
+			for( std::size_t triangleIndex = clusterStarts[clusterIndex]; triangleIndex < clusterStarts[clusterIndex + 1]; triangleIndex++ )
+			{
+				const std::uint32_t* pTriangle = &indices[ 3 * triangleIndex ];
+				glm::vec3 cross = getTriangleCross( vertices, pTriangle );
+				float triangleArea = glm::length( cross );
+				areaCentroid += ( vertices[pTriangle[0]].pos + vertices[pTriangle[1]].pos + vertices[pTriangle[2]].pos ) * ( triangleArea / 3.0f );
+				normal += cross;
+				area += triangleArea;
+			}
+
+			float normalLength = glm::length( normal );
+			if( area <= 0.0f || normalLength <= 0.0f )
+			{
+				clusterSortKeys[clusterIndex] = 0.0f;
+				continue;
+			}
+			clusterSortKeys[clusterIndex] = glm::dot( areaCentroid / area - meshCentroid, normal / normalLength );
+		}
+
+		std::vector<std::size_t> clusterOrder( clusterCount );
+		std::iota( clusterOrder.begin(), clusterOrder.end(), 0 );
+		std::stable_sort( clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys]( const std::size_t& lhs, const std::size_t& rhs ) {
+			return clusterSortKeys[lhs] > clusterSortKeys[rhs];
+		} );
+
+		std::vector<std::uint32_t> sortedIndices;
+		sortedIndices.reserve( indices.size() );
+		for( const auto& clusterIndex : clusterOrder )
+			sortedIndices.insert( sortedIndices.end(), indices.begin() + 3 * clusterStarts[clusterIndex], indices.begin() + 3 * clusterStarts[clusterIndex + 1] );
+
+		indices.swap( sortedIndices );
+	}
+
+	void optimizeVertexFetch( MeshData& meshData )
+	{
+		std::vector<std::uint32_t> remap( meshData.m_vertices.size(), UNUSED_VERTEX );
+		std::uint32_t remappedCount = 0;
+		for( auto& index : meshData.m_indices )
+		{
+			if( remap[index] == UNUSED_VERTEX )
+				remap[index] = remappedCount++;
+			index = remap[index];
+		}
+
+		std::vector<vertex> remappedVertices( remappedCount );
+		for( std::size_t vertexIndex = 0; vertexIndex < meshData.m_vertices.size(); vertexIndex++ )
+		{
+			if( remap[vertexIndex] != UNUSED_VERTEX )
+				remappedVertices[ remap[vertexIndex] ] = meshData.m_vertices[vertexIndex];
+		}
+
+		meshData.m_vertices.swap( remappedVertices );
+		meshData.computeBounds();
+	}
+
+	MeshOptimizeReport optimizeMesh( MeshData& meshData, const MeshOptimizeMode& optimizeMode )
+	{
+		auto optimizeStart = std::chrono::high_resolution_clock::now();
+
+		MeshOptimizeReport report;
+		report.m_before = analyzeVertexCache( meshData.m_indices, meshData.m_vertices.size() );
+
+		if( optimizeMode != MeshOptimizeMode::eNone )
+		{
+			optimizeVertexCache( meshData.m_indices, meshData.m_vertices.size() );
+			if( optimizeMode == MeshOptimizeMode::eVertexCacheAndOverdraw )
+				optimizeOverdraw( meshData.m_indices, meshData.m_vertices );
+			optimizeVertexFetch( meshData );
+		}
+
+		report.m_after = analyzeVertexCache( meshData.m_indices, meshData.m_vertices.size() );
+		report.m_optimizeMs = std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - optimizeStart ).count();
+		return report;
+	}
+
+} // namespace graphics
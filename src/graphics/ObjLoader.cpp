@@ -0,0 +1,489 @@
+#include "graphics/ObjLoader.h"
+#include "graphics/VertexWeldTable.h"
+#include "utilities/MappedFile.h"
+#include "utilities/ThreadPool.h"
+#include "utilities/VulkanLogger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#ifndef TINYOBJLOADER_IMPLEMENTATION
+	#define TINYOBJLOADER_IMPLEMENTATION
+#endif
+#include <tiny_obj_loader.h>
+
+namespace graphics
+{
+	namespace
+	{
+		// chunks below this size are not worth a task of their own
+		constexpr std::size_t MIN_CHUNK_BYTES = 256 * 1024;
+		// a few chunks per thread slot even out chunks that hold more faces than others
+		constexpr std::uint32_t CHUNKS_PER_THREAD_SLOT = 4;
+		constexpr std::uint32_t VERTEX_SHARD_COUNT = 64;
+		constexpr std::uint32_t NO_TEXCOORD = std::numeric_limits<std::uint32_t>::max();
+		// corners without a vt, both loaders give them the same coordinate so their meshes match
+		const glm::vec2 MISSING_TEXCOORD{ 0.0f, 1.0f };
+
+		constexpr std::uint8_t CORNER_POSITION_RELATIVE = 1 << 0;
+		constexpr std::uint8_t CORNER_TEXCOORD_RELATIVE = 1 << 1;
+		constexpr std::uint8_t CORNER_NO_TEXCOORD = 1 << 2;
+
+		// a face corner as its chunk read it, negative OBJ indices are kept relative to the chunk's first element
+		struct ObjChunkCorner
+		{
+			std::int32_t	m_position;
+			std::int32_t	m_texCoord;
+			std::uint8_t	m_flags;
+		};
+
+		struct ObjCorner
+		{
+			std::uint32_t	m_position;
+			std::uint32_t	m_texCoord;
+		};
+
+		struct ObjChunk
+		{
+			const char* m_pBegin{ nullptr };
+			const char* m_pEnd{ nullptr };
+			std::vector<float> m_positions;
+			std::vector<float> m_texCoords;
+			std::vector<ObjChunkCorner> m_corners;
+			std::string m_error;
+			const char* m_pErrorLine{ nullptr };
+		};
+
+		bool isBlank( const char& c )
+		{
+			return c == ' ' || c == '\t';
+		}
+
+		const char* skipBlanks( const char* pCursor, const char* pLineEnd )
+		{
+			while( pCursor != pLineEnd && isBlank( *pCursor ) )
+				pCursor++;
+			return pCursor;
+		}
+
+		// goes through tinyobj's own number parser, both loaders have to round the same text to the same float
+		float parseFloat( const char*& pCursor, const char* pLineEnd )
+		{
+			pCursor = skipBlanks( pCursor, pLineEnd );
+			const char* pTokenEnd = pCursor;
+			while( pTokenEnd != pLineEnd && !isBlank( *pTokenEnd ) && *pTokenEnd != '\r' )
+				pTokenEnd++;
+
+			double value = 0.0;
+			tinyobj::tryParseDouble( pCursor, pTokenEnd, &value );
+			pCursor = pTokenEnd;
+			return static_cast<float>( value );
+		}
+
+		// one index of a corner, elementCount is how many positions or texture coordinates the chunk has read so far
+		bool parseIndex( const char*& pCursor, const char* pLineEnd, const std::size_t& elementCount, std::int32_t& index, bool& bRelative )
+		{
+			bool bNegative = false;
+			if( pCursor != pLineEnd && ( *pCursor == '-' || *pCursor == '+' ) )
+			{
+				bNegative = *pCursor == '-';
+				pCursor++;
+			}
+
+			const char* pDigits = pCursor;
+			std::int64_t value = 0;
+			while( pCursor != pLineEnd && *pCursor >= '0' && *pCursor <= '9' && value <= std::numeric_limits<std::int32_t>::max() )
+			{
+				value = value * 10 + ( *pCursor - '0' );
+				pCursor++;
+			}
+			// like tinyobj, whatever follows the digits up to the next separator is ignored
+			while( pCursor != pLineEnd && *pCursor != '/' && !isBlank( *pCursor ) && *pCursor != '\r' )
+				pCursor++;
+
+			if( pCursor == pDigits || value == 0 || value > std::numeric_limits<std::int32_t>::max() )
+				return false;
+
+			std::int64_t resolved = bNegative ? static_cast<std::int64_t>( elementCount ) - value : value - 1;
+			if( resolved < std::numeric_limits<std::int32_t>::min() || resolved > std::numeric_limits<std::int32_t>::max() )
+				return false;
+
+			index = static_cast<std::int32_t>( resolved );
+			bRelative = bNegative;
+			return true;
+		}
+
+		// v/vt/vn, normals are skipped as the vertex layout has none
+		bool parseCorner( const char*& pCursor, const char* pLineEnd, const ObjChunk& chunk, ObjChunkCorner& corner )
+		{
+			corner = ObjChunkCorner{ 0, 0, CORNER_NO_TEXCOORD };
+
+			bool bRelative = false;
+			if( !parseIndex( pCursor, pLineEnd, chunk.m_positions.size() / 3, corner.m_position, bRelative ) )
+				return false;
+			if( bRelative )
+				corner.m_flags |= CORNER_POSITION_RELATIVE;
+
+			if( pCursor == pLineEnd || *pCursor != '/' )
+				return true;
+			pCursor++;
+			if( pCursor != pLineEnd && *pCursor != '/' && !isBlank( *pCursor ) && *pCursor != '\r' )
+			{
+				if( !parseIndex( pCursor, pLineEnd, chunk.m_texCoords.size() / 2, corner.m_texCoord, bRelative ) )
+					return false;
+				corner.m_flags &= ~CORNER_NO_TEXCOORD;
+				if( bRelative )
+					corner.m_flags |= CORNER_TEXCOORD_RELATIVE;
+			}
+
+			while( pCursor != pLineEnd && !isBlank( *pCursor ) && *pCursor != '\r' )
+				pCursor++;
+			return true;
+		}
+
+		void parseObjChunk( ObjChunk& chunk )
+		{
+			std::vector<ObjChunkCorner> polygon;
+
+			const char* pLine = chunk.m_pBegin;
+			while( pLine != chunk.m_pEnd )
+			{
+				const char* pLineEnd = static_cast<const char*>( std::memchr( pLine, '\n', static_cast<std::size_t>( chunk.m_pEnd - pLine ) ) );
+				const char* pNextLine = pLineEnd ? pLineEnd + 1 : chunk.m_pEnd;
+				if( !pLineEnd )
+					pLineEnd = chunk.m_pEnd;
+
+				const char* pCursor = skipBlanks( pLine, pLineEnd );
+				const std::size_t lineLength = static_cast<std::size_t>( pLineEnd - pCursor );
+
+				if( lineLength >= 2 && pCursor[0] == 'v' && isBlank( pCursor[1] ) )
+				{
+					pCursor += 2;
+					for( int axis = 0; axis < 3; axis++ )
+						chunk.m_positions.push_back( parseFloat( pCursor, pLineEnd ) );
+				}
+				else if( lineLength >= 3 && pCursor[0] == 'v' && pCursor[1] == 't' && isBlank( pCursor[2] ) )
+				{
+					pCursor += 3;
+					for( int axis = 0; axis < 2; axis++ )
+						chunk.m_texCoords.push_back( parseFloat( pCursor, pLineEnd ) );
+				}
+				else if( lineLength >= 2 && pCursor[0] == 'f' && isBlank( pCursor[1] ) )
+				{
+					pCursor = skipBlanks( pCursor + 2, pLineEnd );
+					polygon.clear();
+					while( pCursor != pLineEnd && *pCursor != '\r' )
+					{
+						ObjChunkCorner corner;
+						if( !parseCorner( pCursor, pLineEnd, chunk, corner ) )
+						{
+							chunk.m_error = "invalid face index";
+							chunk.m_pErrorLine = pLine;
+							return;
+						}
+						polygon.push_back( corner );
+						pCursor = skipBlanks( pCursor, pLineEnd );
+					}
+
+					// fanned from the first corner, as tinyobj triangulates
+					for( std::size_t cornerIndex = 2; cornerIndex < polygon.size(); cornerIndex++ )
+					{
+						chunk.m_corners.push_back( polygon[0] );
+						chunk.m_corners.push_back( polygon[cornerIndex - 1] );
+						chunk.m_corners.push_back( polygon[cornerIndex] );
+					}
+				}
+
+				pLine = pNextLine;
+			}
+		}
+
+		vertex makeVertex( const ObjCorner& corner, const std::vector<float>& positions, const std::vector<float>& texCoords )
+		{
+			vertex vertexData{};
+
+			vertexData.pos = {
+				positions[ 3 * static_cast<std::size_t>( corner.m_position ) + 0 ],
+				positions[ 3 * static_cast<std::size_t>( corner.m_position ) + 1 ],
+				positions[ 3 * static_cast<std::size_t>( corner.m_position ) + 2 ]
+			};
+
+			if( corner.m_texCoord != NO_TEXCOORD )
+			{
+				vertexData.texCoord = {
+					texCoords[ 2 * static_cast<std::size_t>( corner.m_texCoord ) + 0 ],
+					1.0f - texCoords[ 2 * static_cast<std::size_t>( corner.m_texCoord ) + 1 ]
+				};
+			}
+			else
+			{
+				vertexData.texCoord = MISSING_TEXCOORD;
+			}
+
+			vertexData.color = { 1.0, 1.0, 1.0 };
+
+			return vertexData;
+		}
+
+		std::uint32_t getVertexShard( const vertex& vertexData, const float& weldEpsilon )
+		{
+			// the shard takes the top half of the hash, the shard's weld table probes from the bottom half
+			return static_cast<std::uint32_t>( ( VertexWeldTable::hashVertex( vertexData, weldEpsilon ) >> 32 ) % VERTEX_SHARD_COUNT );
+		}
+
+		[[noreturn]] void throwChunkError( const char* pFileData, const ObjChunk& chunk, const std::filesystem::path& objFilePath )
+		{
+			std::string errorMsg = fmt::format( "{}: {}", objFilePath.string(), chunk.m_error );
+			if( chunk.m_pErrorLine )
+			{
+				std::size_t lineNumber = 1 + static_cast<std::size_t>( std::count( pFileData, chunk.m_pErrorLine, '\n' ) );
+				errorMsg = fmt::format( "{}:{}: {}", objFilePath.string(), lineNumber, chunk.m_error );
+			}
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+	}
+
+	void loadObjMesh( const std::filesystem::path& objFilePath, MeshData& meshData, const float& weldEpsilon )
+	{
+		tinyobj::attrib_t attributes;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string errorMsg;
+
+		if( !tinyobj::LoadObj(
+				&attributes,
+				&shapes,
+				&materials,
+				&errorMsg,
+				objFilePath.string().c_str()
+			)
+		)
+		{
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		meshData.m_vertices.clear();
+		meshData.m_indices.clear();
+
+		std::size_t indexCount = 0;
+		for( const auto& shape : shapes )
+			indexCount += shape.mesh.indices.size();
+		meshData.m_indices.reserve( indexCount );
+
+		VertexWeldTable weldTable{ VertexWeldTable::estimateVertexCount( indexCount ), weldEpsilon };
+
+		for( const auto& shape : shapes )
+		{
+			for( const auto& index : shape.mesh.indices )
+			{
+				vertex vertexData{};
+
+				vertexData.pos = {
+					attributes.vertices[ 3 * index.vertex_index + 0 ],
+					attributes.vertices[ 3 * index.vertex_index + 1 ],
+					attributes.vertices[ 3 * index.vertex_index + 2 ]
+				};
+
+				if( index.texcoord_index >= 0 )
+				{
+					vertexData.texCoord = {
+						attributes.texcoords[ 2 * index.texcoord_index + 0 ],
+						1.0f - attributes.texcoords[ 2 * index.texcoord_index + 1 ]
+					};
+				}
+				else
+				{
+					vertexData.texCoord = MISSING_TEXCOORD;
+				}
+
+				vertexData.color = { 1.0, 1.0, 1.0 };
+
+				std::uint32_t vertexIndex = weldTable.findOrInsert( vertexData, static_cast<std::uint32_t>( meshData.m_vertices.size() ) );
+				if( vertexIndex == meshData.m_vertices.size() )
+					meshData.m_vertices.push_back( vertexData );
+				meshData.m_indices.push_back( vertexIndex );
+			}
+		}
+
+		meshData.computeBounds();
+	}
+
+	void loadObjMeshParallel( const std::filesystem::path& objFilePath, MeshData& meshData, utils::ThreadPool& threadPool, const float& weldEpsilon )
+	{
+		utils::MappedFile objFile;
+		if( !objFile.open( objFilePath ) )
+		{
+			std::string errorMsg = fmt::format( "Failed to open OBJ file {}", objFilePath.string() );
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		const char* pFileData = reinterpret_cast<const char*>( objFile.getData() );
+		const char* pFileEnd = pFileData + objFile.getSize();
+
+		// split on line ends, each chunk parses on its own and counts elements from zero
+		const std::uint32_t chunkCount = static_cast<std::uint32_t>( std::max<std::size_t>( 1, std::min<std::size_t>(
+			threadPool.getThreadSlotCount() * CHUNKS_PER_THREAD_SLOT,
+			objFile.getSize() / MIN_CHUNK_BYTES
+		) ) );
+		std::vector<ObjChunk> chunks( chunkCount );
+		const char* pChunkBegin = pFileData;
+		for( std::uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+		{
+			const char* pChunkEnd = pFileEnd;
+			if( chunkIndex + 1 < chunkCount )
+			{
+				pChunkEnd = std::max( pChunkBegin, pFileData + objFile.getSize() / chunkCount * ( chunkIndex + 1 ) );
+				const char* pLineEnd = static_cast<const char*>( std::memchr( pChunkEnd, '\n', static_cast<std::size_t>( pFileEnd - pChunkEnd ) ) );
+				pChunkEnd = pLineEnd ? pLineEnd + 1 : pFileEnd;
+			}
+
+			chunks[chunkIndex].m_pBegin = pChunkBegin;
+			chunks[chunkIndex].m_pEnd = pChunkEnd;
+			pChunkBegin = pChunkEnd;
+		}
+
+		threadPool.dispatch( chunkCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			parseObjChunk( chunks[taskIndex] );
+		} );
+
+		// element offsets of every chunk turn its relative indices into file wide ones
+		std::vector<std::size_t> positionOffsets( chunkCount + 1, 0 );
+		std::vector<std::size_t> texCoordOffsets( chunkCount + 1, 0 );
+		std::vector<std::size_t> cornerOffsets( chunkCount + 1, 0 );
+		for( std::uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+		{
+			if( !chunks[chunkIndex].m_error.empty() )
+				throwChunkError( pFileData, chunks[chunkIndex], objFilePath );
+
+			positionOffsets[chunkIndex + 1] = positionOffsets[chunkIndex] + chunks[chunkIndex].m_positions.size() / 3;
+			texCoordOffsets[chunkIndex + 1] = texCoordOffsets[chunkIndex] + chunks[chunkIndex].m_texCoords.size() / 2;
+			cornerOffsets[chunkIndex + 1] = cornerOffsets[chunkIndex] + chunks[chunkIndex].m_corners.size();
+		}
+
+		const std::size_t positionCount = positionOffsets[chunkCount];
+		const std::size_t texCoordCount = texCoordOffsets[chunkCount];
+		const std::size_t cornerCount = cornerOffsets[chunkCount];
+		if( cornerCount >= NO_TEXCOORD || positionCount >= NO_TEXCOORD || texCoordCount >= NO_TEXCOORD )
+		{
+			std::string errorMsg = fmt::format( "{} has more elements than 32 bit indices can address", objFilePath.string() );
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		std::vector<float> positions( 3 * positionCount );
+		std::vector<float> texCoords( 2 * texCoordCount );
+		std::vector<ObjCorner> corners( cornerCount );
+
+		threadPool.dispatch( chunkCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			ObjChunk& chunk = chunks[taskIndex];
+			std::copy( chunk.m_positions.begin(), chunk.m_positions.end(), positions.begin() + 3 * positionOffsets[taskIndex] );
+			std::copy( chunk.m_texCoords.begin(), chunk.m_texCoords.end(), texCoords.begin() + 2 * texCoordOffsets[taskIndex] );
+
+			for( std::size_t cornerIndex = 0; cornerIndex < chunk.m_corners.size(); cornerIndex++ )
+			{
+				const ObjChunkCorner& chunkCorner = chunk.m_corners[cornerIndex];
+				std::int64_t position = chunkCorner.m_position;
+				if( chunkCorner.m_flags & CORNER_POSITION_RELATIVE )
+					position += static_cast<std::int64_t>( positionOffsets[taskIndex] );
+				std::int64_t texCoord = chunkCorner.m_texCoord;
+				if( chunkCorner.m_flags & CORNER_TEXCOORD_RELATIVE )
+					texCoord += static_cast<std::int64_t>( texCoordOffsets[taskIndex] );
+
+				bool bNoTexCoord = ( chunkCorner.m_flags & CORNER_NO_TEXCOORD ) != 0;
+				if( position < 0 || position >= static_cast<std::int64_t>( positionCount ) ||
+					( !bNoTexCoord && ( texCoord < 0 || texCoord >= static_cast<std::int64_t>( texCoordCount ) ) ) )
+				{
+					// the corner's line is not kept past parsing, the error names the file only
+					chunk.m_error = "face index out of range";
+					return;
+				}
+
+				corners[cornerOffsets[taskIndex] + cornerIndex] = ObjCorner{
+					static_cast<std::uint32_t>( position ),
+					bNoTexCoord ? NO_TEXCOORD : static_cast<std::uint32_t>( texCoord )
+				};
+			}
+
+			chunk.m_positions = {};
+			chunk.m_texCoords = {};
+			chunk.m_corners = {};
+		} );
+
+		for( std::uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+		{
+			if( !chunks[chunkIndex].m_error.empty() )
+				throwChunkError( pFileData, chunks[chunkIndex], objFilePath );
+		}
+
+		// corners are bucketed by vertex hash in corner order, so every shard meets the corners of a vertex in
+		// file order and the first one it records is the vertex's first occurrence in the whole file
+		std::vector<std::vector<std::uint32_t>> shardCorners( static_cast<std::size_t>( chunkCount ) * VERTEX_SHARD_COUNT );
+		threadPool.dispatch( chunkCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			for( std::size_t cornerIndex = cornerOffsets[taskIndex]; cornerIndex < cornerOffsets[taskIndex + 1]; cornerIndex++ )
+			{
+				std::uint32_t shard = getVertexShard( makeVertex( corners[cornerIndex], positions, texCoords ), weldEpsilon );
+				shardCorners[ static_cast<std::size_t>( taskIndex ) * VERTEX_SHARD_COUNT + shard ].push_back( static_cast<std::uint32_t>( cornerIndex ) );
+			}
+		} );
+
+		std::vector<std::uint32_t> firstCorners( cornerCount );
+		threadPool.dispatch( VERTEX_SHARD_COUNT, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			std::size_t shardCornerCount = 0;
+			for( std::uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+				shardCornerCount += shardCorners[ static_cast<std::size_t>( chunkIndex ) * VERTEX_SHARD_COUNT + taskIndex ].size();
+
+			VertexWeldTable firstCornerOfVertex{ VertexWeldTable::estimateVertexCount( shardCornerCount ), weldEpsilon };
+			for( std::uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+			{
+				for( const std::uint32_t& cornerIndex : shardCorners[ static_cast<std::size_t>( chunkIndex ) * VERTEX_SHARD_COUNT + taskIndex ] )
+					firstCorners[cornerIndex] = firstCornerOfVertex.findOrInsert( makeVertex( corners[cornerIndex], positions, texCoords ), cornerIndex );
+			}
+		} );
+		shardCorners = {};
+
+		// first occurrences are numbered in corner order, the same order the sequential loader hands out indices in
+		std::vector<std::size_t> vertexOffsets( chunkCount + 1, 0 );
+		threadPool.dispatch( chunkCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			std::size_t firstCount = 0;
+			for( std::size_t cornerIndex = cornerOffsets[taskIndex]; cornerIndex < cornerOffsets[taskIndex + 1]; cornerIndex++ )
+				firstCount += firstCorners[cornerIndex] == cornerIndex ? 1 : 0;
+			vertexOffsets[taskIndex + 1] = firstCount;
+		} );
+		for( std::uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+			vertexOffsets[chunkIndex + 1] += vertexOffsets[chunkIndex];
+
+		meshData.m_vertices.clear();
+		meshData.m_vertices.resize( vertexOffsets[chunkCount] );
+		meshData.m_indices.clear();
+		meshData.m_indices.resize( cornerCount );
+
+		threadPool.dispatch( chunkCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			std::size_t vertexIndex = vertexOffsets[taskIndex];
+			for( std::size_t cornerIndex = cornerOffsets[taskIndex]; cornerIndex < cornerOffsets[taskIndex + 1]; cornerIndex++ )
+			{
+				if( firstCorners[cornerIndex] != cornerIndex )
+					continue;
+				meshData.m_vertices[vertexIndex] = makeVertex( corners[cornerIndex], positions, texCoords );
+				meshData.m_indices[cornerIndex] = static_cast<std::uint32_t>( vertexIndex );
+				vertexIndex++;
+			}
+		} );
+
+		// every first occurrence is numbered by now, the remaining corners copy the index of theirs
+		threadPool.dispatch( chunkCount, [&]( const std::uint32_t& taskIndex, const std::uint32_t& ){
+			for( std::size_t cornerIndex = cornerOffsets[taskIndex]; cornerIndex < cornerOffsets[taskIndex + 1]; cornerIndex++ )
+			{
+				if( firstCorners[cornerIndex] != cornerIndex )
+					meshData.m_indices[cornerIndex] = meshData.m_indices[ firstCorners[cornerIndex] ];
+			}
+		} );
+
+		meshData.computeBounds();
+	}
+
+} // namespace graphics
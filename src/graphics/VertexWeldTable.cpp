@@ -0,0 +1,136 @@
+#include "graphics/VertexWeldTable.h"
+
+#include <cmath>
+
+namespace graphics
+{
+	namespace
+	{
+		// grown past this fill, linear probing lengthens quickly beyond it
+		constexpr std::size_t MAX_LOAD_PERCENT = 70;
+		constexpr std::size_t MIN_SLOT_COUNT = 16;
+
+		std::size_t getSlotCount( const std::size_t& vertexCount )
+		{
+			std::size_t slotCount = MIN_SLOT_COUNT;
+			while( slotCount * MAX_LOAD_PERCENT < vertexCount * 100 )
+				slotCount *= 2;
+			return slotCount;
+		}
+
+		std::int64_t roundToWeldGrid( const float& component, const float& weldEpsilon )
+		{
+			return static_cast<std::int64_t>( std::llround( static_cast<double>( component ) / weldEpsilon ) );
+		}
+
+		void getComponents( const vertex& vertexData, float (&components)[8] )
+		{
+			components[0] = vertexData.pos.x;
+			components[1] = vertexData.pos.y;
+			components[2] = vertexData.pos.z;
+			components[3] = vertexData.color.x;
+			components[4] = vertexData.color.y;
+			components[5] = vertexData.color.z;
+			components[6] = vertexData.texCoord.x;
+			components[7] = vertexData.texCoord.y;
+		}
+	}
+
+	VertexWeldTable::VertexWeldTable( const std::size_t& expectedVertexCount, const float& weldEpsilon )
+		: m_slots( getSlotCount( expectedVertexCount ) )
+		, m_slotMask( m_slots.size() - 1 )
+		, m_size( 0 )
+		, m_weldEpsilon( weldEpsilon > 0.0f ? weldEpsilon : 0.0f )
+	{}
+
+	std::uint32_t VertexWeldTable::findOrInsert( const vertex& vertexData, const std::uint32_t& vertexIndex )
+	{
+		if( ( m_size + 1 ) * 100 > m_slots.size() * MAX_LOAD_PERCENT )
+			grow();
+
+		const std::uint64_t hash = hashVertex( vertexData, m_weldEpsilon );
+		const std::uint32_t hashTag = static_cast<std::uint32_t>( hash >> 32 );
+
+		for( std::size_t slotIndex = static_cast<std::size_t>( hash ) & m_slotMask; ; slotIndex = ( slotIndex + 1 ) & m_slotMask )
+		{
+			Slot& slot = m_slots[slotIndex];
+			if( slot.m_vertexIndex == EMPTY_SLOT )
+			{
+				slot.m_vertex = vertexData;
+				slot.m_vertexIndex = vertexIndex;
+				slot.m_hashTag = hashTag;
+				m_size++;
+				return vertexIndex;
+			}
+
+			if( slot.m_hashTag == hashTag && matches( slot.m_vertex, vertexData ) )
+				return slot.m_vertexIndex;
+		}
+	}
+
+	std::size_t VertexWeldTable::getSize() const
+	{
+		return m_size;
+	}
+
+	std::size_t VertexWeldTable::getCapacity() const
+	{
+		return m_slots.size() * MAX_LOAD_PERCENT / 100;
+	}
+
+	std::uint64_t VertexWeldTable::hashVertex( const vertex& vertexData, const float& weldEpsilon )
+	{
+		if( weldEpsilon <= 0.0f )
+			return graphics::hashVertex( vertexData );
+
+		float components[8];
+		getComponents( vertexData, components );
+
+		std::uint64_t hash = 0x9e3779b97f4a7c15ull;
+		for( const float& component : components )
+			hash = mixHashBits( hash ^ static_cast<std::uint64_t>( roundToWeldGrid( component, weldEpsilon ) ) );
+		return hash;
+	}
+
+	std::size_t VertexWeldTable::estimateVertexCount( const std::size_t& indexCount )
+	{
+		return indexCount / 4;
+	}
+
+	bool VertexWeldTable::matches( const vertex& storedVertex, const vertex& vertexData ) const
+	{
+		if( m_weldEpsilon <= 0.0f )
+			return storedVertex == vertexData;
+
+		float storedComponents[8];
+		float components[8];
+		getComponents( storedVertex, storedComponents );
+		getComponents( vertexData, components );
+		for( int componentIndex = 0; componentIndex < 8; componentIndex++ )
+		{
+			if( roundToWeldGrid( storedComponents[componentIndex], m_weldEpsilon ) != roundToWeldGrid( components[componentIndex], m_weldEpsilon ) )
+				return false;
+		}
+		return true;
+	}
+
+	void VertexWeldTable::grow()
+	{
+		std::vector<Slot> oldSlots( m_slots.size() * 2 );
+		oldSlots.swap( m_slots );
+		m_slotMask = m_slots.size() - 1;
+
+		for( const Slot& oldSlot : oldSlots )
+		{
+			if( oldSlot.m_vertexIndex == EMPTY_SLOT )
+				continue;
+
+			// the tag only keeps the top half, the slot index needs the hash again
+			std::size_t slotIndex = static_cast<std::size_t>( hashVertex( oldSlot.m_vertex, m_weldEpsilon ) ) & m_slotMask;
+			while( m_slots[slotIndex].m_vertexIndex != EMPTY_SLOT )
+				slotIndex = ( slotIndex + 1 ) & m_slotMask;
+			m_slots[slotIndex] = oldSlot;
+		}
+	}
+
+} // namespace graphics
@@ -0,0 +1,219 @@
+#include "utilities/CpuTracer.h"
+#include "utilities/JsonWriter.hpp"
+#include "utilities/VulkanLogger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace utils
+{
+	namespace
+	{
+		struct ThreadBuffer
+		{
+			std::vector<CpuTracer::Event>	m_events;
+			std::atomic<std::uint64_t>		m_writeCount{ 0 };
+			std::uint32_t					m_threadIndex{ 0 };
+			std::string						m_threadName;
+		};
+
+		struct TraceRegistry
+		{
+			std::mutex									m_mutex;
+			// kept alive after their threads exit so their events still make it into a dump
+			std::vector<std::shared_ptr<ThreadBuffer>>	m_threadBuffers;
+			std::atomic<bool>							m_bEnabled{ true };
+			std::chrono::steady_clock::time_point		m_epoch{ std::chrono::steady_clock::now() };
+		};
+
+		TraceRegistry& getRegistry()
+		{
+			static TraceRegistry registry;
+			return registry;
+		}
+
+		ThreadBuffer& getThreadBuffer()
+		{
+			thread_local std::shared_ptr<ThreadBuffer> t_spThreadBuffer;
+			if( !t_spThreadBuffer )
+			{
+				t_spThreadBuffer = std::make_shared<ThreadBuffer>();
+				t_spThreadBuffer->m_events.resize( CpuTracer::EVENTS_PER_THREAD );
+
+				TraceRegistry& registry = getRegistry();
+				std::lock_guard<std::mutex> registryLock{ registry.m_mutex };
+				t_spThreadBuffer->m_threadIndex = static_cast<std::uint32_t>( registry.m_threadBuffers.size() );
+				t_spThreadBuffer->m_threadName = fmt::format( "thread {}", t_spThreadBuffer->m_threadIndex );
+				registry.m_threadBuffers.push_back( t_spThreadBuffer );
+			}
+			return *t_spThreadBuffer;
+		}
+
+		CpuTracer::Event& nextEvent( ThreadBuffer& threadBuffer, std::uint64_t& writeIndex )
+		{
+			writeIndex = threadBuffer.m_writeCount.load( std::memory_order_relaxed );
+			return threadBuffer.m_events[writeIndex % CpuTracer::EVENTS_PER_THREAD];
+		}
+
+		void copyName( CpuTracer::Event& event, const std::string_view& name )
+		{
+			std::size_t nameLength = std::min( name.size(), CpuTracer::MAX_DYNAMIC_NAME_LENGTH );
+			std::copy_n( name.data(), nameLength, event.m_dynamicName.data() );
+			event.m_dynamicName[nameLength] = '\0';
+		}
+	}
+
+	void CpuTracer::recordZone( const char* pStaticName, const std::uint64_t& beginNs, const std::uint64_t& endNs )
+	{
+		if( !isEnabled() )
+			return;
+
+		ThreadBuffer& threadBuffer = getThreadBuffer();
+		std::uint64_t writeIndex;
+		Event& event = nextEvent( threadBuffer, writeIndex );
+		event.m_beginNs = beginNs;
+		event.m_durationNs = endNs - beginNs;
+		event.m_pStaticName = pStaticName;
+		event.m_type = EventType::eZone;
+		threadBuffer.m_writeCount.store( writeIndex + 1, std::memory_order_release );
+	}
+
+	void CpuTracer::recordZone( const std::string_view& dynamicName, const std::uint64_t& beginNs, const std::uint64_t& endNs )
+	{
+		if( !isEnabled() )
+			return;
+
+		ThreadBuffer& threadBuffer = getThreadBuffer();
+		std::uint64_t writeIndex;
+		Event& event = nextEvent( threadBuffer, writeIndex );
+		event.m_beginNs = beginNs;
+		event.m_durationNs = endNs - beginNs;
+		event.m_pStaticName = nullptr;
+		event.m_type = EventType::eZone;
+		copyName( event, dynamicName );
+		threadBuffer.m_writeCount.store( writeIndex + 1, std::memory_order_release );
+	}
+
+	void CpuTracer::recordInstant( const std::string_view& dynamicName )
+	{
+		if( !isEnabled() )
+			return;
+
+		ThreadBuffer& threadBuffer = getThreadBuffer();
+		std::uint64_t writeIndex;
+		Event& event = nextEvent( threadBuffer, writeIndex );
+		event.m_beginNs = nowNs();
+		event.m_durationNs = 0;
+		event.m_pStaticName = nullptr;
+		event.m_type = EventType::eInstant;
+		copyName( event, dynamicName );
+		threadBuffer.m_writeCount.store( writeIndex + 1, std::memory_order_release );
+	}
+
+	void CpuTracer::setThreadName( const std::string& threadName )
+	{
+		ThreadBuffer& threadBuffer = getThreadBuffer();
+
+		std::lock_guard<std::mutex> registryLock{ getRegistry().m_mutex };
+		threadBuffer.m_threadName = threadName;
+	}
+
+	std::uint64_t CpuTracer::nowNs()
+	{
+		return static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - getRegistry().m_epoch ).count() );
+	}
+
+	void CpuTracer::setEnabled( const bool& bEnabled )
+	{
+		getRegistry().m_bEnabled.store( bEnabled, std::memory_order_relaxed );
+	}
+
+	bool CpuTracer::isEnabled()
+	{
+		return getRegistry().m_bEnabled.load( std::memory_order_relaxed );
+	}
+
+	bool CpuTracer::writeChromeTrace( const std::filesystem::path& filePath )
+	{
+		TraceRegistry& registry = getRegistry();
+		std::unique_lock<std::mutex> registryLock{ registry.m_mutex };
+
+		utils::JsonWriter jsonWriter;
+		jsonWriter.beginObject();
+		jsonWriter.write( "displayTimeUnit", "ms" );
+		jsonWriter.beginArray( "traceEvents" );
+
+		std::uint64_t eventCount = 0;
+		for( const auto& spThreadBuffer : registry.m_threadBuffers )
+		{
+			jsonWriter.beginObject();
+			jsonWriter.write( "name", "thread_name" );
+			jsonWriter.write( "ph", "M" );
+			jsonWriter.write( "pid", 1 );
+			jsonWriter.write( "tid", spThreadBuffer->m_threadIndex );
+			jsonWriter.beginObject( "args" );
+			jsonWriter.write( "name", spThreadBuffer->m_threadName );
+			jsonWriter.endObject();
+			jsonWriter.endObject();
+
+			std::uint64_t writeCount = spThreadBuffer->m_writeCount.load( std::memory_order_acquire );
+			std::uint64_t firstEvent = writeCount > EVENTS_PER_THREAD ? writeCount - EVENTS_PER_THREAD : 0;
+
+			for( std::uint64_t eventIndex = firstEvent; eventIndex < writeCount; eventIndex++ )
+			{
+				const Event& event = spThreadBuffer->m_events[eventIndex % EVENTS_PER_THREAD];
+
+				jsonWriter.beginObject();
+				jsonWriter.write( "name", event.m_pStaticName ? std::string_view{ event.m_pStaticName } : std::string_view{ event.m_dynamicName.data() } );
+				jsonWriter.write( "pid", 1 );
+				jsonWriter.write( "tid", spThreadBuffer->m_threadIndex );
+				// trace timestamps are microseconds
+				jsonWriter.write( "ts", static_cast<double>( event.m_beginNs ) / 1000.0 );
+				if( event.m_type == EventType::eZone )
+				{
+					jsonWriter.write( "ph", "X" );
+					jsonWriter.write( "dur", static_cast<double>( event.m_durationNs ) / 1000.0 );
+				}
+				else
+				{
+					jsonWriter.write( "ph", "i" );
+					jsonWriter.write( "s", "t" );
+				}
+				jsonWriter.endObject();
+			}
+			eventCount += writeCount - firstEvent;
+		}
+
+		jsonWriter.endArray();
+		jsonWriter.endObject();
+
+		std::size_t threadCount = registry.m_threadBuffers.size();
+		// logging records an instant event, which may register this thread
+		registryLock.unlock();
+
+		if( !jsonWriter.writeToFile( filePath ) )
+		{
+			LOG_ERROR( fmt::format("Failed to write cpu trace to {}", filePath.string()) );
+			return false;
+		}
+
+		LOG_INFO( fmt::format("Wrote {} cpu trace events from {} threads to {}", eventCount, threadCount, filePath.string()) );
+		return true;
+	}
+
+	void CpuTracer::clear()
+	{
+		TraceRegistry& registry = getRegistry();
+		std::lock_guard<std::mutex> registryLock{ registry.m_mutex };
+
+		for( const auto& spThreadBuffer : registry.m_threadBuffers )
+		{
+			spThreadBuffer->m_writeCount.store( 0, std::memory_order_release );
+		}
+	}
+
+} // namespace utils
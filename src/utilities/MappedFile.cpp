@@ -0,0 +1,128 @@
+#include "utilities/MappedFile.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace utils
+{
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::open( const std::filesystem::path& filePath )
+	{
+		close();
+
+		m_fileHandle = CreateFileW( filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+		if( m_fileHandle == INVALID_HANDLE_VALUE )
+		{
+			m_fileHandle = nullptr;
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if( !GetFileSizeEx( m_fileHandle, &fileSize ) || fileSize.QuadPart == 0 )
+		{
+			close();
+			return false;
+		}
+
+		m_mappingHandle = CreateFileMappingW( m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+		if( m_mappingHandle == nullptr )
+		{
+			close();
+			return false;
+		}
+
+		m_pData = static_cast<const std::uint8_t*>( MapViewOfFile( m_mappingHandle, FILE_MAP_READ, 0, 0, 0 ) );
+		if( m_pData == nullptr )
+		{
+			close();
+			return false;
+		}
+
+		m_size = static_cast<std::size_t>( fileSize.QuadPart );
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if( m_pData )
+			UnmapViewOfFile( m_pData );
+		if( m_mappingHandle )
+			CloseHandle( m_mappingHandle );
+		if( m_fileHandle )
+			CloseHandle( m_fileHandle );
+
+		m_pData = nullptr;
+		m_mappingHandle = nullptr;
+		m_fileHandle = nullptr;
+		m_size = 0;
+	}
+#else
+	bool MappedFile::open( const std::filesystem::path& filePath )
+	{
+		close();
+
+		m_fileDescriptor = ::open( filePath.c_str(), O_RDONLY );
+		if( m_fileDescriptor < 0 )
+			return false;
+
+		struct stat fileStat;
+		if( fstat( m_fileDescriptor, &fileStat ) != 0 || fileStat.st_size == 0 )
+		{
+			close();
+			return false;
+		}
+
+		void* pMapping = mmap( nullptr, static_cast<std::size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0 );
+		if( pMapping == MAP_FAILED )
+		{
+			close();
+			return false;
+		}
+
+		m_pData = static_cast<const std::uint8_t*>( pMapping );
+		m_size = static_cast<std::size_t>( fileStat.st_size );
+		// the file is read front to back, let the kernel read ahead
+		madvise( pMapping, m_size, MADV_SEQUENTIAL );
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if( m_pData )
+			munmap( const_cast<std::uint8_t*>( m_pData ), m_size );
+		if( m_fileDescriptor >= 0 )
+			::close( m_fileDescriptor );
+
+		m_pData = nullptr;
+		m_fileDescriptor = -1;
+		m_size = 0;
+	}
+#endif
+
+	bool MappedFile::isOpen() const
+	{
+		return m_pData != nullptr;
+	}
+
+	const std::uint8_t* MappedFile::getData() const
+	{
+		return m_pData;
+	}
+
+	std::size_t MappedFile::getSize() const
+	{
+		return m_size;
+	}
+
+} // namespace utils
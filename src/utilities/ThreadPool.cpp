@@ -0,0 +1,112 @@
+#include "utilities/ThreadPool.h"
+#include "utilities/CpuTracer.h"
+
+#include <spdlog/fmt/fmt.h>
+
+namespace utils
+{
+	ThreadPool::ThreadPool( const std::uint32_t& workerCount )
+		:m_dispatchIndex{ 0 }
+		,m_busyWorkerCount{ 0 }
+		,m_bStopping{ false }
+		,m_pTask{ nullptr }
+		,m_taskCount{ 0 }
+		,m_nextTaskIndex{ 0 }
+	{
+		m_workers.reserve( workerCount );
+		for( std::uint32_t threadSlot = 0u; threadSlot < workerCount; threadSlot++ )
+		{
+			m_workers.emplace_back( [this, threadSlot](){ workerLoop( threadSlot ); } );
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> poolLock{ m_mutex };
+			m_bStopping = true;
+		}
+		m_workAvailable.notify_all();
+
+		for( auto& worker : m_workers )
+		{
+			worker.join();
+		}
+	}
+
+	void ThreadPool::dispatch( const std::uint32_t& taskCount, const Task& task )
+	{
+		if( taskCount == 0 )
+			return;
+
+		// not worth waking anyone for
+		if( taskCount == 1 || m_workers.empty() )
+		{
+			for( std::uint32_t taskIndex = 0u; taskIndex < taskCount; taskIndex++ )
+				task( taskIndex, getThreadSlotCount() - 1 );
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> poolLock{ m_mutex };
+			m_pTask = &task;
+			m_taskCount = taskCount;
+			m_nextTaskIndex.store( 0, std::memory_order_relaxed );
+			m_busyWorkerCount = static_cast<std::uint32_t>( m_workers.size() );
+			m_dispatchIndex++;
+		}
+		m_workAvailable.notify_all();
+
+		runTasks( getThreadSlotCount() - 1 );
+
+		std::unique_lock<std::mutex> poolLock{ m_mutex };
+		m_workDone.wait( poolLock, [this](){ return m_busyWorkerCount == 0; } );
+		m_pTask = nullptr;
+	}
+
+	std::uint32_t ThreadPool::getThreadSlotCount() const
+	{
+		return static_cast<std::uint32_t>( m_workers.size() ) + 1;
+	}
+
+	void ThreadPool::workerLoop( const std::uint32_t& threadSlot )
+	{
+		CpuTracer::setThreadName( fmt::format( "worker {}", threadSlot ) );
+
+		std::uint64_t lastDispatchIndex = 0;
+		while( true )
+		{
+			{
+				std::unique_lock<std::mutex> poolLock{ m_mutex };
+				m_workAvailable.wait( poolLock, [this, &lastDispatchIndex](){ return m_bStopping || m_dispatchIndex != lastDispatchIndex; } );
+				if( m_bStopping )
+					return;
+				lastDispatchIndex = m_dispatchIndex;
+			}
+
+			runTasks( threadSlot );
+
+			bool bLastWorker;
+			{
+				std::lock_guard<std::mutex> poolLock{ m_mutex };
+				bLastWorker = --m_busyWorkerCount == 0;
+			}
+			if( bLastWorker )
+				m_workDone.notify_one();
+		}
+	}
+
+	void ThreadPool::runTasks( const std::uint32_t& threadSlot )
+	{
+		// tasks are handed out one index at a time, a slow task does not hold up the ones behind it
+		for(
+			std::uint32_t taskIndex = m_nextTaskIndex.fetch_add( 1, std::memory_order_relaxed );
+			taskIndex < m_taskCount;
+			taskIndex = m_nextTaskIndex.fetch_add( 1, std::memory_order_relaxed )
+		)
+		{
+			( *m_pTask )( taskIndex, threadSlot );
+		}
+	}
+
+} // namespace utils
@@ -0,0 +1,53 @@
+#include "vkrenderer/VulkanDeletionQueue.h"
+
+#include <algorithm>
+
+namespace vkrender
+{
+	VulkanDeletionQueue::~VulkanDeletionQueue()
+	{
+		flush();
+	}
+
+	void VulkanDeletionQueue::retire( const std::uint64_t& lastUsedFrameValue, std::function<void()> deleter )
+	{
+		// objects retired past the current frame, like an old swapchain, are slotted in so collect stays a front scan
+		auto insertIt = std::upper_bound(
+			m_retiredObjects.begin(), m_retiredObjects.end(), lastUsedFrameValue,
+			[]( const std::uint64_t& frameValue, const RetiredObject& retiredObject ) { return frameValue < retiredObject.m_lastUsedFrameValue; }
+		);
+		m_retiredObjects.insert( insertIt, RetiredObject{ lastUsedFrameValue, std::move(deleter) } );
+		m_totalRetiredCount++;
+	}
+
+	void VulkanDeletionQueue::collect( const std::uint64_t& completedFrameValue )
+	{
+		while( !m_retiredObjects.empty() && m_retiredObjects.front().m_lastUsedFrameValue <= completedFrameValue )
+		{
+			RetiredObject retiredObject = std::move( m_retiredObjects.front() );
+			m_retiredObjects.pop_front();
+			retiredObject.m_deleter();
+		}
+	}
+
+	void VulkanDeletionQueue::flush()
+	{
+		while( !m_retiredObjects.empty() )
+		{
+			RetiredObject retiredObject = std::move( m_retiredObjects.front() );
+			m_retiredObjects.pop_front();
+			retiredObject.m_deleter();
+		}
+	}
+
+	std::size_t VulkanDeletionQueue::getPendingCount() const
+	{
+		return m_retiredObjects.size();
+	}
+
+	std::uint64_t VulkanDeletionQueue::getTotalRetiredCount() const
+	{
+		return m_totalRetiredCount;
+	}
+
+} // namespace vkrender
@@ -0,0 +1,182 @@
+#include "vkrenderer/VulkanDeviceCapabilities.h"
+#include "utilities/VulkanLogger.h"
+
+#include <string_view>
+
+namespace vkrender
+{
+	DeviceCapabilities::DeviceCapabilities( const vk::PhysicalDevice& physicalDevice, const vk::SurfaceKHR* pSurface )
+		:m_vkPhysicalDevice{ physicalDevice }
+		,m_vkProperties{ physicalDevice.getProperties() }
+		,m_vkFeatures{ physicalDevice.getFeatures() }
+		,m_vkMemoryProperties{ physicalDevice.getMemoryProperties() }
+		,m_queueFamilyProperties{ physicalDevice.getQueueFamilyProperties() }
+	{
+		for( std::uint32_t familyIndex = 0u; familyIndex < m_queueFamilyProperties.size(); familyIndex++ )
+		{
+			const vk::QueueFlags& queueFlags = m_queueFamilyProperties[familyIndex].queueFlags;
+
+			if( queueFlags & vk::QueueFlagBits::eGraphics )
+			{
+				m_queueFamilyIndices.m_graphicsFamily = familyIndex;
+			}
+
+			if( queueFlags & vk::QueueFlagBits::eCompute )
+			{
+				m_queueFamilyIndices.m_computeFamily = familyIndex;
+			}
+
+			if( 
+				queueFlags & vk::QueueFlagBits::eTransfer && 
+				( !( queueFlags & vk::QueueFlagBits::eGraphics ) && !( queueFlags & vk::QueueFlagBits::eCompute ) )
+			)
+			{
+				m_queueFamilyIndices.m_exclusiveTransferFamily = familyIndex;
+			}
+
+			if( pSurface && physicalDevice.getSurfaceSupportKHR( familyIndex, *pSurface ) )
+			{
+				m_queueFamilyIndices.m_presentFamily = familyIndex;
+			}
+		}
+
+		if( m_vkProperties.apiVersion >= VK_API_VERSION_1_3 )
+		{
+			auto featureChain = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan13Features>();
+			m_bDynamicRendering = static_cast<bool>( featureChain.get<vk::PhysicalDeviceVulkan13Features>().dynamicRendering );
+		}
+
+		if( pSurface )
+		{
+			bool bPresentIdExtension = false;
+			bool bPresentWaitExtension = false;
+			for( const auto& extensionProperties : physicalDevice.enumerateDeviceExtensionProperties() )
+			{
+				std::string_view extensionName{ extensionProperties.extensionName.data() };
+				bPresentIdExtension |= extensionName == VK_KHR_PRESENT_ID_EXTENSION_NAME;
+				bPresentWaitExtension |= extensionName == VK_KHR_PRESENT_WAIT_EXTENSION_NAME;
+			}
+
+			// the feature structs may only be chained once the extensions are known to exist
+			if( bPresentIdExtension && bPresentWaitExtension )
+			{
+				auto featureChain = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>();
+				m_bPresentWait =
+					featureChain.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId &&
+					featureChain.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+			}
+		}
+
+		for( const vk::Format& format : SNAPSHOT_FORMATS )
+			m_formatProperties.emplace( format, physicalDevice.getFormatProperties( format ) );
+
+		if( m_queueFamilyIndices.m_graphicsFamily.has_value() ) m_sharedQueueFamilies.emplace_back( m_queueFamilyIndices.m_graphicsFamily.value() );
+		if( m_queueFamilyIndices.m_exclusiveTransferFamily.has_value() ) m_sharedQueueFamilies.emplace_back( m_queueFamilyIndices.m_exclusiveTransferFamily.value() );
+	}
+
+	const vk::PhysicalDevice& DeviceCapabilities::getPhysicalDevice() const
+	{
+		return m_vkPhysicalDevice;
+	}
+
+	const vk::PhysicalDeviceProperties& DeviceCapabilities::getProperties() const
+	{
+		return m_vkProperties;
+	}
+
+	const vk::PhysicalDeviceFeatures& DeviceCapabilities::getFeatures() const
+	{
+		return m_vkFeatures;
+	}
+
+	const vk::PhysicalDeviceLimits& DeviceCapabilities::getLimits() const
+	{
+		return m_vkProperties.limits;
+	}
+
+	const vk::PhysicalDeviceMemoryProperties& DeviceCapabilities::getMemoryProperties() const
+	{
+		return m_vkMemoryProperties;
+	}
+
+	const std::vector<vk::QueueFamilyProperties>& DeviceCapabilities::getQueueFamilyProperties() const
+	{
+		return m_queueFamilyProperties;
+	}
+
+	const QueueFamilyIndices& DeviceCapabilities::getQueueFamilyIndices() const
+	{
+		return m_queueFamilyIndices;
+	}
+
+	const std::vector<std::uint32_t>& DeviceCapabilities::getSharedQueueFamilies() const
+	{
+		return m_sharedQueueFamilies;
+	}
+
+	bool DeviceCapabilities::supportsDynamicRendering() const
+	{
+		return m_bDynamicRendering;
+	}
+
+	bool DeviceCapabilities::supportsPresentWait() const
+	{
+		return m_bPresentWait;
+	}
+
+	const vk::FormatProperties& DeviceCapabilities::getFormatProperties( const vk::Format& format ) const
+	{
+		auto formatIt = m_formatProperties.find( format );
+		if( formatIt == m_formatProperties.end() )
+		{
+			std::string errorMsg = fmt::format( "format {} is not part of the device capabilities snapshot", vk::to_string( format ) );
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		return formatIt->second;
+	}
+
+	std::uint32_t DeviceCapabilities::findMemoryType( const std::uint32_t& typeFilter, const vk::MemoryPropertyFlags& propertyFlags, const vk::MemoryPropertyFlags& preferredFlags ) const
+	{
+		auto l_findMatchingType = [this, &typeFilter]( const vk::MemoryPropertyFlags& flags ) -> std::int32_t {
+			for( auto i = 0u; i < m_vkMemoryProperties.memoryTypeCount; i++ )
+			{
+				if( 
+					( typeFilter & ( 1u << i ) ) &&
+					( m_vkMemoryProperties.memoryTypes[i].propertyFlags & flags ) == flags 
+				)
+				{
+					return static_cast<std::int32_t>( i );
+				}
+			}
+			return -1;
+		};
+
+		std::int32_t memoryTypeIndex = l_findMatchingType( propertyFlags | preferredFlags );
+		if( memoryTypeIndex < 0 && preferredFlags )
+			memoryTypeIndex = l_findMatchingType( propertyFlags );
+
+		if( memoryTypeIndex >= 0 )
+			return static_cast<std::uint32_t>( memoryTypeIndex );
+
+		std::string errorMsg{ "failed to find suitable memory type" };
+		LOG_ERROR(errorMsg);
+		throw std::runtime_error(errorMsg);
+	}
+
+	vk::SampleCountFlagBits DeviceCapabilities::getMaxUsableSampleCount() const
+	{
+		vk::SampleCountFlags counts = m_vkProperties.limits.framebufferColorSampleCounts & m_vkProperties.limits.framebufferDepthSampleCounts;
+
+		if( counts & vk::SampleCountFlagBits::e64 ) { return vk::SampleCountFlagBits::e64; }
+		if( counts & vk::SampleCountFlagBits::e32 ) { return vk::SampleCountFlagBits::e32; }
+		if( counts & vk::SampleCountFlagBits::e16 ) { return vk::SampleCountFlagBits::e16; }
+		if( counts & vk::SampleCountFlagBits::e8 ) { return vk::SampleCountFlagBits::e8; }
+		if( counts & vk::SampleCountFlagBits::e4 ) { return vk::SampleCountFlagBits::e4; }
+		if( counts & vk::SampleCountFlagBits::e2 ) { return vk::SampleCountFlagBits::e2; }
+
+		return vk::SampleCountFlagBits::e1;
+	}
+
+} // namespace vkrender
@@ -0,0 +1,112 @@
+#include "vkrenderer/VulkanFramePacer.h"
+#include "utilities/VulkanLogger.h"
+
+#include <thread>
+
+namespace vkrender
+{
+	namespace
+	{
+		// covers the wake up latency of a sleep on common schedulers, the remainder is spun
+		constexpr std::chrono::microseconds SPIN_THRESHOLD{ 2000 };
+		// a hidden or minimised window may never display a present, give up on it rather than stall the loop
+		constexpr std::uint64_t PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+	}
+
+	VulkanFramePacer::VulkanFramePacer( const vk::Device& logicalDevice, const bool& bPresentWait, const double& frameRateLimit, const std::uint32_t& maxQueuedPresents )
+		:m_vkLogicalDevice{ logicalDevice }
+		,m_pfnWaitForPresent{ nullptr }
+		,m_frameInterval{ Clock::duration::zero() }
+		,m_maxQueuedPresents{ maxQueuedPresents }
+		,m_lastPresentId{ 0 }
+	{
+		// not exported by the loader, only reachable through the device
+		if( bPresentWait )
+			m_pfnWaitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>( m_vkLogicalDevice.getProcAddr( "vkWaitForPresentKHR" ) );
+
+		if( frameRateLimit > 0.0 )
+			m_frameInterval = std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( 1.0 / frameRateLimit ) );
+	}
+
+	void VulkanFramePacer::setSwapchain( const vk::SwapchainKHR& swapchain )
+	{
+		m_vkSwapchain = swapchain;
+		m_pendingPresents.clear();
+	}
+
+	bool VulkanFramePacer::waitForQueuedPresents( double& inputToDisplayMs )
+	{
+		if( !isPresentWaitEnabled() || m_maxQueuedPresents == 0 || m_pendingPresents.size() < m_maxQueuedPresents )
+			return false;
+
+		// presents reach the display in order, waiting on the oldest one is enough to make room
+		PendingPresent oldestPresent = m_pendingPresents.front();
+		m_pendingPresents.pop_front();
+
+		// an already displayed present says nothing about when it got there
+		vk::Result opResult = waitForPresent( oldestPresent.m_presentId, 0 );
+		if( opResult != vk::Result::eTimeout )
+			return false;
+
+		opResult = waitForPresent( oldestPresent.m_presentId, PRESENT_WAIT_TIMEOUT_NS );
+		if( opResult == vk::Result::eErrorDeviceLost )
+		{
+			std::string errorMsg = "DEVICE LOST WHILE WAITING FOR PRESENT";
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+		// out of date swapchains are recreated by the next acquire or present, a timeout just drops the sample
+		if( opResult != vk::Result::eSuccess && opResult != vk::Result::eSuboptimalKHR )
+			return false;
+
+		inputToDisplayMs = std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - oldestPresent.m_inputSampleTime ).count();
+		return true;
+	}
+
+	void VulkanFramePacer::waitForFrameRateLimit()
+	{
+		if( m_frameInterval == Clock::duration::zero() )
+			return;
+
+		Clock::time_point now = Clock::now();
+		if( m_nextFrameTime.time_since_epoch().count() != 0 && now < m_nextFrameTime )
+		{
+			if( m_nextFrameTime - now > SPIN_THRESHOLD )
+				std::this_thread::sleep_for( m_nextFrameTime - now - SPIN_THRESHOLD );
+
+			while( Clock::now() < m_nextFrameTime )
+				std::this_thread::yield();
+		}
+
+		// a frame that ran long restarts the schedule instead of letting the following ones catch up in a burst
+		now = Clock::now();
+		m_nextFrameTime += m_frameInterval;
+		if( m_nextFrameTime < now )
+			m_nextFrameTime = now + m_frameInterval;
+	}
+
+	std::uint64_t VulkanFramePacer::beginPresent( const std::chrono::high_resolution_clock::time_point& inputSampleTime )
+	{
+		if( !isPresentWaitEnabled() )
+			return 0;
+
+		m_pendingPresents.push_back( PendingPresent{ ++m_lastPresentId, inputSampleTime } );
+		return m_lastPresentId;
+	}
+
+	bool VulkanFramePacer::isPresentWaitEnabled() const
+	{
+		return m_pfnWaitForPresent != nullptr;
+	}
+
+	vk::Result VulkanFramePacer::waitForPresent( const std::uint64_t& presentId, const std::uint64_t& timeoutNs ) const
+	{
+		return static_cast<vk::Result>( m_pfnWaitForPresent(
+			static_cast<VkDevice>( m_vkLogicalDevice ),
+			static_cast<VkSwapchainKHR>( m_vkSwapchain ),
+			presentId,
+			timeoutNs
+		) );
+	}
+
+} // namespace vkrender
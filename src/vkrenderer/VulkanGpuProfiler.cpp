@@ -0,0 +1,252 @@
+#include "vkrenderer/VulkanGpuProfiler.h"
+#include "utilities/VulkanLogger.h"
+
+#include <array>
+#include <limits>
+
+namespace vkrender
+{
+	namespace
+	{
+		// results come back in bit order, which matches the PipelineStatistics member order
+		constexpr vk::QueryPipelineStatisticFlags PIPELINE_STATISTIC_FLAGS =
+			vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+			vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+			vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+			vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+			vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+		constexpr std::uint32_t PIPELINE_STATISTIC_COUNT = 5;
+	}
+
+	VulkanGpuProfiler::VulkanGpuProfiler(
+		const vk::Device& logicalDevice,
+		const std::uint32_t& frameSlotCount,
+		const double& timestampPeriodNs,
+		const std::uint32_t& timestampValidBits,
+		const bool& bPipelineStatistics,
+		const std::uint32_t& maxScopesPerFrame
+	)
+		:m_vkLogicalDevice{ logicalDevice }
+		,m_timestampPeriodNs{ timestampPeriodNs }
+		,m_timestampValidMask{ timestampValidBits >= 64 ? std::numeric_limits<std::uint64_t>::max() : ( 1ull << timestampValidBits ) - 1 }
+		,m_bPipelineStatistics{ bPipelineStatistics }
+		,m_maxScopesPerFrame{ maxScopesPerFrame }
+		,m_frameSlots( frameSlotCount )
+		,m_recordingSlot{ 0 }
+		,m_openScopeDepth{ 0 }
+		,m_pipelineStatisticsFrameCount{ 0 }
+	{
+		for( auto& frameSlot : m_frameSlots )
+		{
+			// a queue without valid timestamp bits still gets pipeline statistics, scopes are skipped
+			if( timestampValidBits > 0 )
+			{
+				vk::QueryPoolCreateInfo timestampPoolInfo{};
+				timestampPoolInfo.queryType = vk::QueryType::eTimestamp;
+				timestampPoolInfo.queryCount = 2 * m_maxScopesPerFrame;
+
+				frameSlot.m_vkTimestampQueryPool = m_vkLogicalDevice.createQueryPool( timestampPoolInfo );
+			}
+
+			if( m_bPipelineStatistics )
+			{
+				vk::QueryPoolCreateInfo statisticsPoolInfo{};
+				statisticsPoolInfo.queryType = vk::QueryType::ePipelineStatistics;
+				statisticsPoolInfo.queryCount = 1;
+				statisticsPoolInfo.pipelineStatistics = PIPELINE_STATISTIC_FLAGS;
+
+				frameSlot.m_vkPipelineStatisticsQueryPool = m_vkLogicalDevice.createQueryPool( statisticsPoolInfo );
+			}
+		}
+	}
+
+	VulkanGpuProfiler::~VulkanGpuProfiler()
+	{
+		destroy();
+	}
+
+	void VulkanGpuProfiler::beginFrame( const vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& frameSlot, const std::uint64_t& frameValue )
+	{
+		FrameSlot& slot = m_frameSlots[frameSlot];
+		slot.m_scopes.clear();
+		slot.m_frameValue = frameValue;
+		slot.m_bPipelineStatisticsRecorded = false;
+		slot.m_bPending = true;
+
+		m_recordingSlot = frameSlot;
+		m_openScopeDepth = 0;
+
+		if( slot.m_vkTimestampQueryPool )
+			vkCommandBuffer.resetQueryPool( slot.m_vkTimestampQueryPool, 0, 2 * m_maxScopesPerFrame );
+		if( slot.m_vkPipelineStatisticsQueryPool )
+			vkCommandBuffer.resetQueryPool( slot.m_vkPipelineStatisticsQueryPool, 0, 1 );
+	}
+
+	void VulkanGpuProfiler::resubmitFrame( const std::uint32_t& frameSlot, const std::uint64_t& frameValue )
+	{
+		// the queries are reset inside the command buffer, only the bookkeeping needs re-arming
+		FrameSlot& slot = m_frameSlots[frameSlot];
+		slot.m_frameValue = frameValue;
+		slot.m_bPending = true;
+	}
+
+	std::uint32_t VulkanGpuProfiler::beginScope( const vk::CommandBuffer& vkCommandBuffer, const std::string& scopeName, const vk::PipelineStageFlagBits& stage )
+	{
+		FrameSlot& slot = m_frameSlots[m_recordingSlot];
+		if( !slot.m_vkTimestampQueryPool || slot.m_scopes.size() >= m_maxScopesPerFrame )
+			return INVALID_SCOPE;
+
+		std::uint32_t scopeIndex = static_cast<std::uint32_t>( slot.m_scopes.size() );
+		slot.m_scopes.push_back( RecordedScope{ scopeName, m_openScopeDepth++, false } );
+
+		vkCommandBuffer.writeTimestamp( stage, slot.m_vkTimestampQueryPool, 2 * scopeIndex );
+		return scopeIndex;
+	}
+
+	void VulkanGpuProfiler::endScope( const vk::CommandBuffer& vkCommandBuffer, const std::uint32_t& scopeIndex, const vk::PipelineStageFlagBits& stage )
+	{
+		if( scopeIndex == INVALID_SCOPE )
+			return;
+
+		FrameSlot& slot = m_frameSlots[m_recordingSlot];
+		vkCommandBuffer.writeTimestamp( stage, slot.m_vkTimestampQueryPool, 2 * scopeIndex + 1 );
+		slot.m_scopes[scopeIndex].m_bEnded = true;
+		m_openScopeDepth--;
+	}
+
+	void VulkanGpuProfiler::beginPipelineStatistics( const vk::CommandBuffer& vkCommandBuffer )
+	{
+		FrameSlot& slot = m_frameSlots[m_recordingSlot];
+		if( !slot.m_vkPipelineStatisticsQueryPool || slot.m_bPipelineStatisticsRecorded )
+			return;
+
+		vkCommandBuffer.beginQuery( slot.m_vkPipelineStatisticsQueryPool, 0, {} );
+	}
+
+	void VulkanGpuProfiler::endPipelineStatistics( const vk::CommandBuffer& vkCommandBuffer )
+	{
+		FrameSlot& slot = m_frameSlots[m_recordingSlot];
+		if( !slot.m_vkPipelineStatisticsQueryPool || slot.m_bPipelineStatisticsRecorded )
+			return;
+
+		vkCommandBuffer.endQuery( slot.m_vkPipelineStatisticsQueryPool, 0 );
+		slot.m_bPipelineStatisticsRecorded = true;
+	}
+
+	bool VulkanGpuProfiler::collect( const std::uint32_t& frameSlot )
+	{
+		FrameSlot& slot = m_frameSlots[frameSlot];
+		if( !slot.m_bPending )
+			return false;
+
+		// no wait flag, an unfinished frame reports not ready and is picked up on a later call
+		std::uint32_t timestampCount = static_cast<std::uint32_t>( slot.m_scopes.size() ) * 2;
+		std::vector<std::uint64_t> timestamps( timestampCount );
+		if( timestampCount > 0 )
+		{
+			vk::Result opResult = m_vkLogicalDevice.getQueryPoolResults(
+				slot.m_vkTimestampQueryPool, 0, timestampCount,
+				timestamps.size() * sizeof(std::uint64_t), timestamps.data(), sizeof(std::uint64_t),
+				vk::QueryResultFlagBits::e64
+			);
+			if( opResult != vk::Result::eSuccess )
+				return false;
+		}
+
+		std::array<std::uint64_t, PIPELINE_STATISTIC_COUNT> statistics{};
+		if( slot.m_bPipelineStatisticsRecorded )
+		{
+			vk::Result opResult = m_vkLogicalDevice.getQueryPoolResults(
+				slot.m_vkPipelineStatisticsQueryPool, 0, 1,
+				sizeof(statistics), statistics.data(), sizeof(statistics),
+				vk::QueryResultFlagBits::e64
+			);
+			if( opResult != vk::Result::eSuccess )
+				return false;
+		}
+
+		slot.m_bPending = false;
+
+		m_latestResult.m_frameValue = slot.m_frameValue;
+		m_latestResult.m_scopes.clear();
+		for( std::uint32_t scopeIndex = 0u; scopeIndex < slot.m_scopes.size(); scopeIndex++ )
+		{
+			const RecordedScope& scope = slot.m_scopes[scopeIndex];
+			if( !scope.m_bEnded )
+			{
+				LOG_ERROR( fmt::format("GPU profiler scope {} was never ended, dropping it", scope.m_name) );
+				continue;
+			}
+
+			std::uint64_t beginTicks = timestamps[2 * scopeIndex] & m_timestampValidMask;
+			std::uint64_t endTicks = timestamps[2 * scopeIndex + 1] & m_timestampValidMask;
+			double durationMs = static_cast<double>( ( endTicks - beginTicks ) & m_timestampValidMask ) * m_timestampPeriodNs / 1.0e6;
+
+			m_latestResult.m_scopes.push_back( ScopeResult{ scope.m_name, scope.m_depth, durationMs } );
+			m_scopeSamplesMs[scope.m_name].push_back( durationMs );
+		}
+
+		m_latestResult.m_bHasPipelineStatistics = slot.m_bPipelineStatisticsRecorded;
+		if( slot.m_bPipelineStatisticsRecorded )
+		{
+			PipelineStatistics& frameStatistics = m_latestResult.m_pipelineStatistics;
+			frameStatistics.m_inputAssemblyVertices = statistics[0];
+			frameStatistics.m_inputAssemblyPrimitives = statistics[1];
+			frameStatistics.m_vertexShaderInvocations = statistics[2];
+			frameStatistics.m_clippingPrimitives = statistics[3];
+			frameStatistics.m_fragmentShaderInvocations = statistics[4];
+
+			m_pipelineStatisticsTotals.m_inputAssemblyVertices += statistics[0];
+			m_pipelineStatisticsTotals.m_inputAssemblyPrimitives += statistics[1];
+			m_pipelineStatisticsTotals.m_vertexShaderInvocations += statistics[2];
+			m_pipelineStatisticsTotals.m_clippingPrimitives += statistics[3];
+			m_pipelineStatisticsTotals.m_fragmentShaderInvocations += statistics[4];
+			m_pipelineStatisticsFrameCount++;
+		}
+
+		return true;
+	}
+
+	void VulkanGpuProfiler::resetSamples()
+	{
+		m_scopeSamplesMs.clear();
+		m_pipelineStatisticsTotals = PipelineStatistics{};
+		m_pipelineStatisticsFrameCount = 0;
+	}
+
+	void VulkanGpuProfiler::destroy()
+	{
+		for( auto& frameSlot : m_frameSlots )
+		{
+			m_vkLogicalDevice.destroyQueryPool( frameSlot.m_vkTimestampQueryPool );
+			m_vkLogicalDevice.destroyQueryPool( frameSlot.m_vkPipelineStatisticsQueryPool );
+		}
+		m_frameSlots.clear();
+	}
+
+	bool VulkanGpuProfiler::hasPipelineStatistics() const
+	{
+		return m_bPipelineStatistics;
+	}
+
+	const VulkanGpuProfiler::FrameResult& VulkanGpuProfiler::getLatestResult() const
+	{
+		return m_latestResult;
+	}
+
+	const std::map<std::string, std::vector<double>>& VulkanGpuProfiler::getScopeSamples() const
+	{
+		return m_scopeSamplesMs;
+	}
+
+	const VulkanGpuProfiler::PipelineStatistics& VulkanGpuProfiler::getPipelineStatisticsTotals() const
+	{
+		return m_pipelineStatisticsTotals;
+	}
+
+	std::uint64_t VulkanGpuProfiler::getPipelineStatisticsFrameCount() const
+	{
+		return m_pipelineStatisticsFrameCount;
+	}
+
+} // namespace vkrender
@@ -0,0 +1,459 @@
+#include "vkrenderer/VulkanMemoryAllocator.h"
+#include "utilities/VulkanLogger.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace vkrender
+{
+	struct VulkanMemoryBlock
+	{
+		struct Region
+		{
+			vk::DeviceSize			m_size;
+			vk::DeviceSize			m_padding;
+			bool					m_bFree;
+			AllocationResourceType	m_resourceType;
+		};
+
+		vk::DeviceMemory		m_memory;
+		vk::DeviceSize			m_size;
+		void*					m_pMappedData;
+		std::uint32_t			m_memoryTypeIndex;
+		AllocationStrategy		m_strategy;
+		bool					m_bDedicated;
+
+		// free-list strategy, regions keyed on their start offset and covering the whole block
+		std::map<vk::DeviceSize, Region> m_regions;
+
+		// linear strategy
+		vk::DeviceSize			m_linearHead;
+		AllocationResourceType	m_lastLinearResourceType;
+
+		std::uint32_t			m_liveAllocations;
+		vk::DeviceSize			m_usedBytes;
+		vk::DeviceSize			m_paddingBytes;
+	};
+
+	namespace
+	{
+		vk::DeviceSize alignUp( const vk::DeviceSize& value, const vk::DeviceSize& alignment )
+		{
+			if( alignment <= 1 )
+				return value;
+			return ( value + alignment - 1 ) & ~( alignment - 1 );
+		}
+
+		bool isOnSamePage(
+			const vk::DeviceSize& resourceAOffset, const vk::DeviceSize& resourceASize,
+			const vk::DeviceSize& resourceBOffset, const vk::DeviceSize& pageSize
+		)
+		{
+			vk::DeviceSize resourceAEndPage = ( resourceAOffset + resourceASize - 1 ) & ~( pageSize - 1 );
+			vk::DeviceSize resourceBStartPage = resourceBOffset & ~( pageSize - 1 );
+			return resourceAEndPage == resourceBStartPage;
+		}
+	}
+
+	VulkanMemoryAllocator::VulkanMemoryAllocator(
+		const vk::Device& logicalDevice,
+		const vk::PhysicalDeviceMemoryProperties& memoryProperties,
+		const vk::DeviceSize& bufferImageGranularity,
+		const vk::DeviceSize& preferredBlockSize
+	)
+		:m_vkLogicalDevice{ logicalDevice }
+		,m_vkMemoryProperties{ memoryProperties }
+		,m_bufferImageGranularity{ std::max<vk::DeviceSize>( bufferImageGranularity, 1 ) }
+		,m_preferredBlockSize{ preferredBlockSize }
+		,m_memoryTypePools( memoryProperties.memoryTypeCount )
+		,m_totalDeviceMemoryAllocations{ 0 }
+		,m_totalSubAllocations{ 0 }
+	{}
+
+	VulkanMemoryAllocator::~VulkanMemoryAllocator()
+	{
+		destroy();
+	}
+
+	VulkanAllocation VulkanMemoryAllocator::allocate(
+		const vk::MemoryRequirements& memRequirements,
+		const std::uint32_t& memoryTypeIndex,
+		const AllocationResourceType& resourceType,
+		const AllocationStrategy& strategy
+	)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		VulkanAllocation allocation{};
+		vk::DeviceSize blockSize = blockSizeForMemoryType( memoryTypeIndex );
+
+		auto l_allocateFromBlock = [&]( VulkanMemoryBlock* pBlock ) -> bool {
+			if( pBlock->m_strategy == AllocationStrategy::eLinear )
+				return allocateFromLinear( pBlock, memRequirements, resourceType, allocation );
+			return allocateFromFreeList( pBlock, memRequirements, resourceType, allocation );
+		};
+
+		if( memRequirements.size > blockSize / 2 )
+		{
+			VulkanMemoryBlock* pDedicatedBlock = createBlock( memoryTypeIndex, memRequirements.size, AllocationStrategy::eFreeList, true );
+			l_allocateFromBlock( pDedicatedBlock );
+			m_totalSubAllocations++;
+			return allocation;
+		}
+
+		for( auto& upBlock : m_memoryTypePools[memoryTypeIndex] )
+		{
+			if( upBlock->m_bDedicated || upBlock->m_strategy != strategy )
+				continue;
+
+			if( l_allocateFromBlock( upBlock.get() ) )
+			{
+				m_totalSubAllocations++;
+				return allocation;
+			}
+		}
+
+		VulkanMemoryBlock* pBlock = createBlock( memoryTypeIndex, blockSize, strategy, false );
+		if( !l_allocateFromBlock( pBlock ) )
+		{
+			std::string errorMsg = "FAILED TO SUB-ALLOCATE FROM A FRESH MEMORY BLOCK";
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+		m_totalSubAllocations++;
+
+		return allocation;
+	}
+
+	void VulkanMemoryAllocator::free( VulkanAllocation& allocation )
+	{
+		if( !allocation.isValid() )
+			return;
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		VulkanMemoryBlock* pBlock = allocation.m_pBlock;
+
+		if( pBlock->m_strategy == AllocationStrategy::eLinear )
+		{
+			pBlock->m_liveAllocations--;
+			pBlock->m_usedBytes -= allocation.m_size;
+			// linear blocks only rewind once everything in them is released
+			if( pBlock->m_liveAllocations == 0 )
+			{
+				pBlock->m_linearHead = 0;
+				pBlock->m_paddingBytes = 0;
+			}
+		}
+		else
+		{
+			auto regionItr = pBlock->m_regions.upper_bound( allocation.m_offset );
+			regionItr = std::prev( regionItr );
+
+			VulkanMemoryBlock::Region& region = regionItr->second;
+			region.m_bFree = true;
+			pBlock->m_liveAllocations--;
+			pBlock->m_usedBytes -= allocation.m_size;
+			pBlock->m_paddingBytes -= region.m_padding;
+			region.m_padding = 0;
+
+			auto nextItr = std::next( regionItr );
+			if( nextItr != pBlock->m_regions.end() && nextItr->second.m_bFree )
+			{
+				region.m_size += nextItr->second.m_size;
+				pBlock->m_regions.erase( nextItr );
+			}
+
+			if( regionItr != pBlock->m_regions.begin() )
+			{
+				auto prevItr = std::prev( regionItr );
+				if( prevItr->second.m_bFree )
+				{
+					prevItr->second.m_size += region.m_size;
+					pBlock->m_regions.erase( regionItr );
+				}
+			}
+		}
+
+		releaseBlockIfUnused( pBlock );
+
+		allocation = VulkanAllocation{};
+	}
+
+	void VulkanMemoryAllocator::destroy()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		for( auto& memoryTypePool : m_memoryTypePools )
+		{
+			for( auto& upBlock : memoryTypePool )
+			{
+				if( upBlock->m_pMappedData )
+					m_vkLogicalDevice.unmapMemory( upBlock->m_memory );
+				m_vkLogicalDevice.freeMemory( upBlock->m_memory );
+			}
+			memoryTypePool.clear();
+		}
+	}
+
+	VulkanAllocatorStats VulkanMemoryAllocator::getStats() const
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+
+		VulkanAllocatorStats stats{};
+		stats.m_totalDeviceMemoryAllocations = m_totalDeviceMemoryAllocations;
+		stats.m_totalSubAllocations = m_totalSubAllocations;
+
+		vk::DeviceSize totalFreeBytes = 0;
+		vk::DeviceSize largestFreeRange = 0;
+
+		for( const auto& memoryTypePool : m_memoryTypePools )
+		{
+			for( const auto& upBlock : memoryTypePool )
+			{
+				stats.m_liveBlockCount++;
+				if( upBlock->m_bDedicated ) stats.m_dedicatedBlockCount++;
+				stats.m_liveAllocationCount += upBlock->m_liveAllocations;
+				stats.m_blockBytes += upBlock->m_size;
+				stats.m_usedBytes += upBlock->m_usedBytes;
+
+				if( upBlock->m_strategy == AllocationStrategy::eLinear )
+				{
+					// everything below the head that is not live is unusable until the block rewinds
+					stats.m_wastedBytes += upBlock->m_linearHead - upBlock->m_usedBytes;
+					vk::DeviceSize tailBytes = upBlock->m_size - upBlock->m_linearHead;
+					totalFreeBytes += tailBytes;
+					largestFreeRange = std::max( largestFreeRange, tailBytes );
+				}
+				else
+				{
+					stats.m_wastedBytes += upBlock->m_paddingBytes;
+					for( const auto& [offset, region] : upBlock->m_regions )
+					{
+						if( !region.m_bFree )
+							continue;
+						totalFreeBytes += region.m_size;
+						largestFreeRange = std::max( largestFreeRange, region.m_size );
+					}
+				}
+			}
+		}
+
+		if( totalFreeBytes > 0 )
+			stats.m_fragmentation = 1.0f - static_cast<float>( largestFreeRange ) / static_cast<float>( totalFreeBytes );
+
+		return stats;
+	}
+
+	void VulkanMemoryAllocator::logStats() const
+	{
+		VulkanAllocatorStats stats = getStats();
+
+		LOG_DEBUG( fmt::format(
+			"Allocator: {} live blocks ({} dedicated), {} live allocations, {} vkAllocateMemory calls for {} sub-allocations",
+			stats.m_liveBlockCount, stats.m_dedicatedBlockCount, stats.m_liveAllocationCount,
+			stats.m_totalDeviceMemoryAllocations, stats.m_totalSubAllocations
+		) );
+		LOG_DEBUG( fmt::format(
+			"Allocator: {} bytes reserved, {} bytes used, {} bytes wasted, fragmentation {:.3f}",
+			stats.m_blockBytes, stats.m_usedBytes, stats.m_wastedBytes, stats.m_fragmentation
+		) );
+	}
+
+	VulkanMemoryBlock* VulkanMemoryAllocator::createBlock( const std::uint32_t& memoryTypeIndex, const vk::DeviceSize& blockSize, const AllocationStrategy& strategy, const bool& bDedicated )
+	{
+		vk::MemoryAllocateInfo allocInfo{};
+		allocInfo.allocationSize = blockSize;
+		allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+		utils::Uptr<VulkanMemoryBlock> upBlock = std::make_unique<VulkanMemoryBlock>();
+		upBlock->m_memory = m_vkLogicalDevice.allocateMemory( allocInfo );
+		upBlock->m_size = blockSize;
+		upBlock->m_pMappedData = nullptr;
+		upBlock->m_memoryTypeIndex = memoryTypeIndex;
+		upBlock->m_strategy = strategy;
+		upBlock->m_bDedicated = bDedicated;
+		upBlock->m_linearHead = 0;
+		upBlock->m_lastLinearResourceType = AllocationResourceType::eLinear;
+		upBlock->m_liveAllocations = 0;
+		upBlock->m_usedBytes = 0;
+		upBlock->m_paddingBytes = 0;
+		upBlock->m_regions.emplace( 0, VulkanMemoryBlock::Region{ blockSize, 0, true, AllocationResourceType::eLinear } );
+
+		// host visible blocks stay mapped for their whole lifetime
+		if( m_vkMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible )
+		{
+			upBlock->m_pMappedData = m_vkLogicalDevice.mapMemory( upBlock->m_memory, 0, VK_WHOLE_SIZE );
+		}
+
+		m_totalDeviceMemoryAllocations++;
+
+		VulkanMemoryBlock* pBlock = upBlock.get();
+		m_memoryTypePools[memoryTypeIndex].push_back( std::move(upBlock) );
+
+		return pBlock;
+	}
+
+	void VulkanMemoryAllocator::destroyBlock( VulkanMemoryBlock* pBlock )
+	{
+		MemoryBlockPool& memoryTypePool = m_memoryTypePools[pBlock->m_memoryTypeIndex];
+
+		auto blockItr = std::find_if( memoryTypePool.begin(), memoryTypePool.end(), [pBlock]( const utils::Uptr<VulkanMemoryBlock>& upBlock ){
+			return upBlock.get() == pBlock;
+		} );
+
+		if( blockItr == memoryTypePool.end() )
+			return;
+
+		if( pBlock->m_pMappedData )
+			m_vkLogicalDevice.unmapMemory( pBlock->m_memory );
+		m_vkLogicalDevice.freeMemory( pBlock->m_memory );
+
+		memoryTypePool.erase( blockItr );
+	}
+
+	void VulkanMemoryAllocator::releaseBlockIfUnused( VulkanMemoryBlock* pBlock )
+	{
+		if( pBlock->m_liveAllocations != 0 )
+			return;
+
+		if( pBlock->m_bDedicated )
+		{
+			destroyBlock( pBlock );
+			return;
+		}
+
+		// keep a single empty block per memory type and strategy around to avoid allocation churn
+		const MemoryBlockPool& memoryTypePool = m_memoryTypePools[pBlock->m_memoryTypeIndex];
+		bool bHasOtherEmptyBlock = std::any_of( memoryTypePool.begin(), memoryTypePool.end(), [pBlock]( const utils::Uptr<VulkanMemoryBlock>& upBlock ){
+			return upBlock.get() != pBlock && !upBlock->m_bDedicated &&
+				upBlock->m_strategy == pBlock->m_strategy && upBlock->m_liveAllocations == 0;
+		} );
+
+		if( bHasOtherEmptyBlock )
+			destroyBlock( pBlock );
+	}
+
+	vk::DeviceSize VulkanMemoryAllocator::blockSizeForMemoryType( const std::uint32_t& memoryTypeIndex ) const
+	{
+		std::uint32_t heapIndex = m_vkMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+		vk::DeviceSize heapSize = m_vkMemoryProperties.memoryHeaps[heapIndex].size;
+
+		constexpr vk::DeviceSize SMALL_HEAP_SIZE = 1024ull * 1024ull * 1024ull;
+		if( heapSize <= SMALL_HEAP_SIZE )
+			return std::min( m_preferredBlockSize, heapSize / 8 );
+
+		return m_preferredBlockSize;
+	}
+
+	bool VulkanMemoryAllocator::allocateFromFreeList(
+		VulkanMemoryBlock* pBlock,
+		const vk::MemoryRequirements& memRequirements,
+		const AllocationResourceType& resourceType,
+		VulkanAllocation& allocation
+	)
+	{
+		auto bestItr = pBlock->m_regions.end();
+		vk::DeviceSize bestOffset = 0;
+
+		for( auto regionItr = pBlock->m_regions.begin(); regionItr != pBlock->m_regions.end(); regionItr++ )
+		{
+			const auto& [regionOffset, region] = *regionItr;
+
+			if( !region.m_bFree || region.m_size < memRequirements.size )
+				continue;
+
+			vk::DeviceSize offset = alignUp( regionOffset, memRequirements.alignment );
+
+			// free regions are always merged, so the neighbours of a free region are live allocations
+			if( regionItr != pBlock->m_regions.begin() )
+			{
+				auto prevItr = std::prev( regionItr );
+				if( prevItr->second.m_resourceType != resourceType &&
+					isOnSamePage( prevItr->first, prevItr->second.m_size, offset, m_bufferImageGranularity ) )
+				{
+					offset = alignUp( offset, m_bufferImageGranularity );
+				}
+			}
+
+			if( offset + memRequirements.size > regionOffset + region.m_size )
+				continue;
+
+			auto nextItr = std::next( regionItr );
+			if( nextItr != pBlock->m_regions.end() && nextItr->second.m_resourceType != resourceType &&
+				isOnSamePage( offset, memRequirements.size, nextItr->first, m_bufferImageGranularity ) )
+			{
+				continue;
+			}
+
+			if( bestItr == pBlock->m_regions.end() || region.m_size < bestItr->second.m_size )
+			{
+				bestItr = regionItr;
+				bestOffset = offset;
+			}
+		}
+
+		if( bestItr == pBlock->m_regions.end() )
+			return false;
+
+		vk::DeviceSize regionOffset = bestItr->first;
+		vk::DeviceSize regionEnd = regionOffset + bestItr->second.m_size;
+		vk::DeviceSize allocationEnd = bestOffset + memRequirements.size;
+
+		VulkanMemoryBlock::Region& allocatedRegion = bestItr->second;
+		allocatedRegion.m_bFree = false;
+		allocatedRegion.m_padding = bestOffset - regionOffset;
+		allocatedRegion.m_size = allocationEnd - regionOffset;
+		allocatedRegion.m_resourceType = resourceType;
+
+		if( allocationEnd < regionEnd )
+		{
+			pBlock->m_regions.emplace( allocationEnd, VulkanMemoryBlock::Region{ regionEnd - allocationEnd, 0, true, resourceType } );
+		}
+
+		pBlock->m_liveAllocations++;
+		pBlock->m_usedBytes += memRequirements.size;
+		pBlock->m_paddingBytes += allocatedRegion.m_padding;
+
+		allocation.m_memory = pBlock->m_memory;
+		allocation.m_offset = bestOffset;
+		allocation.m_size = memRequirements.size;
+		allocation.m_memoryTypeIndex = pBlock->m_memoryTypeIndex;
+		allocation.m_pBlock = pBlock;
+		allocation.m_pMappedData = pBlock->m_pMappedData ? static_cast<std::uint8_t*>( pBlock->m_pMappedData ) + bestOffset : nullptr;
+
+		return true;
+	}
+
+	bool VulkanMemoryAllocator::allocateFromLinear(
+		VulkanMemoryBlock* pBlock,
+		const vk::MemoryRequirements& memRequirements,
+		const AllocationResourceType& resourceType,
+		VulkanAllocation& allocation
+	)
+	{
+		vk::DeviceSize offset = alignUp( pBlock->m_linearHead, memRequirements.alignment );
+
+		if( pBlock->m_liveAllocations > 0 && pBlock->m_lastLinearResourceType != resourceType )
+			offset = alignUp( offset, m_bufferImageGranularity );
+
+		if( offset + memRequirements.size > pBlock->m_size )
+			return false;
+
+		pBlock->m_paddingBytes += offset - pBlock->m_linearHead;
+		pBlock->m_linearHead = offset + memRequirements.size;
+		pBlock->m_lastLinearResourceType = resourceType;
+		pBlock->m_liveAllocations++;
+		pBlock->m_usedBytes += memRequirements.size;
+
+		allocation.m_memory = pBlock->m_memory;
+		allocation.m_offset = offset;
+		allocation.m_size = memRequirements.size;
+		allocation.m_memoryTypeIndex = pBlock->m_memoryTypeIndex;
+		allocation.m_pBlock = pBlock;
+		allocation.m_pMappedData = pBlock->m_pMappedData ? static_cast<std::uint8_t*>( pBlock->m_pMappedData ) + offset : nullptr;
+
+		return true;
+	}
+
+} // namespace vkrender
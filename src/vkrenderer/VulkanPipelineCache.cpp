@@ -0,0 +1,176 @@
+#include "vkrenderer/VulkanPipelineCache.h"
+#include "utilities/VulkanLogger.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace vkrender
+{
+	namespace
+	{
+		// VkPipelineCacheHeaderVersionOne, read field by field since the blob carries no alignment guarantee
+		constexpr std::size_t HEADER_SIZE_OFFSET = 0;
+		constexpr std::size_t HEADER_VERSION_OFFSET = 4;
+		constexpr std::size_t VENDOR_ID_OFFSET = 8;
+		constexpr std::size_t DEVICE_ID_OFFSET = 12;
+		constexpr std::size_t CACHE_UUID_OFFSET = 16;
+		constexpr std::size_t HEADER_VERSION_ONE_SIZE = CACHE_UUID_OFFSET + VK_UUID_SIZE;
+
+		std::uint32_t readUint32( const std::vector<std::uint8_t>& data, const std::size_t& offset )
+		{
+			std::uint32_t value;
+			std::memcpy( &value, data.data() + offset, sizeof(value) );
+			return value;
+		}
+	}
+
+	VulkanPipelineCache::VulkanPipelineCache( const vk::Device& logicalDevice, const vk::PhysicalDeviceProperties& physicalDeviceProperties, const std::filesystem::path& filePath )
+		:m_vkLogicalDevice{ logicalDevice }
+		,m_vkPhysicalDeviceProperties{ physicalDeviceProperties }
+		,m_filePath{ filePath }
+		,m_loadResult{ LoadResult::eMissing }
+		,m_loadedSizeInBytes{ 0 }
+	{
+		std::vector<std::uint8_t> cacheData;
+		if( !m_filePath.empty() && readFile( m_filePath, cacheData ) )
+		{
+			if( isCompatible( cacheData, m_vkPhysicalDeviceProperties ) )
+			{
+				m_loadResult = LoadResult::eLoaded;
+				m_loadedSizeInBytes = cacheData.size();
+			}
+			else
+			{
+				m_loadResult = LoadResult::eRejected;
+				cacheData.clear();
+			}
+		}
+
+		vk::PipelineCacheCreateInfo pipelineCacheInfo{};
+		pipelineCacheInfo.initialDataSize = cacheData.size();
+		pipelineCacheInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+		m_vkPipelineCache = m_vkLogicalDevice.createPipelineCache( pipelineCacheInfo );
+
+		switch( m_loadResult )
+		{
+			case LoadResult::eLoaded:
+				LOG_INFO( fmt::format("Pipeline cache loaded {} bytes from {}", m_loadedSizeInBytes, m_filePath.string()) );
+				break;
+			case LoadResult::eRejected:
+				LOG_INFO( fmt::format("Pipeline cache {} was written for another device or driver, starting empty", m_filePath.string()) );
+				break;
+			case LoadResult::eMissing:
+				if( !m_filePath.empty() )
+					LOG_INFO( fmt::format("No pipeline cache at {}, starting empty", m_filePath.string()) );
+				break;
+		}
+	}
+
+	VulkanPipelineCache::~VulkanPipelineCache()
+	{
+		destroy();
+	}
+
+	bool VulkanPipelineCache::save()
+	{
+		if( !m_vkPipelineCache || m_filePath.empty() )
+			return false;
+
+		// concurrent runs each save their own view of the cache, keep what the last one added
+		std::vector<std::uint8_t> fileData;
+		if( readFile( m_filePath, fileData ) && isCompatible( fileData, m_vkPhysicalDeviceProperties ) )
+		{
+			vk::PipelineCacheCreateInfo fileCacheInfo{};
+			fileCacheInfo.initialDataSize = fileData.size();
+			fileCacheInfo.pInitialData = fileData.data();
+
+			vk::PipelineCache vkFilePipelineCache = m_vkLogicalDevice.createPipelineCache( fileCacheInfo );
+			m_vkLogicalDevice.mergePipelineCaches( m_vkPipelineCache, vkFilePipelineCache );
+			m_vkLogicalDevice.destroyPipelineCache( vkFilePipelineCache );
+		}
+
+		std::vector<std::uint8_t> cacheData = m_vkLogicalDevice.getPipelineCacheData( m_vkPipelineCache );
+		if( cacheData.empty() )
+			return false;
+
+		// a crash mid write leaves the temporary file behind rather than a truncated cache
+		std::filesystem::path tempFilePath = m_filePath;
+		tempFilePath += ".tmp";
+		{
+			std::ofstream tempFile{ tempFilePath, std::ios::binary | std::ios::trunc };
+			tempFile.write( reinterpret_cast<const char*>( cacheData.data() ), static_cast<std::streamsize>( cacheData.size() ) );
+			if( !tempFile )
+			{
+				LOG_ERROR( fmt::format("Failed to write pipeline cache to {}", tempFilePath.string()) );
+				return false;
+			}
+		}
+
+		std::error_code renameError;
+		std::filesystem::rename( tempFilePath, m_filePath, renameError );
+		if( renameError )
+		{
+			LOG_ERROR( fmt::format("Failed to replace pipeline cache {}: {}", m_filePath.string(), renameError.message()) );
+			std::filesystem::remove( tempFilePath, renameError );
+			return false;
+		}
+
+		LOG_INFO( fmt::format("Pipeline cache saved {} bytes to {}", cacheData.size(), m_filePath.string()) );
+		return true;
+	}
+
+	void VulkanPipelineCache::destroy()
+	{
+		m_vkLogicalDevice.destroyPipelineCache( m_vkPipelineCache );
+		m_vkPipelineCache = nullptr;
+	}
+
+	const vk::PipelineCache& VulkanPipelineCache::getPipelineCache() const
+	{
+		return m_vkPipelineCache;
+	}
+
+	VulkanPipelineCache::LoadResult VulkanPipelineCache::getLoadResult() const
+	{
+		return m_loadResult;
+	}
+
+	std::size_t VulkanPipelineCache::getLoadedSizeInBytes() const
+	{
+		return m_loadedSizeInBytes;
+	}
+
+	bool VulkanPipelineCache::isCompatible( const std::vector<std::uint8_t>& cacheData, const vk::PhysicalDeviceProperties& physicalDeviceProperties )
+	{
+		if( cacheData.size() < HEADER_VERSION_ONE_SIZE )
+			return false;
+
+		std::uint32_t headerSize = readUint32( cacheData, HEADER_SIZE_OFFSET );
+		std::uint32_t headerVersion = readUint32( cacheData, HEADER_VERSION_OFFSET );
+
+		return
+			headerSize >= HEADER_VERSION_ONE_SIZE && headerSize <= cacheData.size() &&
+			headerVersion == static_cast<std::uint32_t>( vk::PipelineCacheHeaderVersion::eOne ) &&
+			readUint32( cacheData, VENDOR_ID_OFFSET ) == physicalDeviceProperties.vendorID &&
+			readUint32( cacheData, DEVICE_ID_OFFSET ) == physicalDeviceProperties.deviceID &&
+			std::memcmp( cacheData.data() + CACHE_UUID_OFFSET, physicalDeviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE ) == 0;
+	}
+
+	bool VulkanPipelineCache::readFile( const std::filesystem::path& filePath, std::vector<std::uint8_t>& fileData )
+	{
+		std::ifstream file{ filePath, std::ios::binary | std::ios::ate };
+		if( !file )
+			return false;
+
+		std::streamsize fileSize = file.tellg();
+		if( fileSize <= 0 )
+			return false;
+
+		fileData.resize( static_cast<std::size_t>( fileSize ) );
+		file.seekg( 0 );
+		file.read( reinterpret_cast<char*>( fileData.data() ), fileSize );
+		return static_cast<bool>( file );
+	}
+
+} // namespace vkrender
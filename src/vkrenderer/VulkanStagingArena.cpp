@@ -0,0 +1,106 @@
+#include "vkrenderer/VulkanStagingArena.h"
+
+#include <algorithm>
+
+namespace vkrender
+{
+	VulkanStagingArena::VulkanStagingArena(
+		const vk::Buffer& stagingBuffer,
+		void* pMappedData,
+		const vk::DeviceSize& capacity,
+		const vk::DeviceSize& offsetAlignment
+	)
+		:m_vkStagingBuffer{ stagingBuffer }
+		,m_pMappedData{ static_cast<std::uint8_t*>( pMappedData ) }
+		,m_capacity{ capacity }
+		,m_offsetAlignment{ std::max<vk::DeviceSize>( offsetAlignment, 1 ) }
+		,m_head{ 0 }
+		,m_tail{ 0 }
+		,m_usedBytes{ 0 }
+	{}
+
+	bool VulkanStagingArena::tryAllocate( const vk::DeviceSize& sizeInBytes, Slice& slice )
+	{
+		vk::DeviceSize alignedSize = ( sizeInBytes + m_offsetAlignment - 1 ) / m_offsetAlignment * m_offsetAlignment;
+
+		if( alignedSize == 0 || alignedSize > m_capacity )
+			return false;
+
+		if( m_regions.empty() )
+		{
+			m_head = 0;
+			m_tail = 0;
+		}
+		else if( m_head == m_tail )
+		{
+			return false;
+		}
+
+		vk::DeviceSize offset = m_head;
+		vk::DeviceSize skippedBytes = 0;
+
+		if( m_head >= m_tail )
+		{
+			if( m_head + alignedSize > m_capacity )
+			{
+				// the tail end of the buffer is too short, wrap and leave it to the region that follows
+				if( alignedSize > m_tail )
+					return false;
+
+				skippedBytes = m_capacity - m_head;
+				offset = 0;
+			}
+		}
+		else if( m_head + alignedSize > m_tail )
+		{
+			return false;
+		}
+
+		m_head = offset + alignedSize;
+		m_usedBytes += skippedBytes + alignedSize;
+		m_regions.push_back( Region{ m_head, skippedBytes + alignedSize, 0 } );
+
+		slice.m_vkBuffer = m_vkStagingBuffer;
+		slice.m_offset = offset;
+		slice.m_pMappedData = m_pMappedData + offset;
+
+		return true;
+	}
+
+	void VulkanStagingArena::retire( const std::uint64_t& timelineValue )
+	{
+		for( auto it = m_regions.rbegin(); it != m_regions.rend() && it->m_timelineValue == 0; ++it )
+			it->m_timelineValue = timelineValue;
+	}
+
+	void VulkanStagingArena::reclaim( const std::uint64_t& completedTimelineValue )
+	{
+		while( !m_regions.empty() && m_regions.front().m_timelineValue != 0 && m_regions.front().m_timelineValue <= completedTimelineValue )
+		{
+			m_tail = m_regions.front().m_end;
+			m_usedBytes -= m_regions.front().m_sizeInBytes;
+			m_regions.pop_front();
+		}
+	}
+
+	bool VulkanStagingArena::hasUnsubmittedRegions() const
+	{
+		return !m_regions.empty() && m_regions.back().m_timelineValue == 0;
+	}
+
+	std::uint64_t VulkanStagingArena::getOldestPendingTimelineValue() const
+	{
+		return m_regions.empty() ? 0 : m_regions.front().m_timelineValue;
+	}
+
+	vk::DeviceSize VulkanStagingArena::getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	vk::DeviceSize VulkanStagingArena::getUsedBytes() const
+	{
+		return m_usedBytes;
+	}
+
+} // namespace vkrender
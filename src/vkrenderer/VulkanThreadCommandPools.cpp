@@ -0,0 +1,79 @@
+#include "vkrenderer/VulkanThreadCommandPools.h"
+
+namespace vkrender
+{
+	VulkanThreadCommandPools::VulkanThreadCommandPools(
+		const vk::Device& logicalDevice,
+		const std::uint32_t& queueFamilyIndex,
+		const std::uint32_t& frameSlotCount,
+		const std::uint32_t& threadSlotCount
+	)
+		:m_vkLogicalDevice{ logicalDevice }
+		,m_threadSlotCount{ threadSlotCount }
+		,m_pools( frameSlotCount * threadSlotCount )
+	{
+		// no per buffer reset flag, the whole pool is reset once per frame
+		vk::CommandPoolCreateInfo vkCommandPoolInfo{};
+		vkCommandPoolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+		vkCommandPoolInfo.queueFamilyIndex = queueFamilyIndex;
+
+		for( auto& pool : m_pools )
+		{
+			pool.m_vkCommandPool = m_vkLogicalDevice.createCommandPool( vkCommandPoolInfo );
+		}
+	}
+
+	VulkanThreadCommandPools::~VulkanThreadCommandPools()
+	{
+		destroy();
+	}
+
+	void VulkanThreadCommandPools::reset( const std::uint32_t& frameSlot )
+	{
+		for( std::uint32_t threadSlot = 0u; threadSlot < m_threadSlotCount; threadSlot++ )
+		{
+			SlotPool& pool = getPool( frameSlot, threadSlot );
+			if( pool.m_usedCount == 0 )
+				continue;
+
+			m_vkLogicalDevice.resetCommandPool( pool.m_vkCommandPool );
+			pool.m_usedCount = 0;
+		}
+	}
+
+	vk::CommandBuffer VulkanThreadCommandPools::acquireSecondary( const std::uint32_t& frameSlot, const std::uint32_t& threadSlot )
+	{
+		SlotPool& pool = getPool( frameSlot, threadSlot );
+		if( pool.m_usedCount == pool.m_secondaryCommandBuffers.size() )
+		{
+			vk::CommandBufferAllocateInfo vkCmdBufAllocateInfo{};
+			vkCmdBufAllocateInfo.commandPool = pool.m_vkCommandPool;
+			vkCmdBufAllocateInfo.level = vk::CommandBufferLevel::eSecondary;
+			vkCmdBufAllocateInfo.commandBufferCount = 1;
+
+			pool.m_secondaryCommandBuffers.push_back( m_vkLogicalDevice.allocateCommandBuffers( vkCmdBufAllocateInfo ).front() );
+		}
+		return pool.m_secondaryCommandBuffers[pool.m_usedCount++];
+	}
+
+	void VulkanThreadCommandPools::destroy()
+	{
+		// destroying a pool frees every buffer allocated from it
+		for( auto& pool : m_pools )
+		{
+			m_vkLogicalDevice.destroyCommandPool( pool.m_vkCommandPool );
+		}
+		m_pools.clear();
+	}
+
+	std::uint32_t VulkanThreadCommandPools::getThreadSlotCount() const
+	{
+		return m_threadSlotCount;
+	}
+
+	VulkanThreadCommandPools::SlotPool& VulkanThreadCommandPools::getPool( const std::uint32_t& frameSlot, const std::uint32_t& threadSlot )
+	{
+		return m_pools[frameSlot * m_threadSlotCount + threadSlot];
+	}
+
+} // namespace vkrender
@@ -0,0 +1,59 @@
+#include "vkrenderer/VulkanUniformRingBuffer.h"
+#include "utilities/VulkanLogger.h"
+
+#include <algorithm>
+
+namespace vkrender
+{
+	VulkanUniformRingBuffer::VulkanUniformRingBuffer(
+		void* pMappedData,
+		const vk::DeviceSize& frameRegionSize,
+		const std::uint32_t& frameCount,
+		const vk::DeviceSize& minOffsetAlignment
+	)
+		:m_pMappedData{ static_cast<std::uint8_t*>( pMappedData ) }
+		,m_frameRegionSize{ frameRegionSize }
+		,m_frameCount{ frameCount }
+		,m_minOffsetAlignment{ std::max<vk::DeviceSize>( minOffsetAlignment, 1 ) }
+		,m_frameRegionBegin{ 0 }
+		,m_frameHead{ 0 }
+	{}
+
+	void VulkanUniformRingBuffer::beginFrame( const std::uint32_t& frameIndex )
+	{
+		m_frameRegionBegin = static_cast<vk::DeviceSize>( frameIndex % m_frameCount ) * m_frameRegionSize;
+		m_frameHead = 0;
+	}
+
+	VulkanUniformRingBuffer::Slice VulkanUniformRingBuffer::allocate( const vk::DeviceSize& sizeInBytes )
+	{
+		vk::DeviceSize sliceSize = alignedSliceSize( sizeInBytes, m_minOffsetAlignment );
+
+		if( m_frameHead + sliceSize > m_frameRegionSize )
+		{
+			std::string errorMsg = fmt::format( "UNIFORM RING BUFFER EXHAUSTED, FRAME REGION OF {} BYTES IS FULL", m_frameRegionSize );
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		Slice slice{};
+		slice.m_offset = m_frameRegionBegin + m_frameHead;
+		slice.m_pMappedData = m_pMappedData + slice.m_offset;
+
+		m_frameHead += sliceSize;
+
+		return slice;
+	}
+
+	vk::DeviceSize VulkanUniformRingBuffer::getFrameUsedBytes() const
+	{
+		return m_frameHead;
+	}
+
+	vk::DeviceSize VulkanUniformRingBuffer::alignedSliceSize( const vk::DeviceSize& sizeInBytes, const vk::DeviceSize& minOffsetAlignment )
+	{
+		vk::DeviceSize alignment = std::max<vk::DeviceSize>( minOffsetAlignment, 1 );
+		return ( sizeInBytes + alignment - 1 ) / alignment * alignment;
+	}
+
+} // namespace vkrender
@@ -0,0 +1,225 @@
+#include "vkrenderer/VulkanUploadManager.h"
+#include "utilities/VulkanLogger.h"
+
+#include <limits>
+
+namespace vkrender
+{
+	VulkanUploadManager::VulkanUploadManager( const vk::Device& logicalDevice, const vk::Queue& transferQueue, const vk::CommandPool& transferCommandPool )
+		:m_vkLogicalDevice{ logicalDevice }
+		,m_vkTransferQueue{ transferQueue }
+		,m_vkTransferCommandPool{ transferCommandPool }
+		,m_bRecording{ false }
+		,m_nextTimelineValue{ 1 }
+		,m_submittedBatchCount{ 0 }
+	{
+		vk::SemaphoreTypeCreateInfo semaphoreTypeInfo{};
+		semaphoreTypeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+		semaphoreTypeInfo.initialValue = 0;
+
+		vk::SemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+		m_vkTimelineSemaphore = m_vkLogicalDevice.createSemaphore( semaphoreInfo );
+	}
+
+	VulkanUploadManager::~VulkanUploadManager()
+	{
+		destroy();
+	}
+
+	void VulkanUploadManager::enqueueBufferCopy( const vk::Buffer& srcBuffer, const vk::Buffer& dstBuffer, const vk::BufferCopy& copyRegion )
+	{
+		vk::CommandBuffer& cmdBuf = getRecordingCommandBuffer();
+
+		cmdBuf.copyBuffer( srcBuffer, dstBuffer, 1, &copyRegion );
+	}
+
+	void VulkanUploadManager::enqueueBufferToImageCopy( const vk::Buffer& srcBuffer, const vk::Image& dstImage, const vk::BufferImageCopy& copyRegion, const std::uint32_t& mipmapLevels )
+	{
+		vk::CommandBuffer& cmdBuf = getRecordingCommandBuffer();
+
+		vk::ImageMemoryBarrier imgBarrier{};
+		imgBarrier.oldLayout = vk::ImageLayout::eUndefined;
+		imgBarrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+		imgBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imgBarrier.image = dstImage;
+		imgBarrier.subresourceRange.aspectMask = copyRegion.imageSubresource.aspectMask;
+		imgBarrier.subresourceRange.baseMipLevel = 0;
+		imgBarrier.subresourceRange.levelCount = mipmapLevels;
+		imgBarrier.subresourceRange.baseArrayLayer = 0;
+		imgBarrier.subresourceRange.layerCount = 1;
+		imgBarrier.srcAccessMask = {};
+		imgBarrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+		cmdBuf.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {},
+			0, nullptr,
+			0, nullptr,
+			1, &imgBarrier
+		);
+
+		cmdBuf.copyBufferToImage( srcBuffer, dstImage, vk::ImageLayout::eTransferDstOptimal, 1, &copyRegion );
+	}
+
+	void VulkanUploadManager::releaseOnCompletion( std::function<void()> releaseCallback )
+	{
+		m_recordingBatch.m_releaseCallbacks.push_back( std::move(releaseCallback) );
+	}
+
+	UploadTicket VulkanUploadManager::flush()
+	{
+		if( !m_bRecording )
+		{
+			// nothing recorded, still honour releases queued against the last submitted batch
+			if( !m_recordingBatch.m_releaseCallbacks.empty() && !m_inFlightBatches.empty() )
+			{
+				auto& lastBatch = m_inFlightBatches.back();
+				for( auto& releaseCallback : m_recordingBatch.m_releaseCallbacks )
+					lastBatch.m_releaseCallbacks.push_back( std::move(releaseCallback) );
+				m_recordingBatch.m_releaseCallbacks.clear();
+			}
+			return UploadTicket{ m_nextTimelineValue - 1 };
+		}
+
+		m_recordingBatch.m_vkCommandBuffer.end();
+		m_recordingBatch.m_timelineValue = m_nextTimelineValue++;
+
+		vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+		timelineSubmitInfo.signalSemaphoreValueCount = 1;
+		timelineSubmitInfo.pSignalSemaphoreValues = &m_recordingBatch.m_timelineValue;
+
+		vk::SubmitInfo submitInfo{};
+		submitInfo.pNext = &timelineSubmitInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &m_recordingBatch.m_vkCommandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &m_vkTimelineSemaphore;
+
+		vk::Result opResult = m_vkTransferQueue.submit( 1, &submitInfo, nullptr );
+		if( opResult != vk::Result::eSuccess )
+		{
+			std::string errorMsg = "FAILED TO SUBMIT UPLOAD BATCH";
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+
+		UploadTicket ticket{ m_recordingBatch.m_timelineValue };
+
+		m_inFlightBatches.push_back( std::move(m_recordingBatch) );
+		m_recordingBatch = UploadBatch{};
+		m_bRecording = false;
+		m_submittedBatchCount++;
+
+		return ticket;
+	}
+
+	bool VulkanUploadManager::isComplete( const UploadTicket& ticket ) const
+	{
+		return getCompletedTimelineValue() >= ticket.m_timelineValue;
+	}
+
+	void VulkanUploadManager::wait( const UploadTicket& ticket ) const
+	{
+		vk::SemaphoreWaitInfo waitInfo{};
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_vkTimelineSemaphore;
+		waitInfo.pValues = &ticket.m_timelineValue;
+
+		vk::Result opResult = m_vkLogicalDevice.waitSemaphores( waitInfo, std::numeric_limits<std::uint64_t>::max() );
+		if( opResult != vk::Result::eSuccess )
+		{
+			std::string errorMsg = "FAILED TO WAIT FOR UPLOAD COMPLETION";
+			LOG_ERROR(errorMsg);
+			throw std::runtime_error(errorMsg);
+		}
+	}
+
+	void VulkanUploadManager::collect()
+	{
+		if( m_inFlightBatches.empty() )
+			return;
+
+		std::uint64_t completedValue = m_vkLogicalDevice.getSemaphoreCounterValue( m_vkTimelineSemaphore );
+
+		while( !m_inFlightBatches.empty() && m_inFlightBatches.front().m_timelineValue <= completedValue )
+		{
+			UploadBatch& batch = m_inFlightBatches.front();
+
+			for( auto& releaseCallback : batch.m_releaseCallbacks )
+				releaseCallback();
+
+			batch.m_vkCommandBuffer.reset( {} );
+			m_freeCommandBuffers.push_back( batch.m_vkCommandBuffer );
+
+			m_inFlightBatches.pop_front();
+		}
+	}
+
+	void VulkanUploadManager::destroy()
+	{
+		if( !m_vkTimelineSemaphore )
+			return;
+
+		flush();
+		wait( UploadTicket{ m_nextTimelineValue - 1 } );
+		collect();
+
+		for( auto& releaseCallback : m_recordingBatch.m_releaseCallbacks )
+			releaseCallback();
+		m_recordingBatch.m_releaseCallbacks.clear();
+
+		if( !m_freeCommandBuffers.empty() )
+			m_vkLogicalDevice.freeCommandBuffers( m_vkTransferCommandPool, m_freeCommandBuffers );
+		m_freeCommandBuffers.clear();
+
+		m_vkLogicalDevice.destroySemaphore( m_vkTimelineSemaphore );
+		m_vkTimelineSemaphore = nullptr;
+	}
+
+	vk::Semaphore VulkanUploadManager::getTimelineSemaphore() const
+	{
+		return m_vkTimelineSemaphore;
+	}
+
+	std::uint64_t VulkanUploadManager::getCompletedTimelineValue() const
+	{
+		return m_vkLogicalDevice.getSemaphoreCounterValue( m_vkTimelineSemaphore );
+	}
+
+	std::uint64_t VulkanUploadManager::getSubmittedBatchCount() const
+	{
+		return m_submittedBatchCount;
+	}
+
+	vk::CommandBuffer& VulkanUploadManager::getRecordingCommandBuffer()
+	{
+		if( m_bRecording )
+			return m_recordingBatch.m_vkCommandBuffer;
+
+		if( m_freeCommandBuffers.empty() )
+		{
+			vk::CommandBufferAllocateInfo allocInfo{};
+			allocInfo.level = vk::CommandBufferLevel::ePrimary;
+			allocInfo.commandPool = m_vkTransferCommandPool;
+			allocInfo.commandBufferCount = 1;
+
+			m_recordingBatch.m_vkCommandBuffer = m_vkLogicalDevice.allocateCommandBuffers( allocInfo )[0];
+		}
+		else
+		{
+			m_recordingBatch.m_vkCommandBuffer = m_freeCommandBuffers.back();
+			m_freeCommandBuffers.pop_back();
+		}
+
+		vk::CommandBufferBeginInfo beginInfo{};
+		beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+		m_recordingBatch.m_vkCommandBuffer.begin( beginInfo );
+		m_bRecording = true;
+
+		return m_recordingBatch.m_vkCommandBuffer;
+	}
+
+} // namespace vkrender
@@ -0,0 +1,71 @@
+#include "FramePacingSweep.h"
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+FramePacingSweepApplication::FramePacingSweepApplication( const vkrender::RendererSettings& rendererSettings, const std::uint32_t& frameCount )
+    :VulkanApplication::VulkanApplication{"FramePacingSweep"}
+    ,m_frameCount{ frameCount }
+{
+    setRendererSettings( rendererSettings );
+}
+
+FramePacingSweepApplication::~FramePacingSweepApplication()
+{}
+
+void FramePacingSweepApplication::run()
+{
+    initialise( "models/viking_room.obj", "textures/viking_room.png" );
+    runFrames( m_frameCount );
+}
+
+// usage: FramePacingSweep [frame count]
+int main( int argc, char** argv )
+{
+    std::uint32_t frameCount = argc > 1 ? static_cast<std::uint32_t>( std::stoul( argv[1] ) ) : 600u;
+
+    struct SweepResult
+    {
+        vkrender::RendererSettings m_settings;
+        utils::FrameStats m_frameStats;
+    };
+    std::vector<SweepResult> sweepResults;
+
+    // 0 images keeps the minImageCount + 1 default
+    for( std::uint32_t framesInFlight : { 1u, 2u, 3u } )
+    {
+        for( std::uint32_t swapchainImageCount : { 0u, 2u, 3u } )
+        {
+            vkrender::RendererSettings rendererSettings{};
+            rendererSettings.m_framesInFlight = framesInFlight;
+            rendererSettings.m_swapchainImageCount = swapchainImageCount;
+
+            try
+            {
+                FramePacingSweepApplication app{ rendererSettings, frameCount };
+                app.run();
+                sweepResults.push_back( SweepResult{ app.getRendererSettings(), app.getFrameStats() } );
+            }
+            catch( const std::exception& e )
+            {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    fmt::print( "{:>8} {:>8} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12}\n", "frames", "images", "ft p50", "ft p95", "ft p99", "lat p50", "lat p95", "lat p99" );
+    for( const auto& result : sweepResults )
+    {
+        const utils::FrameStats& stats = result.m_frameStats;
+        fmt::print( 
+            "{:>8} {:>8} {:>10.3f} {:>10.3f} {:>10.3f} {:>12.3f} {:>12.3f} {:>12.3f}\n",
+            result.m_settings.m_framesInFlight, result.m_settings.m_swapchainImageCount,
+            stats.getFrameTimePercentile( 50.0 ), stats.getFrameTimePercentile( 95.0 ), stats.getFrameTimePercentile( 99.0 ),
+            stats.getInputToPresentPercentile( 50.0 ), stats.getInputToPresentPercentile( 95.0 ), stats.getInputToPresentPercentile( 99.0 )
+        );
+    }
+
+    return EXIT_SUCCESS;
+}
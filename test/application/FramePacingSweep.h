@@ -0,0 +1,18 @@
+#ifndef FRAME_PACING_SWEEP_H
+#define FRAME_PACING_SWEEP_H
+
+#include "application/VulkanApplication.h"
+#include <filesystem>
+
+class FramePacingSweepApplication : public VulkanApplication
+{
+public:
+    FramePacingSweepApplication( const vkrender::RendererSettings& rendererSettings, const std::uint32_t& frameCount );
+    ~FramePacingSweepApplication();
+
+    void run() override;
+
+    const std::uint32_t m_frameCount;
+};
+
+#endif
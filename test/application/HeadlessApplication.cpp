@@ -0,0 +1,75 @@
+#include "HeadlessApplication.h"
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+HeadlessApplication::HeadlessApplication( const std::uint32_t& frameCount, const std::filesystem::path& outputFilePath )
+    :VulkanApplication::VulkanApplication{"HeadlessApplication"}
+    ,m_frameCount{ frameCount }
+    ,m_outputFilePath{ outputFilePath }
+    ,m_lastFrameWidth{ 0 }
+    ,m_lastFrameHeight{ 0 }
+    ,m_readbackCount{ 0 }
+{
+    vkrender::RendererSettings rendererSettings{};
+    rendererSettings.m_bHeadless = true;
+    setRendererSettings( rendererSettings );
+}
+
+HeadlessApplication::~HeadlessApplication()
+{}
+
+void HeadlessApplication::run()
+{
+    initialise( "models/viking_room.obj", "textures/viking_room.png" );
+    runFrames( m_frameCount );
+
+    fmt::print( "{} frames read back\n", m_readbackCount );
+    getFrameStats().log( "headless" );
+    writeLastFrame();
+}
+
+void HeadlessApplication::onFrameReadback( const std::uint8_t* pPixels, const std::uint32_t& width, const std::uint32_t& height, const std::uint64_t& frameValue )
+{
+    // the mapped buffer is reused by a later frame, keep a copy
+    m_lastFramePixels.assign( pPixels, pPixels + static_cast<std::size_t>( width ) * height * 4 );
+    m_lastFrameWidth = width;
+    m_lastFrameHeight = height;
+    m_readbackCount++;
+}
+
+void HeadlessApplication::writeLastFrame() const
+{
+    if( m_lastFramePixels.empty() )
+        return;
+
+    std::ofstream outputFile{ m_outputFilePath, std::ios::binary };
+    outputFile << "P6\n" << m_lastFrameWidth << " " << m_lastFrameHeight << "\n255\n";
+    for( std::size_t pixel = 0; pixel < m_lastFramePixels.size(); pixel += 4 )
+    {
+        outputFile.write( reinterpret_cast<const char*>( &m_lastFramePixels[pixel] ), 3 );
+    }
+
+    fmt::print( "Last frame written to {}\n", m_outputFilePath.string() );
+}
+
+// usage: HeadlessApplication [frame count] [output.ppm]
+int main( int argc, char** argv )
+{
+    std::uint32_t frameCount = argc > 1 ? static_cast<std::uint32_t>( std::stoul( argv[1] ) ) : 120u;
+    std::filesystem::path outputFilePath = argc > 2 ? argv[2] : "headless.ppm";
+
+    try
+    {
+        HeadlessApplication app{ frameCount, outputFilePath };
+        app.run();
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
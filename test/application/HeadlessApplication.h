@@ -0,0 +1,29 @@
+#ifndef HEADLESS_APPLICATION_H
+#define HEADLESS_APPLICATION_H
+
+#include "application/VulkanApplication.h"
+#include <filesystem>
+#include <vector>
+
+class HeadlessApplication : public VulkanApplication
+{
+public:
+    HeadlessApplication( const std::uint32_t& frameCount, const std::filesystem::path& outputFilePath );
+    ~HeadlessApplication();
+
+    void run() override;
+
+protected:
+    void onFrameReadback( const std::uint8_t* pPixels, const std::uint32_t& width, const std::uint32_t& height, const std::uint64_t& frameValue ) override;
+
+    void writeLastFrame() const;
+
+    const std::uint32_t m_frameCount;
+    std::filesystem::path m_outputFilePath;
+    std::vector<std::uint8_t> m_lastFramePixels;
+    std::uint32_t m_lastFrameWidth;
+    std::uint32_t m_lastFrameHeight;
+    std::uint64_t m_readbackCount;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "graphics/MeshCache.h"
+#include "graphics/ObjLoader.h"
+#include "utilities/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <spdlog/fmt/fmt.h>
+
+// builds the mesh cache ahead of time so the first launch already maps it
+// --verify also runs the sequential tinyobj loader and fails unless both loaders produced the same mesh
+// usage: MeshCacheBuilder <model.obj> [--output=file.vkmesh | --cache-dir=dir] [--threads=N] [--weld-epsilon=E] [--no-optimize | --overdraw] [--verify]
+int main( int argc, char** argv )
+{
+    if( argc < 2 )
+    {
+        std::cerr << "usage: MeshCacheBuilder <model.obj> [--output=file.vkmesh | --cache-dir=dir] [--threads=N] [--weld-epsilon=E] [--no-optimize | --overdraw] [--verify]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path sourceFilePath{ argv[1] };
+    std::filesystem::path cacheDirectory{ "mesh_cache" };
+    std::filesystem::path cacheFilePath;
+    std::uint32_t threadCount = 0;
+    graphics::MeshCacheKey cacheKey;
+    cacheKey.m_optimizeMode = graphics::MeshOptimizeMode::eVertexCache;
+    bool bVerify = false;
+
+    for( int argIndex = 2; argIndex < argc; argIndex++ )
+    {
+        std::string arg{ argv[argIndex] };
+        auto l_valueOf = [&arg]( const std::string& option ) { return arg.substr( option.size() ); };
+
+        if( arg.rfind( "--output=", 0 ) == 0 ) cacheFilePath = l_valueOf( "--output=" );
+        else if( arg.rfind( "--cache-dir=", 0 ) == 0 ) cacheDirectory = l_valueOf( "--cache-dir=" );
+        else if( arg.rfind( "--threads=", 0 ) == 0 ) threadCount = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--threads=" ) ) );
+        else if( arg.rfind( "--weld-epsilon=", 0 ) == 0 ) cacheKey.m_weldEpsilon = std::stof( l_valueOf( "--weld-epsilon=" ) );
+        else if( arg == "--no-optimize" ) cacheKey.m_optimizeMode = graphics::MeshOptimizeMode::eNone;
+        else if( arg == "--overdraw" ) cacheKey.m_optimizeMode = graphics::MeshOptimizeMode::eVertexCacheAndOverdraw;
+        else if( arg == "--verify" ) bVerify = true;
+    }
+    if( threadCount == 0 )
+        threadCount = std::max( 1u, std::thread::hardware_concurrency() );
+    if( cacheFilePath.empty() )
+        cacheFilePath = graphics::MeshCache::getCacheFilePath( cacheDirectory, sourceFilePath );
+
+    try
+    {
+        auto buildStart = std::chrono::high_resolution_clock::now();
+
+        if( !graphics::MeshCache::hashSourceFile( sourceFilePath, cacheKey.m_sourceHash ) )
+        {
+            std::cerr << "Failed to read " << sourceFilePath.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        auto parseStart = std::chrono::high_resolution_clock::now();
+        utils::ThreadPool threadPool{ threadCount - 1 };
+        graphics::MeshData meshData;
+        graphics::loadObjMeshParallel( sourceFilePath, meshData, threadPool, cacheKey.m_weldEpsilon );
+        fmt::print( "parsed on {} threads in {:.3f} ms\n", threadCount,
+            std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - parseStart ).count() );
+
+        if( bVerify )
+        {
+            auto referenceStart = std::chrono::high_resolution_clock::now();
+            graphics::MeshData referenceMeshData;
+            graphics::loadObjMesh( sourceFilePath, referenceMeshData, cacheKey.m_weldEpsilon );
+            fmt::print( "parsed by tinyobj in {:.3f} ms\n",
+                std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - referenceStart ).count() );
+
+            bool bSame = meshData.m_indices == referenceMeshData.m_indices && meshData.m_vertices.size() == referenceMeshData.m_vertices.size();
+            for( std::size_t vertexIndex = 0; bSame && vertexIndex < meshData.m_vertices.size(); vertexIndex++ )
+                bSame = meshData.m_vertices[vertexIndex] == referenceMeshData.m_vertices[vertexIndex];
+            if( !bSame )
+            {
+                std::cerr << "The parallel loader and tinyobj disagree on " << sourceFilePath.string() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        if( cacheKey.m_optimizeMode != graphics::MeshOptimizeMode::eNone )
+        {
+            graphics::MeshOptimizeReport optimizeReport = graphics::optimizeMesh( meshData, cacheKey.m_optimizeMode );
+            fmt::print( "optimized in {:.3f} ms, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}\n", optimizeReport.m_optimizeMs,
+                optimizeReport.m_before.m_acmr, optimizeReport.m_after.m_acmr, optimizeReport.m_before.m_atvr, optimizeReport.m_after.m_atvr );
+        }
+
+        // the cache holds vertices as this build's renderer uploads them
+        graphics::EncodedVertices encodedVertices;
+        graphics::encodeVertices<graphics::GpuVertexLayout>( meshData.m_vertices, meshData.m_indices, encodedVertices );
+        if( !graphics::MeshCache::write( cacheFilePath, meshData, encodedVertices, cacheKey ) )
+            return EXIT_FAILURE;
+
+        fmt::print(
+            "{}: {} vertices in the {} layout of {} bytes, {} indices, source hash {:016x}, written to {} in {:.3f} ms\n",
+            sourceFilePath.string(), meshData.m_vertices.size(), graphics::GPU_VERTEX_LAYOUT_NAME, graphics::GpuVertexLayout::STRIDE,
+            meshData.m_indices.size(), cacheKey.m_sourceHash, cacheFilePath.string(),
+            std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - buildStart ).count()
+        );
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
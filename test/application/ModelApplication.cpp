@@ -1,6 +1,7 @@
 #include "ModelApplication.h"
 #include <exception>
 #include <iostream>
+#include <string>
 
 ModelApplication::ModelApplication( const std::filesystem::path& modelFilePath, const std::filesystem::path& imageFilePath )
     :VulkanApplication::VulkanApplication{"ModelApplication"}
@@ -17,13 +18,22 @@ void ModelApplication::run()
     mainLoop();
 }
 
-int main()
+int main( int argc, char** argv )
 {
     auto app = ModelApplication{ 
         "models/viking_room.obj",
         "textures/viking_room.png"
     };
 
+    // --upload=staged|direct|auto to compare the buffer upload paths
+    for( int argIndex = 1; argIndex < argc; argIndex++ )
+    {
+        std::string arg{ argv[argIndex] };
+        if( arg == "--upload=staged" ) app.setUploadPath( vkrender::UploadPath::eStaged );
+        else if( arg == "--upload=direct" ) app.setUploadPath( vkrender::UploadPath::eDirect );
+        else if( arg == "--upload=auto" ) app.setUploadPath( vkrender::UploadPath::eAuto );
+    }
+
     try
     {
         app.run();
@@ -0,0 +1,194 @@
+#include "graphics/ObjLoader.h"
+#include "graphics/VertexWeldTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/fmt/fmt.h>
+
+namespace
+{
+    // the specialisation std::hash<vertex> had before the mixed hash, kept to compare against
+    struct LegacyVertexHash
+    {
+        std::size_t operator()( const vertex& vertexData ) const
+        {
+            return ( ( std::hash<glm::vec3>()( vertexData.pos ) ^ ( std::hash<glm::vec3>()( vertexData.color ) << 1 ) ) >> 1 ) ^ ( std::hash<glm::vec2>()( vertexData.texCoord ) << 1 );
+        }
+    };
+
+    struct WeldResult
+    {
+        std::vector<double> m_runMs;
+        std::size_t m_vertexCount;
+        // longest bucket chain of the node based maps, 0 for the weld table
+        std::size_t m_largestBucket;
+    };
+
+    // the corner stream a loader deduplicates, every index of the mesh expanded back into its vertex
+    std::vector<vertex> expandCorners( const graphics::MeshData& meshData )
+    {
+        std::vector<vertex> corners;
+        corners.reserve( meshData.m_indices.size() );
+        for( const auto& index : meshData.m_indices )
+            corners.push_back( meshData.m_vertices[index] );
+        return corners;
+    }
+
+    // a flat grid of small integer coordinates, the shape the shifted xor hash collides on
+    std::vector<vertex> makeGridCorners( const std::uint32_t& gridSize )
+    {
+        std::vector<vertex> corners;
+        corners.reserve( static_cast<std::size_t>( gridSize ) * gridSize * 6 );
+
+        auto l_gridVertex = [&gridSize]( const std::uint32_t& x, const std::uint32_t& y ) {
+            vertex vertexData{};
+            vertexData.pos = { static_cast<float>( x ), static_cast<float>( y ), 0.0f };
+            vertexData.color = { 1.0f, 1.0f, 1.0f };
+            vertexData.texCoord = { static_cast<float>( x ) / gridSize, static_cast<float>( y ) / gridSize };
+            return vertexData;
+        };
+
+        for( std::uint32_t y = 0; y < gridSize; y++ )
+        {
+            for( std::uint32_t x = 0; x < gridSize; x++ )
+            {
+                for( const auto& corner : { l_gridVertex( x, y ), l_gridVertex( x + 1, y ), l_gridVertex( x + 1, y + 1 ),
+                                            l_gridVertex( x, y ), l_gridVertex( x + 1, y + 1 ), l_gridVertex( x, y + 1 ) } )
+                    corners.push_back( corner );
+            }
+        }
+        return corners;
+    }
+
+    template<typename HashType>
+    std::size_t getLargestBucket( const std::unordered_map<vertex, std::uint32_t, HashType>& vertexMap )
+    {
+        std::size_t largestBucket = 0;
+        for( std::size_t bucketIndex = 0; bucketIndex < vertexMap.bucket_count(); bucketIndex++ )
+            largestBucket = std::max( largestBucket, vertexMap.bucket_size( bucketIndex ) );
+        return largestBucket;
+    }
+
+    // the loop the loaders used to run, count and operator[] per corner
+    template<typename HashType>
+    WeldResult weldWithMap( const std::vector<vertex>& corners, const std::uint32_t& runCount )
+    {
+        WeldResult result{};
+        for( std::uint32_t runIndex = 0; runIndex < runCount; runIndex++ )
+        {
+            auto runStart = std::chrono::high_resolution_clock::now();
+
+            std::unordered_map<vertex, std::uint32_t, HashType> uniqueVertices;
+            std::vector<vertex> vertices;
+            std::vector<std::uint32_t> indices;
+            indices.reserve( corners.size() );
+            for( const auto& corner : corners )
+            {
+                if( uniqueVertices.count( corner ) == 0 )
+                {
+                    uniqueVertices[corner] = static_cast<std::uint32_t>( vertices.size() );
+                    vertices.push_back( corner );
+                }
+                indices.push_back( uniqueVertices[corner] );
+            }
+
+            result.m_runMs.push_back( std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - runStart ).count() );
+            result.m_vertexCount = vertices.size();
+            result.m_largestBucket = getLargestBucket( uniqueVertices );
+        }
+        return result;
+    }
+
+    WeldResult weldWithTable( const std::vector<vertex>& corners, const std::uint32_t& runCount, const float& weldEpsilon )
+    {
+        WeldResult result{};
+        for( std::uint32_t runIndex = 0; runIndex < runCount; runIndex++ )
+        {
+            auto runStart = std::chrono::high_resolution_clock::now();
+
+            graphics::VertexWeldTable weldTable{ graphics::VertexWeldTable::estimateVertexCount( corners.size() ), weldEpsilon };
+            std::vector<vertex> vertices;
+            std::vector<std::uint32_t> indices;
+            indices.reserve( corners.size() );
+            for( const auto& corner : corners )
+            {
+                std::uint32_t vertexIndex = weldTable.findOrInsert( corner, static_cast<std::uint32_t>( vertices.size() ) );
+                if( vertexIndex == vertices.size() )
+                    vertices.push_back( corner );
+                indices.push_back( vertexIndex );
+            }
+
+            result.m_runMs.push_back( std::chrono::duration<double, std::milli>( std::chrono::high_resolution_clock::now() - runStart ).count() );
+            result.m_vertexCount = vertices.size();
+        }
+        return result;
+    }
+
+    void printResult( const std::string& name, WeldResult result )
+    {
+        std::sort( result.m_runMs.begin(), result.m_runMs.end() );
+        fmt::print( "  {:<32} best {:>9.3f} ms  median {:>9.3f} ms  {:>9} vertices  largest bucket {}\n",
+            name, result.m_runMs.front(), result.m_runMs[ result.m_runMs.size() / 2 ], result.m_vertexCount, result.m_largestBucket );
+    }
+
+    void benchCorners( const std::string& name, const std::vector<vertex>& corners, const std::uint32_t& runCount, const float& weldEpsilon )
+    {
+        fmt::print( "{}: {} corners\n", name, corners.size() );
+        printResult( "unordered_map, legacy hash", weldWithMap<LegacyVertexHash>( corners, runCount ) );
+        printResult( "unordered_map, mixed hash", weldWithMap<std::hash<vertex>>( corners, runCount ) );
+        printResult( "VertexWeldTable", weldWithTable( corners, runCount, 0.0f ) );
+        if( weldEpsilon > 0.0f )
+            printResult( fmt::format( "VertexWeldTable, epsilon {}", weldEpsilon ), weldWithTable( corners, runCount, weldEpsilon ) );
+    }
+}
+
+// times vertex deduplication of the corner stream of each model, and of a synthetic grid
+// usage: VertexWeldBench [model.obj ...] [--runs=N] [--grid=N] [--weld-epsilon=E]
+int main( int argc, char** argv )
+{
+    std::vector<std::string> modelFilePaths;
+    std::uint32_t runCount = 5;
+    std::uint32_t gridSize = 512;
+    float weldEpsilon = 0.0f;
+
+    for( int argIndex = 1; argIndex < argc; argIndex++ )
+    {
+        std::string arg{ argv[argIndex] };
+        auto l_valueOf = [&arg]( const std::string& option ) { return arg.substr( option.size() ); };
+
+        if( arg.rfind( "--runs=", 0 ) == 0 ) runCount = static_cast<std::uint32_t>( std::max( 1ul, std::stoul( l_valueOf( "--runs=" ) ) ) );
+        else if( arg.rfind( "--grid=", 0 ) == 0 ) gridSize = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--grid=" ) ) );
+        else if( arg.rfind( "--weld-epsilon=", 0 ) == 0 ) weldEpsilon = std::stof( l_valueOf( "--weld-epsilon=" ) );
+        else modelFilePaths.push_back( arg );
+    }
+    if( modelFilePaths.empty() )
+        modelFilePaths.push_back( "models/viking_room.obj" );
+
+    try
+    {
+        for( const auto& modelFilePath : modelFilePaths )
+        {
+            graphics::MeshData meshData;
+            graphics::loadObjMesh( modelFilePath, meshData );
+            benchCorners( modelFilePath, expandCorners( meshData ), runCount, weldEpsilon );
+        }
+
+        if( gridSize > 0 )
+            benchCorners( fmt::format( "{0}x{0} grid", gridSize ), makeGridCorners( gridSize ), runCount, weldEpsilon );
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,381 @@
+#include "VulkanBench.h"
+#include "utilities/JsonWriter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/gtc/constants.hpp>
+
+VulkanBenchApplication::VulkanBenchApplication( const vkrender::RendererSettings& rendererSettings, const std::uint32_t& warmupFrameCount, const std::uint32_t& frameCount )
+    :VulkanApplication::VulkanApplication{"VulkanBench"}
+    ,m_warmupFrameCount{ warmupFrameCount }
+    ,m_frameCount{ frameCount }
+    ,m_pathFrameIndex{ 0 }
+{
+    setRendererSettings( rendererSettings );
+}
+
+VulkanBenchApplication::~VulkanBenchApplication()
+{}
+
+void VulkanBenchApplication::run()
+{
+    initialise( "models/viking_room.obj", "textures/viking_room.png" );
+    m_deviceName = m_deviceCapabilities.getProperties().deviceName.data();
+
+    // warm up caches and clocks, then replay the path from the start for the measured frames
+    runFrames( m_warmupFrameCount );
+    m_pathFrameIndex = 0;
+    runFrames( m_frameCount );
+}
+
+const std::string& VulkanBenchApplication::getDeviceName() const
+{
+    return m_deviceName;
+}
+
+void VulkanBenchApplication::updateUniformBuffer( const std::uint32_t& currentFrame )
+{
+    float pathPosition = static_cast<float>( m_pathFrameIndex % FRAMES_PER_ORBIT ) / FRAMES_PER_ORBIT;
+    float orbitAngle = pathPosition * glm::two_pi<float>();
+    m_pathFrameIndex++;
+
+    VulkanUniformBufferObject ubo{};
+    ubo.model = glm::mat4{ 1.0f };
+    ubo.view = glm::lookAt(
+        glm::vec3{ 2.5f * std::cos( orbitAngle ), 2.5f * std::sin( orbitAngle ), 1.5f + 0.5f * std::sin( 2.0f * orbitAngle ) },
+        glm::vec3{ 0.0f, 0.0f, 0.25f },
+        glm::vec3{ 0.0f, 0.0f, 1.0f }
+    );
+    ubo.projection = glm::perspective(
+        glm::radians( 45.0f ),
+        m_vkSwapchainExtent.width / (float) m_vkSwapchainExtent.height,
+        0.1f,
+        10.0f
+    );
+    ubo.projection[1][1] *= -1.0f;
+
+    writeUniformBufferObject( ubo );
+}
+
+namespace
+{
+    void writePercentiles( utils::JsonWriter& jsonWriter, const std::string& key, const std::vector<double>& samples )
+    {
+        jsonWriter.beginObject( key );
+        jsonWriter.write( "p50", utils::FrameStats::computePercentile( samples, 50.0 ) );
+        jsonWriter.write( "p95", utils::FrameStats::computePercentile( samples, 95.0 ) );
+        jsonWriter.write( "p99", utils::FrameStats::computePercentile( samples, 99.0 ) );
+        jsonWriter.write( "samples", samples.size() );
+        jsonWriter.endObject();
+    }
+
+    void writeFramePercentiles( utils::JsonWriter& jsonWriter, const std::string& key, const utils::FrameStats& frameStats, const bool& bGpu )
+    {
+        jsonWriter.beginObject( key );
+        jsonWriter.write( "p50", bGpu ? frameStats.getGpuTimePercentile( 50.0 ) : frameStats.getFrameTimePercentile( 50.0 ) );
+        jsonWriter.write( "p95", bGpu ? frameStats.getGpuTimePercentile( 95.0 ) : frameStats.getFrameTimePercentile( 95.0 ) );
+        jsonWriter.write( "p99", bGpu ? frameStats.getGpuTimePercentile( 99.0 ) : frameStats.getFrameTimePercentile( 99.0 ) );
+        jsonWriter.write( "samples", bGpu ? frameStats.getGpuSampleCount() : frameStats.getFrameCount() );
+        jsonWriter.endObject();
+    }
+
+    void writeRecordPercentiles( utils::JsonWriter& jsonWriter, const std::string& key, const utils::FrameStats& frameStats )
+    {
+        jsonWriter.beginObject( key );
+        jsonWriter.write( "p50", frameStats.getRecordTimePercentile( 50.0 ) );
+        jsonWriter.write( "p95", frameStats.getRecordTimePercentile( 95.0 ) );
+        jsonWriter.write( "p99", frameStats.getRecordTimePercentile( 99.0 ) );
+        jsonWriter.write( "samples", frameStats.getRecordSampleCount() );
+        jsonWriter.endObject();
+    }
+
+    // display samples only exist when the pacer blocked on present wait
+    void writeLatencyPercentiles( utils::JsonWriter& jsonWriter, const std::string& key, const utils::FrameStats& frameStats, const bool& bDisplay )
+    {
+        jsonWriter.beginObject( key );
+        jsonWriter.write( "p50", bDisplay ? frameStats.getInputToDisplayPercentile( 50.0 ) : frameStats.getInputToPresentPercentile( 50.0 ) );
+        jsonWriter.write( "p95", bDisplay ? frameStats.getInputToDisplayPercentile( 95.0 ) : frameStats.getInputToPresentPercentile( 95.0 ) );
+        jsonWriter.write( "p99", bDisplay ? frameStats.getInputToDisplayPercentile( 99.0 ) : frameStats.getInputToPresentPercentile( 99.0 ) );
+        jsonWriter.write( "samples", bDisplay ? frameStats.getInputToDisplaySampleCount() : frameStats.getFrameCount() );
+        jsonWriter.endObject();
+    }
+
+    vkrender::PresentModePolicy parsePresentModePolicy( const std::string& presentModeName )
+    {
+        if( presentModeName == "immediate" ) return vkrender::PresentModePolicy::eImmediate;
+        if( presentModeName == "fifo" ) return vkrender::PresentModePolicy::eFifo;
+        if( presentModeName == "fifo_relaxed" ) return vkrender::PresentModePolicy::eFifoRelaxed;
+        return vkrender::PresentModePolicy::eMailbox;
+    }
+}
+
+// usage: VulkanBench [--frames=N] [--warmup=N] [--runs=N] [--frames-in-flight=N] [--headless] [--pipeline-statistics] [--recording-threads=N] [--draws=N] [--reuse-command-buffers] [--dynamic-rendering] [--present-mode=immediate|mailbox|fifo|fifo_relaxed] [--late-acquire] [--fps-limit=N] [--max-queued-presents=N] [--mesh-cache=dir] [--mesh-load-threads=N] [--weld-epsilon=E] [--no-mesh-optimize] [--mesh-overdraw] [--upload=staged|direct|auto] [--output=file.json] [--cpu-trace=trace.json]
+int main( int argc, char** argv )
+{
+    std::uint32_t frameCount = 1000u;
+    std::uint32_t warmupFrameCount = 60u;
+    std::uint32_t runCount = 3u;
+    std::string uploadPathName = "auto";
+    std::string outputFilePath = "vulkan_bench.json";
+    std::string cpuTraceFilePath;
+    vkrender::RendererSettings rendererSettings{};
+
+    for( int argIndex = 1; argIndex < argc; argIndex++ )
+    {
+        std::string arg{ argv[argIndex] };
+        auto l_valueOf = [&arg]( const std::string& option ) { return arg.substr( option.size() ); };
+
+        if( arg.rfind( "--frames=", 0 ) == 0 ) frameCount = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--frames=" ) ) );
+        else if( arg.rfind( "--warmup=", 0 ) == 0 ) warmupFrameCount = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--warmup=" ) ) );
+        else if( arg.rfind( "--runs=", 0 ) == 0 ) runCount = std::max( 1u, static_cast<std::uint32_t>( std::stoul( l_valueOf( "--runs=" ) ) ) );
+        else if( arg.rfind( "--frames-in-flight=", 0 ) == 0 ) rendererSettings.m_framesInFlight = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--frames-in-flight=" ) ) );
+        else if( arg.rfind( "--recording-threads=", 0 ) == 0 ) rendererSettings.m_recordingThreadCount = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--recording-threads=" ) ) );
+        else if( arg.rfind( "--draws=", 0 ) == 0 ) rendererSettings.m_drawsPerFrame = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--draws=" ) ) );
+        else if( arg.rfind( "--present-mode=", 0 ) == 0 ) rendererSettings.m_presentModePolicy = parsePresentModePolicy( l_valueOf( "--present-mode=" ) );
+        else if( arg.rfind( "--fps-limit=", 0 ) == 0 ) rendererSettings.m_frameRateLimit = std::stod( l_valueOf( "--fps-limit=" ) );
+        else if( arg.rfind( "--max-queued-presents=", 0 ) == 0 ) rendererSettings.m_maxQueuedPresents = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--max-queued-presents=" ) ) );
+        else if( arg.rfind( "--mesh-cache=", 0 ) == 0 ) rendererSettings.m_meshCacheDirectory = l_valueOf( "--mesh-cache=" );
+        else if( arg == "--no-mesh-optimize" ) rendererSettings.m_bOptimizeMesh = false;
+        else if( arg == "--mesh-overdraw" ) rendererSettings.m_bOptimizeMeshOverdraw = true;
+        else if( arg.rfind( "--weld-epsilon=", 0 ) == 0 ) rendererSettings.m_meshWeldEpsilon = std::stof( l_valueOf( "--weld-epsilon=" ) );
+        else if( arg.rfind( "--mesh-load-threads=", 0 ) == 0 ) rendererSettings.m_meshLoadThreadCount = static_cast<std::uint32_t>( std::stoul( l_valueOf( "--mesh-load-threads=" ) ) );
+        else if( arg.rfind( "--upload=", 0 ) == 0 ) uploadPathName = l_valueOf( "--upload=" );
+        else if( arg.rfind( "--output=", 0 ) == 0 ) outputFilePath = l_valueOf( "--output=" );
+        else if( arg.rfind( "--cpu-trace=", 0 ) == 0 ) cpuTraceFilePath = l_valueOf( "--cpu-trace=" );
+        else if( arg == "--headless" ) rendererSettings.m_bHeadless = true;
+        else if( arg == "--pipeline-statistics" ) rendererSettings.m_bGpuPipelineStatistics = true;
+        else if( arg == "--reuse-command-buffers" ) rendererSettings.m_bReuseCommandBuffers = true;
+        else if( arg == "--dynamic-rendering" ) rendererSettings.m_renderingPath = vkrender::RenderingPath::eDynamicRendering;
+        else if( arg == "--late-acquire" ) rendererSettings.m_bLateAcquire = true;
+    }
+
+    vkrender::UploadPath uploadPath = vkrender::UploadPath::eAuto;
+    if( uploadPathName == "staged" ) uploadPath = vkrender::UploadPath::eStaged;
+    else if( uploadPathName == "direct" ) uploadPath = vkrender::UploadPath::eDirect;
+
+    struct RunResult
+    {
+        utils::FrameStats m_frameStats;
+        double m_initMs;
+        double m_firstFrameMs;
+        std::uint32_t m_initQueueSubmits;
+        std::uint64_t m_stagedBytes;
+        vkrender::VulkanAllocatorStats m_allocatorStats;
+        std::map<std::string, std::vector<double>> m_gpuScopeSamples;
+        vkrender::VulkanGpuProfiler::PipelineStatistics m_pipelineStatisticsTotals;
+        std::uint64_t m_pipelineStatisticsFrameCount;
+        VulkanApplication::CommandBufferReuseStats m_commandBufferReuseStats;
+        VulkanApplication::MeshLoadStats m_meshLoadStats;
+    };
+    std::vector<RunResult> runResults;
+    vkrender::RendererSettings appliedSettings{};
+    vkrender::RenderingPath renderingPath = vkrender::RenderingPath::eRenderPass;
+    vk::PresentModeKHR presentMode = vk::PresentModeKHR::eFifo;
+    bool bPresentWait = false;
+    std::string deviceName;
+
+    for( std::uint32_t run = 0u; run < runCount; run++ )
+    {
+        try
+        {
+            VulkanBenchApplication app{ rendererSettings, warmupFrameCount, frameCount };
+            app.setUploadPath( uploadPath );
+            app.run();
+
+            const utils::StartupTrace& startupTrace = app.getStartupTrace();
+            const vkrender::VulkanGpuProfiler& gpuProfiler = app.getGpuProfiler();
+            runResults.push_back( RunResult{
+                app.getFrameStats(),
+                startupTrace.getInitDurationMs(),
+                startupTrace.getTimeToFirstFrameMs(),
+                startupTrace.getQueueSubmitCount(),
+                app.getTotalStagedBytes(),
+                app.getMemoryAllocatorStats(),
+                gpuProfiler.getScopeSamples(),
+                gpuProfiler.getPipelineStatisticsTotals(),
+                gpuProfiler.getPipelineStatisticsFrameCount(),
+                app.getCommandBufferReuseStats(),
+                app.getMeshLoadStats()
+            } );
+            appliedSettings = app.getRendererSettings();
+            renderingPath = app.getRenderingPath();
+            presentMode = app.getPresentMode();
+            bPresentWait = app.isPresentWaitEnabled();
+            deviceName = app.getDeviceName();
+        }
+        catch( const std::exception& e )
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    utils::FrameStats pooledFrameStats;
+    std::vector<double> initSamples;
+    std::vector<double> firstFrameSamples;
+    std::map<std::string, std::vector<double>> pooledGpuScopeSamples;
+    vkrender::VulkanGpuProfiler::PipelineStatistics pipelineStatisticsTotals{};
+    std::uint64_t pipelineStatisticsFrameCount = 0;
+    for( const auto& result : runResults )
+    {
+        pooledFrameStats.append( result.m_frameStats );
+        initSamples.push_back( result.m_initMs );
+        firstFrameSamples.push_back( result.m_firstFrameMs );
+
+        for( const auto& [scopeName, scopeSamples] : result.m_gpuScopeSamples )
+        {
+            std::vector<double>& pooledSamples = pooledGpuScopeSamples[scopeName];
+            pooledSamples.insert( pooledSamples.end(), scopeSamples.begin(), scopeSamples.end() );
+        }
+
+        pipelineStatisticsTotals.m_inputAssemblyVertices += result.m_pipelineStatisticsTotals.m_inputAssemblyVertices;
+        pipelineStatisticsTotals.m_inputAssemblyPrimitives += result.m_pipelineStatisticsTotals.m_inputAssemblyPrimitives;
+        pipelineStatisticsTotals.m_vertexShaderInvocations += result.m_pipelineStatisticsTotals.m_vertexShaderInvocations;
+        pipelineStatisticsTotals.m_clippingPrimitives += result.m_pipelineStatisticsTotals.m_clippingPrimitives;
+        pipelineStatisticsTotals.m_fragmentShaderInvocations += result.m_pipelineStatisticsTotals.m_fragmentShaderInvocations;
+        pipelineStatisticsFrameCount += result.m_pipelineStatisticsFrameCount;
+    }
+    // every run loads the same assets, the counters only differ if a run took another upload path
+    const RunResult& lastRun = runResults.back();
+
+    utils::JsonWriter jsonWriter;
+    jsonWriter.beginObject();
+    jsonWriter.write( "benchmark", "VulkanBench" );
+    jsonWriter.write( "device", deviceName );
+
+    jsonWriter.beginObject( "config" );
+    jsonWriter.write( "frames", frameCount );
+    jsonWriter.write( "warmup_frames", warmupFrameCount );
+    jsonWriter.write( "runs", runCount );
+    jsonWriter.write( "frames_in_flight", appliedSettings.m_framesInFlight );
+    jsonWriter.write( "swapchain_images", appliedSettings.m_swapchainImageCount );
+    jsonWriter.write( "headless", appliedSettings.m_bHeadless );
+    jsonWriter.write( "upload_path", uploadPathName );
+    jsonWriter.write( "recording_threads", appliedSettings.m_recordingThreadCount );
+    jsonWriter.write( "draws_per_frame", appliedSettings.m_drawsPerFrame );
+    jsonWriter.write( "reuse_command_buffers", appliedSettings.m_bReuseCommandBuffers );
+    jsonWriter.write( "rendering_path", renderingPath == vkrender::RenderingPath::eDynamicRendering ? "dynamic_rendering" : "render_pass" );
+    jsonWriter.write( "present_mode", appliedSettings.m_bHeadless ? std::string{ "none" } : vk::to_string( presentMode ) );
+    jsonWriter.write( "late_acquire", appliedSettings.m_bLateAcquire );
+    jsonWriter.write( "frame_rate_limit", appliedSettings.m_frameRateLimit );
+    jsonWriter.write( "max_queued_presents", appliedSettings.m_maxQueuedPresents );
+    jsonWriter.write( "present_wait", bPresentWait );
+    jsonWriter.write( "mesh_cache_directory", appliedSettings.m_meshCacheDirectory.string() );
+    jsonWriter.write( "mesh_load_threads", appliedSettings.m_meshLoadThreadCount );
+    jsonWriter.write( "mesh_weld_epsilon", appliedSettings.m_meshWeldEpsilon );
+    jsonWriter.write( "mesh_optimize", appliedSettings.m_bOptimizeMesh );
+    jsonWriter.write( "mesh_optimize_overdraw", appliedSettings.m_bOptimizeMeshOverdraw );
+    // compile time, set with the VKRENDER_VERTEX_LAYOUT CMake option
+    jsonWriter.write( "vertex_layout", std::string{ graphics::GPU_VERTEX_LAYOUT_NAME } );
+    jsonWriter.write( "vertex_stride", graphics::GpuVertexLayout::STRIDE );
+    jsonWriter.endObject();
+
+    writePercentiles( jsonWriter, "init_ms", initSamples );
+    writePercentiles( jsonWriter, "first_frame_ms", firstFrameSamples );
+    writeFramePercentiles( jsonWriter, "cpu_frame_ms", pooledFrameStats, false );
+    writeFramePercentiles( jsonWriter, "gpu_frame_ms", pooledFrameStats, true );
+    writeRecordPercentiles( jsonWriter, "cpu_record_ms", pooledFrameStats );
+    writeLatencyPercentiles( jsonWriter, "input_to_present_ms", pooledFrameStats, false );
+    if( pooledFrameStats.getInputToDisplaySampleCount() > 0 )
+        writeLatencyPercentiles( jsonWriter, "input_to_display_ms", pooledFrameStats, true );
+
+    jsonWriter.beginObject( "gpu_scopes_ms" );
+    for( const auto& [scopeName, scopeSamples] : pooledGpuScopeSamples )
+    {
+        writePercentiles( jsonWriter, scopeName, scopeSamples );
+    }
+    jsonWriter.endObject();
+
+    // per frame averages, only present when the device supports pipeline statistics queries
+    if( pipelineStatisticsFrameCount > 0 )
+    {
+        double frameCountScale = 1.0 / static_cast<double>( pipelineStatisticsFrameCount );
+        jsonWriter.beginObject( "pipeline_statistics_per_frame" );
+        jsonWriter.write( "input_assembly_vertices", pipelineStatisticsTotals.m_inputAssemblyVertices * frameCountScale );
+        jsonWriter.write( "input_assembly_primitives", pipelineStatisticsTotals.m_inputAssemblyPrimitives * frameCountScale );
+        jsonWriter.write( "vertex_shader_invocations", pipelineStatisticsTotals.m_vertexShaderInvocations * frameCountScale );
+        jsonWriter.write( "clipping_primitives", pipelineStatisticsTotals.m_clippingPrimitives * frameCountScale );
+        jsonWriter.write( "fragment_shader_invocations", pipelineStatisticsTotals.m_fragmentShaderInvocations * frameCountScale );
+        jsonWriter.write( "frames", pipelineStatisticsFrameCount );
+        jsonWriter.endObject();
+    }
+
+    jsonWriter.beginObject( "memory" );
+    jsonWriter.write( "staging_bytes", lastRun.m_stagedBytes );
+    jsonWriter.write( "init_queue_submits", lastRun.m_initQueueSubmits );
+    jsonWriter.write( "device_memory_allocations", lastRun.m_allocatorStats.m_totalDeviceMemoryAllocations );
+    jsonWriter.write( "sub_allocations", lastRun.m_allocatorStats.m_totalSubAllocations );
+    jsonWriter.write( "live_allocations", lastRun.m_allocatorStats.m_liveAllocationCount );
+    jsonWriter.write( "block_bytes", lastRun.m_allocatorStats.m_blockBytes );
+    jsonWriter.write( "used_bytes", lastRun.m_allocatorStats.m_usedBytes );
+    jsonWriter.endObject();
+
+    jsonWriter.beginArray( "runs" );
+    for( const auto& result : runResults )
+    {
+        jsonWriter.beginObject();
+        jsonWriter.write( "init_ms", result.m_initMs );
+        jsonWriter.write( "first_frame_ms", result.m_firstFrameMs );
+        writeFramePercentiles( jsonWriter, "cpu_frame_ms", result.m_frameStats, false );
+        writeFramePercentiles( jsonWriter, "gpu_frame_ms", result.m_frameStats, true );
+        // the first run against an empty cache directory is cold, the ones after it load the cache it wrote
+        jsonWriter.beginObject( "mesh_load" );
+        jsonWriter.write( "from_cache", result.m_meshLoadStats.m_bFromCache );
+        jsonWriter.write( "load_ms", result.m_meshLoadStats.m_loadMs );
+        jsonWriter.write( "hash_ms", result.m_meshLoadStats.m_hashMs );
+        if( !result.m_meshLoadStats.m_bFromCache && appliedSettings.m_bOptimizeMesh )
+        {
+            const auto& optimizeReport = result.m_meshLoadStats.m_optimizeReport;
+            jsonWriter.write( "optimize_ms", optimizeReport.m_optimizeMs );
+            jsonWriter.write( "acmr_before", optimizeReport.m_before.m_acmr );
+            jsonWriter.write( "acmr_after", optimizeReport.m_after.m_acmr );
+            jsonWriter.write( "atvr_before", optimizeReport.m_before.m_atvr );
+            jsonWriter.write( "atvr_after", optimizeReport.m_after.m_atvr );
+        }
+        jsonWriter.endObject();
+        if( appliedSettings.m_bReuseCommandBuffers )
+        {
+            jsonWriter.beginObject( "command_buffer_reuse" );
+            jsonWriter.write( "recorded_frames", result.m_commandBufferReuseStats.m_recordCount );
+            jsonWriter.write( "reused_frames", result.m_commandBufferReuseStats.m_reuseCount );
+            jsonWriter.write( "invalidations", result.m_commandBufferReuseStats.m_invalidationCount );
+            jsonWriter.endObject();
+        }
+        jsonWriter.endObject();
+    }
+    jsonWriter.endArray();
+    jsonWriter.endObject();
+
+    // the ring buffers hold the most recent events, which is the tail of the last run
+    if( !cpuTraceFilePath.empty() )
+    {
+#ifndef VKRENDER_TRACING_ENABLED
+        std::cerr << "Built without VKRENDER_ENABLE_TRACING, " << cpuTraceFilePath << " will hold no zones" << std::endl;
+#endif
+        utils::CpuTracer::writeChromeTrace( cpuTraceFilePath );
+    }
+
+    if( !jsonWriter.writeToFile( outputFilePath ) )
+    {
+        std::cerr << "Failed to write " << outputFilePath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    fmt::print( 
+        "{} frames x {} runs on {}: cpu p50 {:.3f} p99 {:.3f} ms, gpu p50 {:.3f} p99 {:.3f} ms, init p50 {:.3f} ms, results in {}\n",
+        frameCount, runCount, deviceName,
+        pooledFrameStats.getFrameTimePercentile( 50.0 ), pooledFrameStats.getFrameTimePercentile( 99.0 ),
+        pooledFrameStats.getGpuTimePercentile( 50.0 ), pooledFrameStats.getGpuTimePercentile( 99.0 ),
+        utils::FrameStats::computePercentile( initSamples, 50.0 ),
+        outputFilePath
+    );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,29 @@
+#ifndef VULKAN_BENCH_H
+#define VULKAN_BENCH_H
+
+#include "application/VulkanApplication.h"
+#include <string>
+
+// Renders a fixed number of frames along a fixed camera path, animation is driven by the frame index instead of the clock.
+class VulkanBenchApplication : public VulkanApplication
+{
+public:
+    VulkanBenchApplication( const vkrender::RendererSettings& rendererSettings, const std::uint32_t& warmupFrameCount, const std::uint32_t& frameCount );
+    ~VulkanBenchApplication();
+
+    void run() override;
+
+    const std::string& getDeviceName() const;
+
+protected:
+    void updateUniformBuffer( const std::uint32_t& currentFrame ) override;
+
+    static constexpr std::uint32_t FRAMES_PER_ORBIT = 240;
+
+    const std::uint32_t m_warmupFrameCount;
+    const std::uint32_t m_frameCount;
+    std::uint32_t m_pathFrameIndex;
+    std::string m_deviceName;
+};
+
+#endif